@@ -3,6 +3,9 @@
 #include <memory>
 #include <vector>
 
+#include "spock/command_recorder.hh"
+#include "spock/render_queue.hh"
+
 namespace spock
 {
     class Layer;
@@ -19,7 +22,19 @@ namespace spock
 
         void PushLayer(const std::shared_ptr<Layer> layer);
 
+        // Draws submitted during `Layer::OnRender`, recorded once every layer rendered
+        RenderQueue &GetRenderQueue() {
+            return m_RenderQueue;
+        }
+
+        // Records the layers `OnRender` and the render queue, statistics are those of the current frame
+        const CommandRecorder &GetCommandRecorder() const {
+            return m_CommandRecorder;
+        }
+
       private:
         std::vector<std::shared_ptr<Layer>> m_Layers;
+        RenderQueue m_RenderQueue;
+        CommandRecorder m_CommandRecorder;
     };
 } // namespace spock
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <vulkan/vulkan_core.h>
+
+namespace spock
+{
+    // A single descriptor set holding every texture (`sampler2D textures[]` in shaders).
+    // Textures register themselves and are selected in shaders by index, usually passed through push constants.
+    // Requires descriptor indexing, see `IsAvailable`.
+    class BindlessTextures {
+      public:
+        static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+        static bool IsAvailable();
+
+        // Returns the index of the texture in the table
+        static uint32_t Register(VkImageView image_view, VkSampler sampler);
+        // The index is reused once the frames in flight are done with it
+        static void Unregister(uint32_t index);
+
+        static void Bind(VkCommandBuffer command_buffer, VkPipelineLayout pipeline_layout, uint32_t set);
+
+        static VkDescriptorSet GetDescriptorSet();
+        static VkDescriptorSetLayout GetDescriptorSetLayout();
+        static uint32_t GetCapacity();
+    };
+} // namespace spock
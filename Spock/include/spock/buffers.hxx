@@ -1,6 +1,6 @@
 #pragma once
 
-#include <cstring>
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <vulkan/vulkan_core.h>
@@ -21,41 +21,34 @@ namespace spock
             return m_Buffer;
         }
 
+        VkDeviceSize GetSize() const {
+            return m_BufferSize;
+        }
+
+        // Persistently maps a host visible buffer, unmapped when destroyed
+        void *Map();
+
       public:
+        static std::unique_ptr<Buffer> CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                                                    VkMemoryPropertyFlags properties);
+        // Device local buffer filled with `size` bytes of `data` through a staging buffer
+        static std::unique_ptr<Buffer> CreateDeviceBuffer(const void *data, VkDeviceSize size,
+                                                          VkBufferUsageFlags usage);
+
         template <typename T>
         static std::unique_ptr<Buffer> CreateVertexBuffer(const std::vector<T> &vertices);
+        static std::unique_ptr<Buffer> CreateIndexBuffer(const std::vector<uint32_t> &indices);
 
       private:
         VkBuffer m_Buffer;
         VkDeviceMemory m_BufferMemory;
         VkDeviceSize m_BufferSize;
+        void *m_Mapped = nullptr;
     };
 
     template <typename T>
     std::unique_ptr<Buffer> Buffer::CreateVertexBuffer(const std::vector<T> &vertices) {
-        VkDeviceSize buffer_size = sizeof(vertices[0]) * vertices.size();
-
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-        Spock::CreateBuffer(buffer_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer,
-                            stagingBufferMemory);
-
-        void *data;
-        vkMapMemory(s_VulkanContext.Device, stagingBufferMemory, 0, buffer_size, 0, &data);
-        memcpy(data, vertices.data(), buffer_size);
-        vkUnmapMemory(s_VulkanContext.Device, stagingBufferMemory);
-
-        VkBuffer buffer;
-        VkDeviceMemory buffer_memory;
-        Spock::CreateBuffer(buffer_size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer, buffer_memory);
-
-        Spock::CopyBuffer(stagingBuffer, buffer, buffer_size);
-
-        vkDestroyBuffer(s_VulkanContext.Device, stagingBuffer, nullptr);
-        vkFreeMemory(s_VulkanContext.Device, stagingBufferMemory, nullptr);
-
-        return std::make_unique<Buffer>(buffer, buffer_memory, buffer_size);
+        return CreateDeviceBuffer(vertices.data(), sizeof(vertices[0]) * vertices.size(),
+                                  VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
     }
 } // namespace spock
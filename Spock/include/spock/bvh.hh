@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cfloat>
+#include <cstdint>
+#include <functional>
+#include <glm/glm.hpp>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "spock/frustum.hh"
+
+namespace spock
+{
+    struct BoundingBox
+    {
+        glm::vec3 Min{FLT_MAX};
+        glm::vec3 Max{-FLT_MAX};
+
+        void Grow(const glm::vec3 &point) {
+            Min = glm::min(Min, point);
+            Max = glm::max(Max, point);
+        }
+
+        void Grow(const BoundingBox &box) {
+            Min = glm::min(Min, box.Min);
+            Max = glm::max(Max, box.Max);
+        }
+
+        glm::vec3 GetCenter() const {
+            return (Min + Max) * 0.5f;
+        }
+
+        // Half of it, only ever compared
+        float GetHalfArea() const {
+            auto size = Max - Min;
+            return size.x * size.y + size.y * size.z + size.z * size.x;
+        }
+
+        static BoundingBox FromSphere(const glm::vec3 &center, float radius) {
+            return {center - glm::vec3(radius), center + glm::vec3(radius)};
+        }
+    };
+
+    struct Ray
+    {
+        glm::vec3 Origin{0.0f};
+        glm::vec3 Direction{0.0f, 0.0f, 1.0f}; // Normalized, distances are along it
+
+        // Through `position` on screen, from (0, 0) at the top left to (1, 1) at the bottom right
+        static Ray FromScreen(const glm::mat4 &view_projection, const glm::vec2 &position);
+    };
+
+    // Bounding volume hierarchy over object boxes, for hierarchical frustum culling and ray picking.
+    // Built with the surface area heuristic. Moving objects only need `SetBounds` and `Refit`, which keeps the tree
+    // and grows its boxes; rebuild when objects moved far enough for the tree to loosen.
+    class Bvh {
+      public:
+        static constexpr uint32_t INVALID_OBJECT = UINT32_MAX;
+
+        // 32 bytes, siblings are next to each other and share a cache line
+        struct alignas(32) Node
+        {
+            glm::vec3 Min;
+            uint32_t First; // Left child, the right one follows it, or the first object of a leaf
+            glm::vec3 Max;
+            uint32_t Count; // Objects of a leaf, 0 for inner nodes
+
+            bool IsLeaf() const {
+                return Count != 0;
+            }
+        };
+        static_assert(sizeof(Node) == 32, "Node must fit two per cache line");
+
+        struct Hit
+        {
+            uint32_t Object = INVALID_OBJECT;
+            float Distance = std::numeric_limits<float>::infinity();
+        };
+
+        // Refines a box hit, returns false when the object is missed or sets the exact `distance`
+        using IntersectFunction = std::function<bool(uint32_t object, const Ray &ray, float &distance)>;
+
+        Bvh() = default;
+        Bvh(const Bvh &) = delete;
+        Bvh operator=(const Bvh &) = delete;
+
+        // Objects are indices in `bounds`
+        void Build(std::span<const BoundingBox> bounds);
+
+        void SetBounds(uint32_t object, const BoundingBox &bounds);
+        // Grows the boxes of the tree to the bounds set since the build
+        void Refit();
+
+        // Appends the objects whose box intersects the frustum, whole subtrees inside of it are not tested further
+        void Cull(const Frustum &frustum, std::vector<uint32_t> &visible) const;
+
+        // Nearest object whose box is hit before `max_distance`, refined by `intersect` when given
+        Hit Raycast(const Ray &ray, float max_distance = std::numeric_limits<float>::infinity(),
+                    const IntersectFunction &intersect = nullptr) const;
+
+        uint32_t GetObjectCount() const {
+            return static_cast<uint32_t>(m_Bounds.size());
+        }
+
+        std::span<const Node> GetNodes() const {
+            return m_Nodes;
+        }
+
+        const BoundingBox &GetBounds(uint32_t object) const {
+            return m_Bounds[object];
+        }
+
+      private:
+        void UpdateNodeBounds(Node &node) const;
+        void Subdivide(uint32_t node_index);
+        void GatherObjects(uint32_t node_index, std::vector<uint32_t> &visible) const;
+
+      private:
+        // Node 0 is the root, node 1 is unused so that siblings start on even indices
+        std::vector<Node> m_Nodes;
+        // Leaves reference contiguous ranges of it
+        std::vector<uint32_t> m_Objects;
+        std::vector<BoundingBox> m_Bounds;
+        std::vector<glm::vec3> m_Centers;
+    };
+} // namespace spock
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/pipeline.hh"
+
+namespace spock
+{
+    // Records into a command buffer while shadowing the bound state, binds and dynamic state matching what is
+    // already set are dropped instead of reaching the driver. Handed to `Layer::OnRender` by `Application::Run`.
+    // Commands recorded on the raw command buffer are not seen, call `Invalidate` afterwards.
+    class CommandRecorder {
+      public:
+        static constexpr uint32_t MAX_SHADOWED_SETS = 8;
+        static constexpr uint32_t MAX_SHADOWED_VERTEX_BINDINGS = 16;
+
+        struct Statistics
+        {
+            uint32_t PipelineBinds = 0;
+            uint32_t DescriptorSetBinds = 0;
+            uint32_t VertexBufferBinds = 0;
+            uint32_t IndexBufferBinds = 0;
+            uint32_t DynamicStates = 0;
+
+            uint32_t SkippedPipelineBinds = 0;
+            uint32_t SkippedDescriptorSetBinds = 0;
+            uint32_t SkippedVertexBufferBinds = 0;
+            uint32_t SkippedIndexBufferBinds = 0;
+            uint32_t SkippedDynamicStates = 0;
+
+            uint32_t GetSkipped() const {
+                return SkippedPipelineBinds + SkippedDescriptorSetBinds + SkippedVertexBufferBinds
+                     + SkippedIndexBufferBinds + SkippedDynamicStates;
+            }
+        };
+
+        CommandRecorder(VkCommandBuffer command_buffer = VK_NULL_HANDLE);
+        CommandRecorder(const CommandRecorder &) = delete;
+        CommandRecorder operator=(const CommandRecorder &) = delete;
+
+        VkCommandBuffer GetCommandBuffer() const {
+            return m_CommandBuffer;
+        }
+
+        // Starts recording into `command_buffer` with nothing bound and cleared statistics
+        void Reset(VkCommandBuffer command_buffer);
+        // Forgets the shadowed state, statistics are kept
+        void Invalidate();
+
+        // Also binds `FrameGlobals` for pipelines using them, see `Pipeline::Bind`
+        void BindPipeline(const Pipeline &pipeline);
+        // At `set` of the bound pipeline layout
+        void BindDescriptorSet(uint32_t set, VkDescriptorSet descriptor_set);
+        void BindVertexBuffers(uint32_t first_binding, std::span<const VkBuffer> buffers,
+                               std::span<const VkDeviceSize> offsets = {});
+        void BindIndexBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkIndexType index_type = VK_INDEX_TYPE_UINT32);
+        void SetViewport(const VkViewport &viewport);
+        void SetScissor(const VkRect2D &scissor);
+
+        // Push constants are per draw data and never filtered
+        template <typename T, uint32_t Offset = 0>
+        void Push(VkShaderStageFlags stages, const T &data) {
+            if (m_Pipeline == nullptr) {
+                throw std::runtime_error("a pipeline must be bound before pushing constants!");
+            }
+
+            m_Pipeline->Push<T, Offset>(m_CommandBuffer, stages, data);
+        }
+        void PushConstants(VkShaderStageFlags stages, uint32_t offset, uint32_t size, const void *data);
+
+        void Draw(uint32_t vertex_count, uint32_t instance_count = 1, uint32_t first_vertex = 0,
+                  uint32_t first_instance = 0);
+        void DrawIndexed(uint32_t index_count, uint32_t instance_count = 1, uint32_t first_index = 0,
+                         int32_t vertex_offset = 0, uint32_t first_instance = 0);
+        // Every draw shares the instances. A single VK_EXT_multi_draw call when supported, where shaders can tell
+        // the draws apart with `gl_DrawID`, one `DrawIndexed` per draw otherwise.
+        void DrawMultiIndexed(std::span<const VkMultiDrawIndexedInfoEXT> draws, uint32_t instance_count = 1,
+                              uint32_t first_instance = 0);
+
+        const Pipeline *GetPipeline() const {
+            return m_Pipeline;
+        }
+
+        const Statistics &GetStatistics() const {
+            return m_Statistics;
+        }
+
+      private:
+        VkCommandBuffer m_CommandBuffer;
+        Statistics m_Statistics;
+
+        const Pipeline *m_Pipeline = nullptr;
+        VkPipelineLayout m_PipelineLayout = VK_NULL_HANDLE;
+        std::array<VkDescriptorSet, MAX_SHADOWED_SETS> m_DescriptorSets{};
+        std::array<VkBuffer, MAX_SHADOWED_VERTEX_BINDINGS> m_VertexBuffers{};
+        std::array<VkDeviceSize, MAX_SHADOWED_VERTEX_BINDINGS> m_VertexOffsets{};
+        VkBuffer m_IndexBuffer = VK_NULL_HANDLE;
+        VkDeviceSize m_IndexOffset = 0;
+        VkIndexType m_IndexType = VK_INDEX_TYPE_UINT32;
+        bool m_HasViewport = false;
+        VkViewport m_Viewport{};
+        bool m_HasScissor = false;
+        VkRect2D m_Scissor{};
+    };
+} // namespace spock
@@ -1,82 +1,92 @@
 #pragma once
 
+#include <array>
 #include <memory>
 #include <vulkan/vulkan_core.h>
 
+#include "spock/buffers.hxx"
+#include "spock/descriptor_set_layout.hxx"
 #include "spock/texture.hh"
 #include "spock/uniform_buffer.hxx"
+#include "spock/vulkan.hh"
 
 namespace spock
 {
+    // A resource bound to a set, resolved once for every frame in flight when constructed
     class Descriptor {
       public:
-        Descriptor(int binding)
-            : m_Binding(binding) {};
-        virtual VkWriteDescriptorSet GetWriteDescriptorSet(int frame_index, VkDescriptorSet dstSet,
-                                                           VkDescriptorBufferInfo &buffer_info,
-                                                           VkDescriptorImageInfo &image_info) = 0;
+        Descriptor(int binding, VkDescriptorType type)
+            : m_Binding(binding)
+            , m_Type(type)
+            , m_Infos{} {};
+
+        int GetBinding() const {
+            return m_Binding;
+        }
+
+        const DescriptorInfo &GetInfo(int frame_index) const {
+            return m_Infos[frame_index];
+        }
+
+        // Only needed for push descriptors, sets are written with the layout update template
+        VkWriteDescriptorSet GetWriteDescriptorSet(int frame_index, VkDescriptorSet dstSet) const {
+            return spock::GetWriteDescriptorSet(dstSet, m_Binding, m_Type, m_Infos[frame_index]);
+        }
 
       protected:
         int m_Binding;
+        VkDescriptorType m_Type;
+        // Zero initialized so identical resources give identical bytes, see `DescriptorAllocator::GetCached`
+        std::array<DescriptorInfo, MAX_FRAMES_IN_FLIGHT> m_Infos;
     };
 
     template <typename T>
     class UniformBufferDescriptor : public Descriptor {
       public:
         UniformBufferDescriptor(int binding, const std::unique_ptr<UniformBuffer<T>> &uniform_buffer)
-            : Descriptor(binding)
-            , m_UniformBuffer(uniform_buffer) {
-        }
-
-        virtual VkWriteDescriptorSet GetWriteDescriptorSet(int frame_index, VkDescriptorSet dstSet,
-                                                           VkDescriptorBufferInfo &buffer_info,
-                                                           VkDescriptorImageInfo &) override {
-            buffer_info.buffer = m_UniformBuffer->GetBuffer(frame_index);
-            buffer_info.offset = 0;
-            buffer_info.range = sizeof(T);
-
-            VkWriteDescriptorSet descriptor_write{};
-            descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptor_write.dstSet = dstSet;
-            descriptor_write.dstBinding = m_Binding;
-            descriptor_write.dstArrayElement = 0;
-            descriptor_write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            descriptor_write.descriptorCount = 1;
-            descriptor_write.pBufferInfo = &buffer_info;
-
-            return descriptor_write;
+            : Descriptor(binding, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) {
+            for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+                m_Infos[i].Buffer.buffer = uniform_buffer->GetBuffer(i);
+                m_Infos[i].Buffer.offset = 0;
+                m_Infos[i].Buffer.range = sizeof(T);
+            }
         }
-
-      private:
-        const std::unique_ptr<UniformBuffer<T>> &m_UniformBuffer;
     };
 
     class ImageSamplerDescriptor : public Descriptor {
       public:
         ImageSamplerDescriptor(int binding, const std::shared_ptr<Texture2D> &texture)
-            : Descriptor(binding)
-            , m_Texture(texture) {
+            : Descriptor(binding, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) {
+            for (auto &info : m_Infos) {
+                info.Image.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                info.Image.imageView = texture->GetImageView();
+                info.Image.sampler = texture->GetSampler();
+            }
         }
+    };
 
-        virtual VkWriteDescriptorSet GetWriteDescriptorSet(int, VkDescriptorSet dstSet, VkDescriptorBufferInfo &,
-                                                           VkDescriptorImageInfo &image_info) override {
-            image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            image_info.imageView = m_Texture->GetImageView();
-            image_info.sampler = m_Texture->GetSampler();
-
-            VkWriteDescriptorSet descriptor_write{};
-            descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptor_write.dstSet = dstSet;
-            descriptor_write.dstBinding = m_Binding;
-            descriptor_write.dstArrayElement = 0;
-            descriptor_write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            descriptor_write.descriptorCount = 1;
-            descriptor_write.pImageInfo = &image_info;
-
-            return descriptor_write;
+    class StorageBufferDescriptor : public Descriptor {
+      public:
+        StorageBufferDescriptor(int binding, const std::unique_ptr<Buffer> &buffer)
+            : Descriptor(binding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER) {
+            for (auto &info : m_Infos) {
+                info.Buffer.buffer = buffer->GetBuffer();
+                info.Buffer.offset = 0;
+                info.Buffer.range = buffer->GetSize();
+            }
         }
+    };
 
-      private:
-        const std::shared_ptr<Texture2D> &m_Texture;
+    // The image must be in VK_IMAGE_LAYOUT_GENERAL when accessed
+    class StorageImageDescriptor : public Descriptor {
+      public:
+        StorageImageDescriptor(int binding, VkImageView image_view)
+            : Descriptor(binding, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE) {
+            for (auto &info : m_Infos) {
+                info.Image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+                info.Image.imageView = image_view;
+                info.Image.sampler = VK_NULL_HANDLE;
+            }
+        }
     };
 } // namespace spock
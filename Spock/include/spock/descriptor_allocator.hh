@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+namespace spock
+{
+    class DescriptorSetLayout;
+    union DescriptorInfo;
+
+    // Layout and packed descriptors of a cached set, compared in full so a hash collision never returns another set
+    struct CachedDescriptorSetKey
+    {
+        VkDescriptorSetLayout Layout = VK_NULL_HANDLE;
+        std::vector<std::byte> Descriptors;
+
+        bool operator==(const CachedDescriptorSetKey &) const = default;
+        size_t GetHash() const;
+    };
+
+    struct CachedDescriptorSetKeyHash
+    {
+        size_t operator()(const CachedDescriptorSetKey &key) const {
+            return key.GetHash();
+        }
+    };
+
+    struct CachedDescriptorSet
+    {
+        VkDescriptorSet Set = VK_NULL_HANDLE;
+        VkDescriptorPool Pool = VK_NULL_HANDLE;
+        // Resources written in the set, see `DescriptorAllocator::Invalidate`
+        std::vector<VkBuffer> Buffers;
+        std::vector<VkImageView> ImageViews;
+    };
+
+    // Invalidated cached set, freed once the frames that may still bind it are done
+    struct PendingDescriptorSet
+    {
+        VkDescriptorSet Set = VK_NULL_HANDLE;
+        VkDescriptorPool Pool = VK_NULL_HANDLE;
+        uint64_t FrameNumber = 0;
+    };
+
+    // Allocates descriptor sets of any type from a growing list of pools.
+    // A new, larger pool is created whenever the current one is exhausted. Sets are reset all at once with `Reset`,
+    // or freed one by one when the pools are created with VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT.
+    class DescriptorAllocator {
+      public:
+        DescriptorAllocator(uint32_t sets_per_pool = 64, VkDescriptorPoolCreateFlags flags = 0);
+        DescriptorAllocator(const DescriptorAllocator &) = delete;
+        DescriptorAllocator operator=(const DescriptorAllocator &) = delete;
+
+        // `pool` receives the pool the set was allocated from, needed by `Free`
+        VkDescriptorSet Allocate(VkDescriptorSetLayout layout, VkDescriptorPool *pool = nullptr);
+        void Free(VkDescriptorPool pool, VkDescriptorSet descriptor_set);
+
+        // Every set allocated so far becomes invalid
+        void Reset();
+        void Cleanup();
+
+        uint32_t GetPoolCount() const {
+            return static_cast<uint32_t>(m_ReadyPools.size() + m_FullPools.size());
+        }
+
+      public:
+        // Long lived sets, released on `Spock::Cleanup`
+        static DescriptorAllocator &GetGlobal();
+        // Sets only valid for the frame being recorded, the pools are reset when the frame slot is reused
+        static DescriptorAllocator &GetFrame();
+
+        // Returns a set from the global allocator written with the layout update template.
+        // Sets with the same layout and descriptors are shared until one of their resources is invalidated.
+        static VkDescriptorSet GetCached(const DescriptorSetLayout &layout,
+                                         std::span<const DescriptorInfo> descriptors);
+
+        // Drops the cached sets referencing the resource, called when it is destroyed so its handle can be reused.
+        // The sets are freed by `FreeInvalidated` once the frames in flight are done with them.
+        static void Invalidate(VkBuffer buffer);
+        static void Invalidate(VkImageView image_view);
+        // Called by `Spock::BeginFrame` once the fence of the frame slot was waited on
+        static void FreeInvalidated();
+        static uint32_t GetCachedCount();
+
+      private:
+        VkDescriptorPool GetPool();
+        VkDescriptorPool CreatePool(uint32_t set_count);
+
+      private:
+        std::vector<VkDescriptorPool> m_ReadyPools;
+        std::vector<VkDescriptorPool> m_FullPools;
+        uint32_t m_SetsPerPool;
+        VkDescriptorPoolCreateFlags m_Flags;
+    };
+} // namespace spock
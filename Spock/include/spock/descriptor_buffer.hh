@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/descriptor_set_layout.hxx"
+
+namespace spock
+{
+    // Descriptor sets laid out in a host visible buffer (VK_EXT_descriptor_buffer).
+    // Sets are written with plain memory copies and bound by offset, no pool or VkDescriptorSet involved.
+    // The layout comes from `DescriptorSetLayout::CreateDescriptorBufferLayout` and pipelines using it must set
+    // `PipelineConfig::UseDescriptorBuffers`.
+    class DescriptorBuffer {
+      public:
+        DescriptorBuffer(const DescriptorSetLayout &descriptor_set_layout, uint32_t max_sets);
+        DescriptorBuffer(const DescriptorBuffer &) = delete;
+        DescriptorBuffer operator=(const DescriptorBuffer &) = delete;
+        ~DescriptorBuffer();
+
+        // Returns the index of an unused set
+        uint32_t Allocate();
+        void Free(uint32_t set_index);
+
+        // `descriptors` are packed as for update templates (see `PackDescriptors`).
+        // The set must not be in use by a frame in flight.
+        void Write(uint32_t set_index, std::span<const DescriptorInfo> descriptors);
+
+        // Replaces every descriptor buffer bound so far, sets of different `DescriptorBuffer` can not be mixed
+        void Bind(VkCommandBuffer command_buffer, VkPipelineLayout pipeline_layout, uint32_t set,
+                  uint32_t set_index) const;
+
+      public:
+        // Supported by the device and enabled with `SpockSettings::UseDescriptorBuffers`
+        static bool IsAvailable();
+        static std::unique_ptr<DescriptorBuffer>
+        CreateDescriptorBuffer(const std::unique_ptr<DescriptorSetLayout> &descriptor_set_layout, uint32_t max_sets);
+
+      private:
+        const DescriptorSetLayout &m_DescriptorSetLayout;
+        std::vector<VkDeviceSize> m_BindingOffsets;
+        VkDeviceSize m_SetSize;
+        uint32_t m_MaxSets;
+        uint32_t m_SetCount;
+        std::vector<uint32_t> m_FreeSets;
+
+        VkBuffer m_Buffer;
+        VkDeviceMemory m_BufferMemory;
+        VkDeviceAddress m_BufferAddress;
+        VkBufferUsageFlags m_BufferUsage;
+        uint8_t *m_BufferMapped;
+    };
+} // namespace spock
@@ -3,9 +3,11 @@
 #include <array>
 #include <cstddef>
 #include <memory>
+#include <stdexcept>
 #include <vulkan/vulkan_core.h>
 
 #include "spock/descriptor.hxx"
+#include "spock/descriptor_allocator.hh"
 #include "spock/descriptor_set_layout.hxx"
 #include "spock/vulkan.hh"
 
@@ -13,37 +15,79 @@ namespace spock
 {
     using DescriptorSet = VkDescriptorSet;
 
+    // Packs the resources in the layout update template order
+    template <std::size_t Nm>
+    std::array<DescriptorInfo, Nm> PackDescriptors(const DescriptorSetLayout &descriptor_set_layout,
+                                                   const std::array<Descriptor *, Nm> &descriptors, int frame_index) {
+        if (descriptor_set_layout.GetDescriptorCount() != Nm) {
+            throw std::invalid_argument("descriptors do not match the descriptor set layout!");
+        }
+
+        // With as many descriptors as the layout holds, no binding written twice means every binding is written
+        std::array<DescriptorInfo, Nm> descriptor_infos{};
+        std::array<bool, Nm> written{};
+        for (const auto descriptor : descriptors) {
+            auto offset = descriptor_set_layout.GetDescriptorOffset(descriptor->GetBinding());
+            if (written[offset]) {
+                throw std::invalid_argument("binding is written more than once!");
+            }
+
+            written[offset] = true;
+            descriptor_infos[offset] = descriptor->GetInfo(frame_index);
+        }
+
+        return descriptor_infos;
+    }
+
+    // One set per frame in flight, sets holding the same resources are shared (see `DescriptorAllocator::GetCached`)
     template <std::size_t Nm>
     std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT>
     CreateDescriptorSets(const std::unique_ptr<DescriptorSetLayout> &descriptor_set_layout,
                          std::array<Descriptor *, Nm> descriptors) {
-        std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT,
-                                                   descriptor_set_layout->GetDescriptorSetLayout());
-        VkDescriptorSetAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        allocInfo.descriptorPool = s_VulkanContext.DescriptorPool;
-        allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-        allocInfo.pSetLayouts = layouts.data();
-
         std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> descriptor_sets{};
-        if (vkAllocateDescriptorSets(s_VulkanContext.Device, &allocInfo, descriptor_sets.data()) != VK_SUCCESS) {
-            throw std::runtime_error("failed to allocate descriptor sets!");
-        }
 
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-            std::array<VkWriteDescriptorSet, Nm> descriptor_writes{};
-            std::array<VkDescriptorBufferInfo, Nm> buffer_infos{};
-            std::array<VkDescriptorImageInfo, Nm> image_infos{};
+            auto descriptor_infos = PackDescriptors(*descriptor_set_layout, descriptors, i);
+            descriptor_sets[i] = DescriptorAllocator::GetCached(*descriptor_set_layout, descriptor_infos);
+        }
 
-            for (size_t j = 0; j < Nm; j++) {
-                descriptor_writes[j] =
-                    descriptors[j]->GetWriteDescriptorSet(i, descriptor_sets[i], buffer_infos[j], image_infos[j]);
-            }
+        return descriptor_sets;
+    }
+
+    // A set only valid for the frame being recorded, for resources changing every frame
+    template <std::size_t Nm>
+    VkDescriptorSet CreateFrameDescriptorSet(const std::unique_ptr<DescriptorSetLayout> &descriptor_set_layout,
+                                             std::array<Descriptor *, Nm> descriptors) {
+        auto descriptor_set =
+            DescriptorAllocator::GetFrame().Allocate(descriptor_set_layout->GetDescriptorSetLayout());
+
+        auto descriptor_infos = PackDescriptors(*descriptor_set_layout, descriptors, s_VulkanContext.CurrentFrame);
+        descriptor_set_layout->Update(descriptor_set, descriptor_infos);
 
-            vkUpdateDescriptorSets(s_VulkanContext.Device, static_cast<uint32_t>(descriptor_writes.size()),
-                                   descriptor_writes.data(), 0, nullptr);
+        return descriptor_set;
+    }
+
+    // Writes the resources straight into the command buffer, no set is allocated.
+    // Uses a frame descriptor set instead when the layout is not a push descriptor layout.
+    template <std::size_t Nm>
+    void PushDescriptorSet(VkCommandBuffer command_buffer, VkPipelineLayout pipeline_layout, uint32_t set,
+                           const std::unique_ptr<DescriptorSetLayout> &descriptor_set_layout,
+                           std::array<Descriptor *, Nm> descriptors) {
+        if (!descriptor_set_layout->IsPushDescriptor()) {
+            auto descriptor_set = CreateFrameDescriptorSet(descriptor_set_layout, std::move(descriptors));
+            vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, set, 1,
+                                    &descriptor_set, 0, nullptr);
+            return;
         }
 
-        return descriptor_sets;
+        std::array<VkWriteDescriptorSet, Nm> descriptor_writes{};
+        for (size_t j = 0; j < Nm; j++) {
+            descriptor_writes[j] = descriptors[j]->GetWriteDescriptorSet(s_VulkanContext.CurrentFrame, VK_NULL_HANDLE);
+        }
+
+        s_VulkanContext.Extensions.CmdPushDescriptorSetKHR(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                                           pipeline_layout, set,
+                                                           static_cast<uint32_t>(descriptor_writes.size()),
+                                                           descriptor_writes.data());
     }
 } // namespace spock
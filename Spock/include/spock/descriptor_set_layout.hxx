@@ -1,49 +1,202 @@
 #pragma once
 
+#include "spock/hash.hh"
 #include "spock/vulkan.hh"
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <span>
 #include <stdexcept>
+#include <vector>
 #include <vulkan/vulkan_core.h>
 
 namespace spock
 {
+    // One descriptor as read by the layout update template, written as a tightly packed array
+    union DescriptorInfo {
+        VkDescriptorBufferInfo Buffer;
+        VkDescriptorImageInfo Image;
+        VkBufferView TexelBufferView;
+    };
+
+    // Write of a single descriptor, `info` must outlive the write
+    inline VkWriteDescriptorSet GetWriteDescriptorSet(VkDescriptorSet dst_set, uint32_t binding,
+                                                      VkDescriptorType type, const DescriptorInfo &info) {
+        VkWriteDescriptorSet descriptor_write{};
+        descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptor_write.dstSet = dst_set;
+        descriptor_write.dstBinding = binding;
+        descriptor_write.dstArrayElement = 0;
+        descriptor_write.descriptorType = type;
+        descriptor_write.descriptorCount = 1;
+
+        switch (type) {
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+            descriptor_write.pBufferInfo = &info.Buffer;
+            break;
+        case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+        case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+            descriptor_write.pTexelBufferView = &info.TexelBufferView;
+            break;
+        default:
+            descriptor_write.pImageInfo = &info.Image;
+            break;
+        }
+
+        return descriptor_write;
+    }
+
+    // Identifies a list of bindings, computed at compile time for `TypedDescriptorSetLayout`
+    constexpr uint64_t GetBindingsKey(std::span<const VkDescriptorSetLayoutBinding> bindings) {
+        uint64_t key = HashWord(static_cast<uint32_t>(bindings.size()));
+        for (const auto &binding : bindings) {
+            key = HashWord(binding.binding, key);
+            key = HashWord(static_cast<uint32_t>(binding.descriptorType), key);
+            key = HashWord(binding.descriptorCount, key);
+            key = HashWord(binding.stageFlags, key);
+        }
+
+        return key;
+    }
+
     class DescriptorSetLayout {
       public:
-        DescriptorSetLayout(VkDescriptorSetLayout descriptor_set_layout);
+        DescriptorSetLayout(VkDescriptorSetLayout descriptor_set_layout,
+                            std::span<const VkDescriptorSetLayoutBinding> bindings,
+                            VkDescriptorSetLayoutCreateFlags flags, uint64_t key);
         DescriptorSetLayout(const DescriptorSetLayout &) = delete;
         DescriptorSetLayout operator=(const DescriptorSetLayout &) = delete;
         ~DescriptorSetLayout();
-        void Cleanup();
 
         VkDescriptorSetLayout GetDescriptorSetLayout() const {
             return m_DescriptorSetLayout;
         }
 
+        // Resources are pushed into the command buffer, see `PushDescriptorSet`
+        bool IsPushDescriptor() const {
+            return m_Flags & VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+        }
+
+        // Written to a `DescriptorBuffer` instead of descriptor sets
+        bool IsDescriptorBuffer() const {
+            return m_Flags & VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+        }
+
+        const std::vector<VkDescriptorSetLayoutBinding> &GetBindings() const {
+            return m_Bindings;
+        }
+
+        // See `GetBindingsKey`, the shared VkDescriptorSetLayout is looked up by it and the flags
+        uint64_t GetKey() const {
+            return m_Key;
+        }
+
+        // Number of `DescriptorInfo` making up a set
+        uint32_t GetDescriptorCount() const {
+            return m_DescriptorCount;
+        }
+
+        // Position of the binding's first `DescriptorInfo` in the packed array
+        uint32_t GetDescriptorOffset(uint32_t binding) const;
+
+        // Not available for push descriptor and descriptor buffer layouts
+        VkDescriptorUpdateTemplate GetUpdateTemplate() const {
+            return m_UpdateTemplate;
+        }
+
+        // Writes every descriptor of the set in a single call
+        void Update(VkDescriptorSet descriptor_set, std::span<const DescriptorInfo> descriptors) const;
+
       public:
+        // The VkDescriptorSetLayout is shared by every layout created with the same bindings and flags,
+        // it lives until `Spock::Cleanup`
+        static std::unique_ptr<DescriptorSetLayout>
+        CreateDescriptorSetLayout(std::span<const VkDescriptorSetLayoutBinding> bindings,
+                                  VkDescriptorSetLayoutCreateFlags flags = 0);
         template <std::size_t Nm>
         static std::unique_ptr<DescriptorSetLayout>
-        CreateDescriptorSetLayout(const std::array<VkDescriptorSetLayoutBinding, Nm> &bindings);
+        CreateDescriptorSetLayout(const std::array<VkDescriptorSetLayoutBinding, Nm> &bindings,
+                                  VkDescriptorSetLayoutCreateFlags flags = 0);
+        // Same with `GetBindingsKey(bindings)` already known, e.g. `TypedDescriptorSetLayout::KEY`
+        static std::unique_ptr<DescriptorSetLayout>
+        CreateDescriptorSetLayout(std::span<const VkDescriptorSetLayoutBinding> bindings,
+                                  VkDescriptorSetLayoutCreateFlags flags, uint64_t key);
+
+        // A single push descriptor layout is allowed per pipeline layout.
+        // Falls back to a regular layout when VK_KHR_push_descriptor is not available.
+        template <std::size_t Nm>
+        static std::unique_ptr<DescriptorSetLayout>
+        CreatePushDescriptorSetLayout(const std::array<VkDescriptorSetLayoutBinding, Nm> &bindings);
+        template <std::size_t Nm>
+        static std::unique_ptr<DescriptorSetLayout>
+        CreatePushDescriptorSetLayout(const std::array<VkDescriptorSetLayoutBinding, Nm> &bindings, uint64_t key);
+
+        // Requires VK_EXT_descriptor_buffer, see `DescriptorBuffer::IsAvailable`
+        template <std::size_t Nm>
+        static std::unique_ptr<DescriptorSetLayout>
+        CreateDescriptorBufferLayout(const std::array<VkDescriptorSetLayoutBinding, Nm> &bindings);
+        template <std::size_t Nm>
+        static std::unique_ptr<DescriptorSetLayout>
+        CreateDescriptorBufferLayout(const std::array<VkDescriptorSetLayoutBinding, Nm> &bindings, uint64_t key);
+
+        // Destroys the cached layouts
+        static void Clear();
+
+      private:
+        void CreateUpdateTemplate();
 
       private:
         VkDescriptorSetLayout m_DescriptorSetLayout;
+        VkDescriptorSetLayoutCreateFlags m_Flags;
+        std::vector<VkDescriptorSetLayoutBinding> m_Bindings;
+        uint64_t m_Key;
+        std::vector<uint32_t> m_DescriptorOffsets;
+        uint32_t m_DescriptorCount;
+        VkDescriptorUpdateTemplate m_UpdateTemplate;
     };
 
     template <std::size_t Nm>
     std::unique_ptr<DescriptorSetLayout>
-    DescriptorSetLayout::CreateDescriptorSetLayout(const std::array<VkDescriptorSetLayoutBinding, Nm> &bindings) {
-        VkDescriptorSetLayoutCreateInfo layoutInfo{};
-        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-        layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
-        layoutInfo.pBindings = bindings.data();
+    DescriptorSetLayout::CreateDescriptorSetLayout(const std::array<VkDescriptorSetLayoutBinding, Nm> &bindings,
+                                                   VkDescriptorSetLayoutCreateFlags flags) {
+        return CreateDescriptorSetLayout(std::span<const VkDescriptorSetLayoutBinding>(bindings), flags);
+    }
+
+    template <std::size_t Nm>
+    std::unique_ptr<DescriptorSetLayout>
+    DescriptorSetLayout::CreatePushDescriptorSetLayout(const std::array<VkDescriptorSetLayoutBinding, Nm> &bindings) {
+        return CreatePushDescriptorSetLayout(bindings, GetBindingsKey(bindings));
+    }
+
+    template <std::size_t Nm>
+    std::unique_ptr<DescriptorSetLayout>
+    DescriptorSetLayout::CreatePushDescriptorSetLayout(const std::array<VkDescriptorSetLayoutBinding, Nm> &bindings,
+                                                       uint64_t key) {
+        if (!s_VulkanContext.Extensions.PushDescriptor) {
+            return CreateDescriptorSetLayout(bindings, 0, key);
+        }
+
+        return CreateDescriptorSetLayout(bindings, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR, key);
+    }
+
+    template <std::size_t Nm>
+    std::unique_ptr<DescriptorSetLayout>
+    DescriptorSetLayout::CreateDescriptorBufferLayout(const std::array<VkDescriptorSetLayoutBinding, Nm> &bindings) {
+        return CreateDescriptorBufferLayout(bindings, GetBindingsKey(bindings));
+    }
 
-        VkDescriptorSetLayout descriptor_set_layout;
-        if (vkCreateDescriptorSetLayout(s_VulkanContext.Device, &layoutInfo, nullptr, &descriptor_set_layout)
-            != VK_SUCCESS) {
-            throw std::runtime_error("failed to create descriptor set layout!");
+    template <std::size_t Nm>
+    std::unique_ptr<DescriptorSetLayout>
+    DescriptorSetLayout::CreateDescriptorBufferLayout(const std::array<VkDescriptorSetLayoutBinding, Nm> &bindings,
+                                                      uint64_t key) {
+        if (!s_VulkanContext.Extensions.DescriptorBuffer) {
+            throw std::runtime_error("descriptor buffers are not supported by this device!");
         }
 
-        return std::make_unique<DescriptorSetLayout>(descriptor_set_layout);
+        return CreateDescriptorSetLayout(bindings, VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT, key);
     }
 } // namespace spock
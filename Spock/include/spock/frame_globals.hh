@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan_core.h>
+
+namespace spock
+{
+    // Descriptor sets ordered by update frequency, see `PipelineConfig::UseFrameGlobals`
+    enum DescriptorSetFrequency : uint32_t {
+        FRAME_SET = 0,    // `FrameGlobals`, bound with the pipeline
+        MATERIAL_SET = 1, // Shared by every draw using the same material
+        DRAW_SET = 2,     // Per draw resources, small per draw data goes in push constants
+    };
+
+    // Matches the std140 block bound at set 0, binding 0:
+    //
+    //   layout(set = 0, binding = 0) uniform FrameGlobals {
+    //       mat4 view;
+    //       mat4 proj;
+    //       mat4 viewProj;
+    //       vec4 cameraPosition;
+    //       vec2 viewport;
+    //       float time;
+    //       float deltaTime;
+    //   } frame;
+    struct FrameGlobalsData
+    {
+        glm::mat4 View{1.0f};
+        glm::mat4 Projection{1.0f};
+        glm::mat4 ViewProjection{1.0f};
+        glm::vec4 CameraPosition{0.0f};
+        glm::vec2 Viewport{0.0f};
+        float Time = 0.0f;      // Seconds since `Spock::Initialize`
+        float DeltaTime = 0.0f; // Seconds since the previous frame
+    };
+    static_assert(sizeof(FrameGlobalsData) == 224, "FrameGlobalsData must match its std140 layout");
+
+    // Uniform shared by every draw of a frame: camera, time and viewport.
+    // Written once per frame and uploaded on `Spock::EndFrame`, time and viewport are filled by `Spock::BeginFrame`.
+    class FrameGlobals {
+      public:
+        static void SetCamera(const glm::mat4 &view, const glm::mat4 &projection);
+        static const FrameGlobalsData &GetData();
+
+        // Done by `Pipeline::Bind` for pipelines created with `PipelineConfig::UseFrameGlobals`
+        static void Bind(VkCommandBuffer command_buffer, VkPipelineLayout pipeline_layout,
+                         VkPipelineBindPoint bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+        static VkDescriptorSetLayout GetDescriptorSetLayout();
+    };
+} // namespace spock
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <array>
+#include <glm/glm.hpp>
+
+namespace spock
+{
+    // The six planes of a view projection matrix, normalized and facing inside: `dot(xyz, p) + w >= 0` inside
+    struct Frustum
+    {
+        // Left, right, bottom, top, near, far
+        std::array<glm::vec4, 6> Planes{};
+
+        bool IntersectsSphere(const glm::vec3 &center, float radius) const;
+
+        static Frustum FromMatrix(const glm::mat4 &view_projection);
+    };
+} // namespace spock
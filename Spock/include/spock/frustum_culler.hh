@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "spock/frustum.hh"
+
+namespace spock
+{
+    // Bounding volumes of many objects kept as structure of arrays and frustum culled by SIMD kernels.
+    // Every object has a box (center and half extents) and a sphere around the same center, a plane culls it when the
+    // tighter of the two is entirely behind it. Large sets are split over the `JobSystem`.
+    class FrustumCuller {
+      public:
+        enum class Kernel
+        {
+            Scalar,
+            SSE,
+            AVX2
+        };
+
+        FrustumCuller() = default;
+        FrustumCuller(const FrustumCuller &) = delete;
+        FrustumCuller operator=(const FrustumCuller &) = delete;
+
+        // Returns the index of the object
+        uint32_t AddBox(const glm::vec3 &min, const glm::vec3 &max);
+        uint32_t AddSphere(const glm::vec3 &center, float radius);
+        void SetBox(uint32_t index, const glm::vec3 &min, const glm::vec3 &max);
+        void SetSphere(uint32_t index, const glm::vec3 &center, float radius);
+        void Reserve(size_t count);
+        void Clear();
+
+        uint32_t GetObjectCount() const {
+            return static_cast<uint32_t>(m_Radius.size());
+        }
+
+        // Tests every object, returns how many are visible
+        uint32_t Cull(const Frustum &frustum, bool parallel = true) {
+            return Cull(frustum, GetBestKernel(), parallel);
+        }
+        uint32_t Cull(const Frustum &frustum, Kernel kernel, bool parallel = true);
+
+        // Written by `Cull`
+        bool IsVisible(uint32_t index) const {
+            return m_Visible[index] != 0;
+        }
+
+        // One byte per object, 1 when visible
+        const std::vector<uint8_t> &GetVisibility() const {
+            return m_Visible;
+        }
+
+      public:
+        // Widest kernel the CPU runs, checked once
+        static Kernel GetBestKernel();
+        static bool IsSupported(Kernel kernel);
+        static const char *GetKernelName(Kernel kernel);
+
+      private:
+        uint32_t Add(const glm::vec3 &center, const glm::vec3 &extents, float radius);
+        void Set(uint32_t index, const glm::vec3 &center, const glm::vec3 &extents, float radius);
+
+      private:
+        std::vector<float> m_CenterX;
+        std::vector<float> m_CenterY;
+        std::vector<float> m_CenterZ;
+        std::vector<float> m_ExtentX;
+        std::vector<float> m_ExtentY;
+        std::vector<float> m_ExtentZ;
+        std::vector<float> m_Radius;
+        std::vector<uint8_t> m_Visible;
+    };
+} // namespace spock
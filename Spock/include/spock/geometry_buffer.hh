@@ -0,0 +1,135 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/buffers.hxx"
+#include "spock/command_recorder.hh"
+#include "spock/mesh_simplifier.hh"
+#include "spock/range_allocator.hh"
+
+namespace spock
+{
+    // Levels of detail a mesh can keep, see `MeshSimplifier::GenerateLods`
+    static constexpr uint32_t MAX_MESH_LODS = 8;
+
+    // Vertices and 32 bits indices of many meshes sharing one vertex format, sub-allocated from a single vertex
+    // buffer and a single index buffer. Once `Bind` is recorded any of the meshes is drawn by its offsets alone,
+    // which is what indirect draws and `DrawPacket`s need (`First` is `FirstIndex`, `VertexOffset` is `FirstVertex`).
+    // `FirstIndex` and `IndexCount` are the full resolution, the other levels are in `Lods`.
+    class GeometryBuffer {
+      public:
+        // Indices of one level of detail, all levels share the vertices of the mesh
+        struct Lod
+        {
+            uint32_t FirstIndex = 0;
+            uint32_t IndexCount = 0;
+            float Error = 0.0f; // See `LodLevel::Error`
+        };
+
+        // Where a mesh lives, indices are relative to its first vertex
+        struct Mesh
+        {
+            uint32_t FirstVertex = 0;
+            uint32_t VertexCount = 0;
+            // Indices of the full resolution, same as `Lods[0]`
+            uint32_t FirstIndex = 0;
+            uint32_t IndexCount = 0;
+            // Indices of every level one after the other, as allocated
+            uint32_t FirstAllocatedIndex = 0;
+            uint32_t AllocatedIndexCount = 0;
+
+            uint32_t LodCount = 0;
+            std::array<Lod, MAX_MESH_LODS> Lods{};
+        };
+
+        GeometryBuffer(uint32_t vertex_stride, uint32_t vertex_capacity, uint32_t index_capacity);
+        GeometryBuffer(const GeometryBuffer &) = delete;
+        GeometryBuffer operator=(const GeometryBuffer &) = delete;
+
+        // Uploads a mesh, throws when the vertex type does not match the stride or when either buffer is full
+        template <typename T>
+        Mesh Allocate(const std::vector<T> &vertices, const std::vector<uint32_t> &indices);
+        Mesh Allocate(const void *vertices, uint32_t vertex_count, const uint32_t *indices, uint32_t index_count);
+        // Same with the levels of detail of the mesh, the first one at full resolution
+        template <typename T>
+        Mesh AllocateLods(const std::vector<T> &vertices, std::span<const LodLevel> lods);
+        Mesh AllocateLods(const void *vertices, uint32_t vertex_count, std::span<const LodLevel> lods);
+
+        // The space is reused by an `Allocate` once the frames in flight that may draw the mesh are done,
+        // MAX_FRAMES_IN_FLIGHT frames later
+        void Free(const Mesh &mesh);
+
+        // Vertex binding 0 and the index buffer
+        void Bind(CommandRecorder &recorder) const;
+
+        void Draw(CommandRecorder &recorder, const Mesh &mesh, uint32_t lod = 0, uint32_t instance_count = 1,
+                  uint32_t first_instance = 0) const;
+        // The full resolution of all of `meshes`, in one call when VK_EXT_multi_draw is supported, see
+        // `CommandRecorder::DrawMultiIndexed`
+        void DrawMeshes(CommandRecorder &recorder, std::span<const Mesh> meshes, uint32_t instance_count = 1,
+                        uint32_t first_instance = 0);
+
+        uint32_t GetVertexStride() const {
+            return m_VertexStride;
+        }
+
+        VkBuffer GetVertexBuffer() const {
+            return m_VertexBuffer->GetBuffer();
+        }
+
+        VkBuffer GetIndexBuffer() const {
+            return m_IndexBuffer->GetBuffer();
+        }
+
+        // Freed meshes are counted once their space can be reused, see `Free`
+        uint32_t GetFreeVertexCount() const;
+        uint32_t GetFreeIndexCount() const;
+
+      public:
+        static std::unique_ptr<GeometryBuffer> CreateGeometryBuffer(uint32_t vertex_stride, uint32_t vertex_capacity,
+                                                                    uint32_t index_capacity);
+
+      private:
+        void ReclaimFreedMeshes();
+
+      private:
+        uint32_t m_VertexStride;
+        std::unique_ptr<Buffer> m_VertexBuffer;
+        std::unique_ptr<Buffer> m_IndexBuffer;
+        RangeAllocator m_Vertices;
+        RangeAllocator m_Indices;
+
+        // Freed meshes may still be read by frames in flight, kept with the frame they were freed in
+        struct FreedMesh
+        {
+            Mesh Range;
+            uint64_t FrameNumber;
+        };
+        std::vector<FreedMesh> m_FreedMeshes;
+        std::vector<VkMultiDrawIndexedInfoEXT> m_Draws;
+    };
+
+    template <typename T>
+    GeometryBuffer::Mesh GeometryBuffer::Allocate(const std::vector<T> &vertices,
+                                                  const std::vector<uint32_t> &indices) {
+        if (sizeof(T) != m_VertexStride)
+            throw std::invalid_argument("vertex type does not match the geometry buffer stride!");
+
+        return Allocate(vertices.data(), static_cast<uint32_t>(vertices.size()), indices.data(),
+                        static_cast<uint32_t>(indices.size()));
+    }
+
+    template <typename T>
+    GeometryBuffer::Mesh GeometryBuffer::AllocateLods(const std::vector<T> &vertices, std::span<const LodLevel> lods) {
+        if (sizeof(T) != m_VertexStride)
+            throw std::invalid_argument("vertex type does not match the geometry buffer stride!");
+
+        return AllocateLods(vertices.data(), static_cast<uint32_t>(vertices.size()), lods);
+    }
+} // namespace spock
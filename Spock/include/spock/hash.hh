@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace spock
+{
+    // FNV-1a over raw bytes, used to key caches on data such as SPIR-V code
+    inline uint64_t HashBytes(const void *data, size_t size, uint64_t seed = 14695981039346656037ull) {
+        auto bytes = static_cast<const uint8_t *>(data);
+        uint64_t hash = seed;
+
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+
+        return hash;
+    }
+
+    // Same as `HashBytes` over the 4 bytes of `value` (little endian), usable in constant expressions
+    constexpr uint64_t HashWord(uint32_t value, uint64_t seed = 14695981039346656037ull) {
+        uint64_t hash = seed;
+
+        for (uint32_t i = 0; i < sizeof(uint32_t); i++) {
+            hash ^= (value >> (i * 8)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+
+        return hash;
+    }
+
+    template <typename T>
+    inline void HashCombine(size_t &seed, const T &value) {
+        seed ^= std::hash<T>{}(value) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+    }
+} // namespace spock
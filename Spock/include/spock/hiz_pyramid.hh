@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/pipeline.hh"
+#include "spock/typed_descriptor_set_layout.hxx"
+#include "spock/uniform_buffer.hxx"
+
+namespace spock
+{
+    // Matches the std140 `HiZ` block of the occlusion culling shader:
+    //
+    //   layout(set = 1, binding = 1) uniform HiZ {
+    //       mat4 viewProj;
+    //       vec2 size;
+    //       uint levelCount;
+    //       uint valid;
+    //   } pyramid;
+    struct HiZData
+    {
+        glm::mat4 ViewProjection{1.0f}; // Camera the depth was rendered with
+        glm::vec2 Size{0.0f};           // Of the first level
+        uint32_t LevelCount = 0;
+        uint32_t Valid = 0; // No depth to test against yet, nothing is occluded
+    };
+    static_assert(sizeof(HiZData) == 80, "HiZData must match its std140 layout");
+
+    // Hierarchical depth: mip chain of the farthest depth of the previous frame, built by compute.
+    // Occlusion tests pick the level where an object spans a single texel and compare its nearest depth against the
+    // farthest one drawn there, see `IndirectScene::Cull`. Objects appearing from behind an occluder are drawn one
+    // frame late.
+    class HiZPyramid {
+      public:
+        using DepthSetLayout = TypedDescriptorSetLayout<
+            ImageViewSamplerBinding<0, VK_SHADER_STAGE_COMPUTE_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL>,
+            StorageImageBinding<1, VK_SHADER_STAGE_COMPUTE_BIT>>;
+        using ReduceSetLayout = TypedDescriptorSetLayout<StorageImageBinding<0, VK_SHADER_STAGE_COMPUTE_BIT>,
+                                                         StorageImageBinding<1, VK_SHADER_STAGE_COMPUTE_BIT>>;
+        // What culling shaders sample, see `GetDescriptorSet`
+        using SampleSetLayout =
+            TypedDescriptorSetLayout<ImageViewSamplerBinding<0, VK_SHADER_STAGE_COMPUTE_BIT, VK_IMAGE_LAYOUT_GENERAL>,
+                                     UniformBufferBinding<1, HiZData, VK_SHADER_STAGE_COMPUTE_BIT>>;
+
+        HiZPyramid();
+        HiZPyramid(const HiZPyramid &) = delete;
+        HiZPyramid operator=(const HiZPyramid &) = delete;
+        ~HiZPyramid();
+
+        // Reduces the depth kept by the previous frame, must be recorded every frame outside of rendering and
+        // before culling (see `Layer::OnCompute`), once the camera is set
+        void Build(VkCommandBuffer command_buffer);
+
+        // Set of the frame being recorded, written by `Build`
+        VkDescriptorSet GetDescriptorSet() const {
+            return m_SampleSet;
+        }
+
+        VkDescriptorSetLayout GetDescriptorSetLayout() const {
+            return m_SampleSetLayout->GetDescriptorSetLayout();
+        }
+
+        // Whether the last `Build` had a previous frame to reduce
+        bool IsValid() const {
+            return m_Valid;
+        }
+
+        VkExtent2D GetExtent() const {
+            return m_Extent;
+        }
+
+        uint32_t GetLevelCount() const {
+            return m_LevelCount;
+        }
+
+      public:
+        static std::unique_ptr<HiZPyramid> CreateHiZPyramid();
+
+      private:
+        void CreateImage(VkCommandBuffer command_buffer);
+        void DestroyImage();
+
+      private:
+        std::unique_ptr<Pipeline> m_DepthPipeline;
+        std::unique_ptr<Pipeline> m_ReducePipeline;
+        std::unique_ptr<DepthSetLayout> m_DepthSetLayout;
+        std::unique_ptr<ReduceSetLayout> m_ReduceSetLayout;
+        std::unique_ptr<SampleSetLayout> m_SampleSetLayout;
+        std::unique_ptr<UniformBuffer<HiZData>> m_Data;
+        VkSampler m_Sampler;
+
+        // Sized for the swapchain, recreated with it
+        VkImage m_Image = VK_NULL_HANDLE;
+        VkDeviceMemory m_ImageMemory = VK_NULL_HANDLE;
+        VkImageView m_ImageView = VK_NULL_HANDLE;
+        std::vector<VkImageView> m_LevelViews;
+        VkExtent2D m_Extent{};
+        uint32_t m_LevelCount = 0;
+        uint32_t m_SwapChainGeneration = 0;
+
+        VkDescriptorSet m_SampleSet = VK_NULL_HANDLE;
+        bool m_Valid = false;
+        // The depth kept by the previous frame, and its camera
+        bool m_HasPreviousDepth = false;
+        glm::mat4 m_PreviousViewProjection{1.0f};
+    };
+} // namespace spock
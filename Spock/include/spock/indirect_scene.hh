@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/buffers.hxx"
+#include "spock/hiz_pyramid.hh"
+#include "spock/object_buffer.hh"
+#include "spock/pipeline.hh"
+#include "spock/typed_descriptor_set_layout.hxx"
+#include "spock/vulkan.hh"
+
+namespace spock
+{
+    // Matches the std430 `Object` read by the culling shader and by the vertex shaders:
+    //
+    //   struct Object {
+    //       mat4 model;
+    //       vec4 boundingSphere;
+    //       uint indexCount;
+    //       uint firstIndex;
+    //       int vertexOffset;
+    //       uint padding;
+    //   };
+    struct IndirectObject
+    {
+        glm::mat4 Model{1.0f};
+        glm::vec4 BoundingSphere{0.0f}; // Object space center and radius
+        uint32_t IndexCount = 0;
+        uint32_t FirstIndex = 0;
+        int32_t VertexOffset = 0;
+        uint32_t Padding = 0;
+    };
+    static_assert(sizeof(IndirectObject) == 96, "IndirectObject must match its std430 layout");
+
+    // Objects drawn from a single index buffer without any per object CPU work.
+    // `Cull` frustum (and optionally occlusion) culls every object on the GPU into indexed indirect commands and a
+    // draw count, `Draw` submits the survivors in one call. Vertex shaders read their object at `gl_InstanceIndex`
+    // from the set bound by `Bind`.
+    class IndirectScene {
+      public:
+        using CullSetLayout = TypedDescriptorSetLayout<StorageBufferBinding<0, VK_SHADER_STAGE_COMPUTE_BIT>,
+                                                       StorageBufferBinding<1, VK_SHADER_STAGE_COMPUTE_BIT>,
+                                                       StorageBufferBinding<2, VK_SHADER_STAGE_COMPUTE_BIT>>;
+        using ObjectSetLayout = TypedDescriptorSetLayout<StorageBufferBinding<0, VK_SHADER_STAGE_VERTEX_BIT>>;
+
+        IndirectScene(uint32_t capacity);
+        IndirectScene(const IndirectScene &) = delete;
+        IndirectScene operator=(const IndirectScene &) = delete;
+
+        // Returns the index of the object, also its `gl_InstanceIndex`
+        uint32_t AddObject(const IndirectObject &object);
+        void SetObject(uint32_t index, const IndirectObject &object);
+        const IndirectObject &GetObject(uint32_t index) const {
+            return m_ObjectData->Get<IndirectObject>(index);
+        }
+        void Clear();
+
+        uint32_t GetObjectCount() const {
+            return m_ObjectCount;
+        }
+
+        // Objects uploaded by the last `Cull`, only those that changed
+        const ObjectBuffer &GetObjectBuffer() const {
+            return *m_ObjectData;
+        }
+
+        // Culls against the `FrameGlobals` camera, must be recorded outside of rendering (see `Layer::OnCompute`).
+        // Objects hidden in `occlusion` are culled too, it must be built for this frame first.
+        void Cull(VkCommandBuffer command_buffer, const HiZPyramid *occlusion = nullptr);
+
+        // Binds the objects for the vertex shaders at `set` of a graphics pipeline using `GetDescriptorSetLayout`
+        void Bind(VkCommandBuffer command_buffer, VkPipelineLayout pipeline_layout, uint32_t set) const;
+
+        // Draws what survived `Cull`, the pipeline and index buffer must be bound
+        void Draw(VkCommandBuffer command_buffer) const;
+
+        // See `Bind`
+        VkDescriptorSet GetDescriptorSet() const {
+            return m_ObjectSet;
+        }
+
+        VkDescriptorSetLayout GetDescriptorSetLayout() const {
+            return m_ObjectSetLayout->GetDescriptorSetLayout();
+        }
+
+      public:
+        // Requires multiDrawIndirect, the constructor throws without it
+        static bool IsAvailable();
+
+        static std::unique_ptr<IndirectScene> CreateIndirectScene(uint32_t capacity);
+
+      private:
+        uint32_t m_Capacity;
+        uint32_t m_ObjectCount = 0;
+        std::unique_ptr<ObjectBuffer> m_ObjectData;
+        VkDescriptorSet m_ObjectSet = VK_NULL_HANDLE;
+
+        std::unique_ptr<Pipeline> m_CullPipeline;
+        std::unique_ptr<Pipeline> m_OcclusionCullPipeline;
+        std::unique_ptr<CullSetLayout> m_CullSetLayout;
+        std::unique_ptr<ObjectSetLayout> m_ObjectSetLayout;
+        std::unique_ptr<HiZPyramid::SampleSetLayout> m_HiZSetLayout;
+
+        // Per frame in flight, the objects are shared and only written by the scatter of the changed ones
+        std::array<std::unique_ptr<Buffer>, MAX_FRAMES_IN_FLIGHT> m_CommandBuffers;
+        std::array<std::unique_ptr<Buffer>, MAX_FRAMES_IN_FLIGHT> m_CountBuffers;
+        std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> m_CullSets{};
+        std::array<uint32_t, MAX_FRAMES_IN_FLIGHT> m_CulledCounts{};
+    };
+} // namespace spock
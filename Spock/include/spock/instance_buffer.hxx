@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/spock.hh"
+#include "spock/vulkan.hh"
+
+namespace spock
+{
+    // Per instance vertex data (`VK_VERTEX_INPUT_RATE_INSTANCE`), rewritten every frame.
+    // One host visible buffer per frame in flight, grown when a frame holds more instances than it can fit.
+    template <typename T>
+    class InstanceBuffer {
+        static_assert(std::is_trivially_copyable_v<T>, "instance data must be trivially copyable");
+
+      public:
+        InstanceBuffer(uint32_t capacity);
+        InstanceBuffer(const InstanceBuffer &) = delete;
+        InstanceBuffer operator=(const InstanceBuffer &) = delete;
+        ~InstanceBuffer();
+
+        // Replaces the instances of the frame being recorded
+        void SetData(std::span<const T> instances);
+        // Same, written in place. Every instance must be written, the content is undefined: it is either left from
+        // this frame slot's previous submission or, when `count` outgrows the buffer, freshly allocated.
+        std::span<T> Map(uint32_t count);
+
+        void Bind(VkCommandBuffer command_buffer, uint32_t binding) const;
+
+        // Every instance of the frame in a single draw, the buffer must be bound
+        void Draw(VkCommandBuffer command_buffer, uint32_t vertex_count, uint32_t first_vertex = 0) const {
+            vkCmdDraw(command_buffer, vertex_count, GetCount(), first_vertex, 0);
+        }
+
+        void DrawIndexed(VkCommandBuffer command_buffer, uint32_t index_count, uint32_t first_index = 0,
+                         int32_t vertex_offset = 0) const {
+            vkCmdDrawIndexed(command_buffer, index_count, GetCount(), first_index, vertex_offset, 0);
+        }
+
+        // Instances of the frame being recorded
+        uint32_t GetCount() const {
+            return m_Counts[s_VulkanContext.CurrentFrame];
+        }
+
+        // Buffer of the frame being recorded, replaced when `SetData` grows it
+        VkBuffer GetBuffer() const {
+            return m_Buffers[s_VulkanContext.CurrentFrame];
+        }
+
+        static constexpr VkVertexInputBindingDescription GetBindingDescription(uint32_t binding) {
+            return VkVertexInputBindingDescription{binding, sizeof(T), VK_VERTEX_INPUT_RATE_INSTANCE};
+        }
+
+      public:
+        static std::unique_ptr<InstanceBuffer<T>> CreateInstanceBuffer(uint32_t capacity = 64);
+
+      private:
+        void Allocate(uint32_t frame_index, uint32_t capacity);
+        void Release(uint32_t frame_index);
+
+      private:
+        std::array<VkBuffer, MAX_FRAMES_IN_FLIGHT> m_Buffers{};
+        std::array<VkDeviceMemory, MAX_FRAMES_IN_FLIGHT> m_BuffersMemory{};
+        std::array<void *, MAX_FRAMES_IN_FLIGHT> m_BuffersMapped{};
+        std::array<uint32_t, MAX_FRAMES_IN_FLIGHT> m_Capacities{};
+        std::array<uint32_t, MAX_FRAMES_IN_FLIGHT> m_Counts{};
+    };
+
+    template <typename T>
+    std::unique_ptr<InstanceBuffer<T>> InstanceBuffer<T>::CreateInstanceBuffer(uint32_t capacity) {
+        return std::make_unique<InstanceBuffer<T>>(capacity);
+    }
+
+    template <typename T>
+    InstanceBuffer<T>::InstanceBuffer(uint32_t capacity) {
+        for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            Allocate(i, std::max(capacity, 1u));
+        }
+    }
+
+    template <typename T>
+    void InstanceBuffer<T>::Allocate(uint32_t frame_index, uint32_t capacity) {
+        VkDeviceSize buffer_size = sizeof(T) * capacity;
+
+        Spock::CreateBuffer(buffer_size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                            m_Buffers[frame_index], m_BuffersMemory[frame_index]);
+        vkMapMemory(s_VulkanContext.Device, m_BuffersMemory[frame_index], 0, buffer_size, 0,
+                    &m_BuffersMapped[frame_index]);
+
+        m_Capacities[frame_index] = capacity;
+    }
+
+    template <typename T>
+    void InstanceBuffer<T>::Release(uint32_t frame_index) {
+        vkDestroyBuffer(s_VulkanContext.Device, m_Buffers[frame_index], nullptr);
+        vkFreeMemory(s_VulkanContext.Device, m_BuffersMemory[frame_index], nullptr);
+    }
+
+    template <typename T>
+    void InstanceBuffer<T>::SetData(std::span<const T> instances) {
+        auto mapped = Map(static_cast<uint32_t>(instances.size()));
+        memcpy(mapped.data(), instances.data(), instances.size_bytes());
+    }
+
+    template <typename T>
+    std::span<T> InstanceBuffer<T>::Map(uint32_t count) {
+        auto frame_index = s_VulkanContext.CurrentFrame;
+
+        // The previous submission of this frame is done, its buffer can be replaced
+        if (count > m_Capacities[frame_index]) {
+            Release(frame_index);
+            Allocate(frame_index, std::max(count, m_Capacities[frame_index] * 2));
+        }
+
+        m_Counts[frame_index] = count;
+        return std::span<T>(static_cast<T *>(m_BuffersMapped[frame_index]), count);
+    }
+
+    template <typename T>
+    void InstanceBuffer<T>::Bind(VkCommandBuffer command_buffer, uint32_t binding) const {
+        VkDeviceSize offset = 0;
+        vkCmdBindVertexBuffers(command_buffer, binding, 1, &m_Buffers[s_VulkanContext.CurrentFrame], &offset);
+    }
+
+    template <typename T>
+    InstanceBuffer<T>::~InstanceBuffer() {
+        for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            Release(i);
+        }
+    }
+} // namespace spock
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace spock
+{
+    // A fixed pool of worker threads (one per core, minus the calling thread), started on first use.
+    class JobSystem {
+      public:
+        // Runs `job` on a worker thread
+        template <typename F>
+        static std::future<std::invoke_result_t<F>> Submit(F &&job);
+
+        // Splits [0, count) in batches of `batch_size` processed by the workers and the calling thread.
+        // Returns once every batch is done, then rethrows the first exception a batch threw.
+        static void ParallelFor(size_t count, size_t batch_size,
+                                const std::function<void(size_t begin, size_t end)> &job);
+
+        static uint32_t GetWorkerCount();
+
+      private:
+        static void Enqueue(std::function<void()> &&job);
+    };
+
+    template <typename F>
+    std::future<std::invoke_result_t<F>> JobSystem::Submit(F &&job) {
+        // std::function must be copyable, share the task
+        auto task = std::make_shared<std::packaged_task<std::invoke_result_t<F>()>>(std::forward<F>(job));
+        auto future = task->get_future();
+
+        Enqueue([task]() { (*task)(); });
+
+        return future;
+    }
+} // namespace spock
@@ -2,6 +2,8 @@
 
 #include <vulkan/vulkan_core.h>
 
+#include "spock/command_recorder.hh"
+
 namespace spock
 {
     class VulkanInstance;
@@ -15,7 +17,11 @@ namespace spock
         virtual void OnAttach() = 0;
         virtual void OnDetach() = 0;
         virtual void OnUpdate(float delta_time) = 0;
-        virtual void OnRender(VkCommandBuffer command_buffer) = 0;
+        // Recorded outside of the render pass, before `OnRender` (dispatches, copies, barriers)
+        virtual void OnCompute(VkCommandBuffer) {
+        }
+        // Inside the frame render pass, binds go through `recorder` so redundant ones are dropped
+        virtual void OnRender(CommandRecorder &recorder) = 0;
         virtual void OnUIRender(VkCommandBuffer command_buffer) = 0;
 
       protected:
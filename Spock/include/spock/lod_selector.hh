@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "spock/frame_globals.hh"
+#include "spock/geometry_buffer.hh"
+
+namespace spock
+{
+    // Picks levels of detail by the size their error takes on screen: the coarsest level whose error projects to
+    // less than `threshold` pixels is drawn. Built once per frame from the camera.
+    class LodSelector {
+      public:
+        LodSelector(const FrameGlobalsData &frame, float threshold = 1.0f);
+
+        // Pixels covered by `error` world space units at `distance` from the camera
+        float ProjectError(float error, float distance) const {
+            return error * m_ProjectionScale / distance;
+        }
+
+        // For a mesh whose world space bounding sphere is `center` and `radius`, scaled by `scale` from object space
+        uint32_t Select(const GeometryBuffer::Mesh &mesh, const glm::vec3 &center, float radius, float scale) const;
+
+      private:
+        glm::vec3 m_CameraPosition;
+        // Pixels per world space unit at a distance of one
+        float m_ProjectionScale;
+        float m_Threshold;
+    };
+} // namespace spock
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+namespace spock
+{
+    // One level of detail of an indexed mesh, indexing the vertices of the full resolution mesh
+    struct LodLevel
+    {
+        std::vector<uint32_t> Indices;
+        // Distance the surface may have moved from the full resolution mesh, in object space units
+        float Error = 0.0f;
+    };
+
+    // Reduces the triangle count of indexed meshes by collapsing edges in the order of their quadric error
+    // (Garland & Heckbert). Vertices are never moved or created: simplified meshes only index the original
+    // vertices, so every level of detail shares a single vertex range. Open borders and attribute seams (vertices
+    // sharing a position) are kept in place.
+    class MeshSimplifier {
+      public:
+        // Stops once `target_index_count` is reached or when the next collapse would exceed `target_error`,
+        // `result_error` is set to the error of the returned mesh
+        static std::vector<uint32_t> Simplify(std::span<const glm::vec3> positions, std::span<const uint32_t> indices,
+                                              size_t target_index_count, float target_error, float &result_error);
+
+        // Full resolution first, each level keeping about `reduction` of the triangles of the previous one.
+        // Stops early when a mesh cannot be simplified any further.
+        static std::vector<LodLevel> GenerateLods(std::span<const glm::vec3> positions,
+                                                  std::span<const uint32_t> indices, uint32_t max_lods,
+                                                  float reduction = 0.5f);
+
+      private:
+        // Squared distance to a set of planes, weighted by the area of their triangles
+        struct Quadric
+        {
+            double A00 = 0, A01 = 0, A02 = 0, A11 = 0, A12 = 0, A22 = 0;
+            double B0 = 0, B1 = 0, B2 = 0;
+            double C = 0;
+            double Weight = 0;
+
+            void AddPlane(const glm::dvec3 &normal, double distance, double weight);
+            void Add(const Quadric &other);
+            // Weighted mean of the squared distances of `point` to the planes
+            double Evaluate(const glm::dvec3 &point) const;
+        };
+    };
+} // namespace spock
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/buffers.hxx"
+#include "spock/pipeline.hh"
+#include "spock/typed_descriptor_set_layout.hxx"
+#include "spock/vulkan.hh"
+
+namespace spock
+{
+    // Per object data of a whole scene in one device local storage buffer, indexed by object.
+    // `Set` keeps a copy and remembers the object changed, `Upload` sends only the changed ones as a compact list
+    // scattered into place by a compute shader. Static objects cost nothing once uploaded.
+    class ObjectBuffer {
+      public:
+        using ScatterSetLayout = TypedDescriptorSetLayout<StorageBufferBinding<0, VK_SHADER_STAGE_COMPUTE_BIT>,
+                                                          StorageBufferBinding<1, VK_SHADER_STAGE_COMPUTE_BIT>,
+                                                          StorageBufferBinding<2, VK_SHADER_STAGE_COMPUTE_BIT>>;
+
+        // `object_size` must be a multiple of 4 bytes, shaders read the buffer as an std430 array
+        ObjectBuffer(uint32_t object_size, uint32_t capacity, VkBufferUsageFlags usage = 0);
+        ObjectBuffer(const ObjectBuffer &) = delete;
+        ObjectBuffer operator=(const ObjectBuffer &) = delete;
+
+        void Set(uint32_t index, const void *data);
+
+        template <typename T>
+        void Set(uint32_t index, const T &data) {
+            static_assert(std::is_trivially_copyable_v<T>, "object data must be trivially copyable");
+            if (sizeof(T) != m_ObjectSize) {
+                throw std::invalid_argument("object size does not match the object buffer!");
+            }
+
+            Set(index, static_cast<const void *>(&data));
+        }
+
+        template <typename T>
+        const T &Get(uint32_t index) const {
+            return *reinterpret_cast<const T *>(m_Objects.data() + static_cast<size_t>(index) * m_ObjectSize);
+        }
+
+        // Records the scatter of the objects set since the last upload, must be recorded outside of rendering
+        // (see `Layer::OnCompute`). The buffer is ready for vertex and compute shaders afterwards.
+        void Upload(VkCommandBuffer command_buffer);
+
+        const Buffer &GetBuffer() const {
+            return *m_Buffer;
+        }
+
+        uint32_t GetCapacity() const {
+            return m_Capacity;
+        }
+
+        // Objects and bytes sent by the last `Upload`
+        uint32_t GetUploadedCount() const {
+            return m_UploadedCount;
+        }
+
+        VkDeviceSize GetUploadedSize() const {
+            return m_UploadedSize;
+        }
+
+      public:
+        static std::unique_ptr<ObjectBuffer> CreateObjectBuffer(uint32_t object_size, uint32_t capacity,
+                                                                VkBufferUsageFlags usage = 0);
+
+        template <typename T>
+        static std::unique_ptr<ObjectBuffer> CreateObjectBuffer(uint32_t capacity, VkBufferUsageFlags usage = 0) {
+            return CreateObjectBuffer(sizeof(T), capacity, usage);
+        }
+
+      private:
+        void ReserveDelta(uint32_t frame_index, uint32_t count);
+
+      private:
+        uint32_t m_ObjectSize;
+        uint32_t m_Capacity;
+
+        std::unique_ptr<Buffer> m_Buffer;
+        std::unique_ptr<Pipeline> m_ScatterPipeline;
+        std::unique_ptr<ScatterSetLayout> m_ScatterSetLayout;
+
+        // Host copy of every object, and those changed since the last upload
+        std::vector<std::byte> m_Objects;
+        std::vector<uint8_t> m_Dirty;
+        std::vector<uint32_t> m_DirtyIndices;
+
+        // Per frame in flight, grown when a frame changes more objects than they fit
+        std::array<std::unique_ptr<Buffer>, MAX_FRAMES_IN_FLIGHT> m_DeltaIndices;
+        std::array<std::unique_ptr<Buffer>, MAX_FRAMES_IN_FLIGHT> m_DeltaData;
+        std::array<uint32_t, MAX_FRAMES_IN_FLIGHT> m_DeltaCapacities{};
+
+        uint32_t m_UploadedCount = 0;
+        VkDeviceSize m_UploadedSize = 0;
+    };
+} // namespace spock
@@ -1,33 +1,121 @@
 #pragma once
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include <vulkan/vulkan_core.h>
 
+#include "spock/frame_globals.hh"
+#include "spock/shader_compiler.hh"
+#include "spock/shader_module.hh"
+
 namespace spock
 {
+    // Maps a member of a specialization struct to a `constant_id` of the shader
+    template <typename T, typename M>
+    struct SpecializationConstant
+    {
+        uint32_t ConstantID;
+        M T::*Member;
+    };
+
     class PipelineStage {
       public:
-        PipelineStage(VkShaderModule shader_module, VkPipelineShaderStageCreateInfo shader_stage_create_info);
+        PipelineStage(std::shared_ptr<ShaderModule> shader_module, VkShaderStageFlagBits stage);
         PipelineStage(const PipelineStage &) = delete;
         PipelineStage operator=(const PipelineStage &) = delete;
         PipelineStage(PipelineStage &&other) noexcept;
-        ~PipelineStage();
 
         VkPipelineShaderStageCreateInfo GetShaderStage() const {
-            return m_ShaderStage;
+            auto shader_stage = m_ShaderStage;
+            if (!m_SpecializationEntries.empty())
+                shader_stage.pSpecializationInfo = &m_SpecializationInfo;
+
+            return shader_stage;
         }
 
+        VkShaderStageFlagBits GetStage() const {
+            return m_ShaderStage.stage;
+        }
+
+        // Describes this stage as a shader object (VK_EXT_shader_object), layouts are filled by the pipeline
+        VkShaderCreateInfoEXT GetShaderCreateInfo(VkShaderStageFlags next_stage) const;
+
+        // Sets the specialization constants of the stage from the members of `values`, e.g.
+        // `stage.Specialize(constants, SpecializationConstant{0, &Constants::LightCount})`
+        template <typename T, typename... M>
+        void Specialize(const T &values, SpecializationConstant<T, M>... constants);
+
       public:
         static PipelineStage PipelineStageFromFile(const std::string &path, VkShaderStageFlagBits stage);
         static PipelineStage PipelineStageFromData(const uint32_t *code, size_t size, VkShaderStageFlagBits stage);
+        // SPIR-V embedded in the binary, referenced without being copied
+        static PipelineStage PipelineStageFromData(std::span<const uint32_t> code, VkShaderStageFlagBits stage);
+        // Compiles GLSL at runtime, see `ShaderCompiler`
+        static PipelineStage PipelineStageFromGLSL(const std::string &path, VkShaderStageFlagBits stage,
+                                                   const ShaderDefines &defines = {});
 
       private:
-        VkShaderModule m_ShaderModule;
+        std::shared_ptr<ShaderModule> m_ShaderModule;
         VkPipelineShaderStageCreateInfo m_ShaderStage;
+
+        std::vector<uint8_t> m_SpecializationData;
+        std::vector<VkSpecializationMapEntry> m_SpecializationEntries;
+        VkSpecializationInfo m_SpecializationInfo{};
     };
 
+    template <typename T, typename... M>
+    void PipelineStage::Specialize(const T &values, SpecializationConstant<T, M>... constants) {
+        static_assert(std::is_trivially_copyable_v<T>, "specialization constants must be trivially copyable");
+        static_assert(((std::is_arithmetic_v<M> && !std::is_same_v<M, bool>) && ...),
+                      "specialization constants must be scalars, use VkBool32 for booleans");
+        static_assert(((sizeof(M) == 4 || sizeof(M) == 8) && ...),
+                      "specialization constants must be 32 or 64 bits wide");
+
+        m_SpecializationData.resize(sizeof(T));
+        memcpy(m_SpecializationData.data(), &values, sizeof(T));
+
+        auto base = reinterpret_cast<const uint8_t *>(&values);
+        m_SpecializationEntries = {VkSpecializationMapEntry{
+            constants.ConstantID,
+            static_cast<uint32_t>(reinterpret_cast<const uint8_t *>(&(values.*constants.Member)) - base),
+            sizeof(M),
+        }...};
+
+        for (size_t i = 0; i < m_SpecializationEntries.size(); i++) {
+            for (size_t j = i + 1; j < m_SpecializationEntries.size(); j++) {
+                if (m_SpecializationEntries[i].constantID == m_SpecializationEntries[j].constantID) {
+                    throw std::invalid_argument("duplicate specialization constant id!");
+                }
+            }
+        }
+
+        m_SpecializationInfo.mapEntryCount = static_cast<uint32_t>(m_SpecializationEntries.size());
+        m_SpecializationInfo.pMapEntries = m_SpecializationEntries.data();
+        m_SpecializationInfo.dataSize = m_SpecializationData.size();
+        m_SpecializationInfo.pData = m_SpecializationData.data();
+    }
+
+    // Push constant size every device supports
+    static constexpr uint32_t MAX_PUSH_CONSTANTS_SIZE = 128;
+
+    // Declares a push constant range holding a `T` at `Offset`, pushed with `Pipeline::Push<T, Offset>`
+    template <typename T, uint32_t Offset = 0>
+    constexpr VkPushConstantRange PushConstantRange(VkShaderStageFlags stages) {
+        static_assert(std::is_trivially_copyable_v<T>, "push constants must be trivially copyable");
+        static_assert(Offset % 4 == 0 && sizeof(T) % 4 == 0, "push constants must be 4 bytes aligned");
+        static_assert(Offset + sizeof(T) <= MAX_PUSH_CONSTANTS_SIZE, "push constants must fit in 128 bytes");
+
+        return VkPushConstantRange{stages, Offset, static_cast<uint32_t>(sizeof(T))};
+    }
+
     struct PipelineConfig
     {
         PipelineConfig() = default;
@@ -35,12 +123,25 @@ namespace spock
         PipelineConfig operator=(const PipelineConfig &) = delete;
         PipelineConfig(PipelineConfig &&) = default;
 
+        // A single VK_SHADER_STAGE_COMPUTE_BIT stage creates a compute pipeline, vertex input is then ignored
         std::vector<PipelineStage> Stages;
         std::vector<VkDescriptorSetLayout> DescriptorSetLayouts;
-        VkVertexInputBindingDescription BindingDescription;
+        // Per vertex and per instance (`VK_VERTEX_INPUT_RATE_INSTANCE`, see `InstanceBuffer`) bindings
+        std::vector<VkVertexInputBindingDescription> BindingDescriptions;
         std::vector<VkVertexInputAttributeDescription> AttributeDescriptions;
         std::vector<VkPushConstantRange> PushConstants;
         VkPrimitiveTopology Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+        // Skip pipeline creation and bind shader objects with dynamic state instead.
+        // Falls back to a regular pipeline when VK_EXT_shader_object is not available.
+        bool UseShaderObjects = false;
+
+        // Every set layout comes from `DescriptorSetLayout::CreateDescriptorBufferLayout`, see `DescriptorBuffer`
+        bool UseDescriptorBuffers = false;
+
+        // Set 0 is `FrameGlobals`, bound with the pipeline. `DescriptorSetLayouts` then start at set 1,
+        // see `DescriptorSetFrequency`. Not supported with descriptor buffers.
+        bool UseFrameGlobals = false;
     };
 
     class Pipeline {
@@ -57,8 +158,57 @@ namespace spock
             return m_PipelineLayout;
         }
 
+        VkPipelineBindPoint GetBindPoint() const {
+            return m_BindPoint;
+        }
+
+        bool UsesShaderObjects() const {
+            return !m_Shaders.empty();
+        }
+
+        bool UsesFrameGlobals() const {
+            return m_UsesFrameGlobals;
+        }
+
+        // `stages` must match a range declared with `PushConstantRange<T, Offset>`
+        template <typename T, uint32_t Offset = 0>
+        void Push(VkCommandBuffer command_buffer, VkShaderStageFlags stages, const T &data) const;
+
+      private:
+        static std::unique_ptr<Pipeline> CreateComputePipeline(PipelineConfig &pipeline_config,
+                                                               VkPipelineLayout pipeline_layout);
+        static std::unique_ptr<Pipeline> CreateShaderObjects(PipelineConfig &pipeline_config,
+                                                             VkPipelineLayout pipeline_layout);
+        void SetDynamicState(VkCommandBuffer command_buffer) const;
+
       private:
         VkPipeline m_Pipeline;
         VkPipelineLayout m_PipelineLayout;
+        VkPipelineBindPoint m_BindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+
+        // Shader object path, every piece of state is set on bind
+        std::vector<VkShaderStageFlagBits> m_ShaderStages;
+        std::vector<VkShaderEXT> m_Shaders;
+        std::vector<VkVertexInputBindingDescription2EXT> m_VertexBindings;
+        std::vector<VkVertexInputAttributeDescription2EXT> m_VertexAttributes;
+        VkPrimitiveTopology m_Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+        std::vector<VkPushConstantRange> m_PushConstantRanges;
+        bool m_UsesFrameGlobals = false;
     };
+
+    template <typename T, uint32_t Offset>
+    void Pipeline::Push(VkCommandBuffer command_buffer, VkShaderStageFlags stages, const T &data) const {
+        constexpr auto range = PushConstantRange<T, Offset>(0);
+
+        // Every stage of a declared range must be updated, and only from ranges covering the bytes
+        assert(std::any_of(m_PushConstantRanges.begin(), m_PushConstantRanges.end(),
+                           [stages, &range](const VkPushConstantRange &declared) {
+                               return declared.stageFlags == stages && declared.offset <= range.offset
+                                   && range.offset + range.size <= declared.offset + declared.size;
+                           })
+               && "push constants do not match a declared range");
+
+        vkCmdPushConstants(command_buffer, m_PipelineLayout, stages, range.offset, range.size, &data);
+    }
 } // namespace spock
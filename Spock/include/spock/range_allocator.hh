@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+
+namespace spock
+{
+    // Hands out ranges of `[0, capacity)`, first fit. Freed ranges are merged with their free neighbours so the
+    // space of unloaded resources can be reused by bigger ones.
+    class RangeAllocator {
+      public:
+        static constexpr uint32_t INVALID_OFFSET = UINT32_MAX;
+
+        RangeAllocator(uint32_t capacity);
+
+        // Offset of `size` free units, INVALID_OFFSET when no free range is large enough
+        uint32_t Allocate(uint32_t size);
+        // `offset` and `size` must be those of a previous allocation
+        void Free(uint32_t offset, uint32_t size);
+
+        uint32_t GetCapacity() const {
+            return m_Capacity;
+        }
+
+        uint32_t GetFreeSize() const {
+            return m_FreeSize;
+        }
+
+      private:
+        uint32_t m_Capacity;
+        uint32_t m_FreeSize;
+        // Offset to size, never adjacent to each other
+        std::map<uint32_t, uint32_t> m_FreeRanges;
+    };
+} // namespace spock
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/command_recorder.hh"
+#include "spock/frame_globals.hh"
+#include "spock/pipeline.hh"
+
+namespace spock
+{
+    // Vertex buffers a packet can bind, from binding 0
+    static constexpr uint32_t MAX_PACKET_VERTEX_BUFFERS = 2;
+
+    // Everything needed to record one draw
+    struct DrawPacket
+    {
+        // See `RenderQueue::MakeSortKey`
+        uint64_t SortKey = 0;
+
+        const Pipeline *DrawPipeline = nullptr;
+        // Bound at `MaterialSetIndex` when set
+        VkDescriptorSet MaterialSet = VK_NULL_HANDLE;
+        uint32_t MaterialSetIndex = MATERIAL_SET;
+
+        // Bound from binding 0 up to the first VK_NULL_HANDLE
+        std::array<VkBuffer, MAX_PACKET_VERTEX_BUFFERS> VertexBuffers{};
+        // 32 bits indices, the draw is indexed when set
+        VkBuffer IndexBuffer = VK_NULL_HANDLE;
+
+        uint32_t Count = 0; // Vertices, or indices when indexed
+        uint32_t InstanceCount = 1;
+        uint32_t First = 0; // First vertex, or first index when indexed
+        int32_t VertexOffset = 0;
+        uint32_t FirstInstance = 0;
+
+        // Pushed at offset 0 before the draw, see `SetPushConstants`
+        VkShaderStageFlags PushStages = 0;
+        uint32_t PushSize = 0;
+        std::array<std::byte, MAX_PUSH_CONSTANTS_SIZE> PushData{};
+
+        // `stages` must match a range declared with `PushConstantRange<T>`
+        template <typename T>
+        void SetPushConstants(VkShaderStageFlags stages, const T &data) {
+            constexpr auto range = PushConstantRange<T>(0);
+
+            PushStages = stages;
+            PushSize = range.size;
+            memcpy(PushData.data(), &data, sizeof(T));
+        }
+    };
+
+    // Collects the draws of a frame and records them sorted by key, see `Application::GetRenderQueue`.
+    // Keys are radix sorted so packets sharing a pipeline, then a material, are recorded next to each other and the
+    // binds they share are dropped by the `CommandRecorder`.
+    class RenderQueue {
+      public:
+        RenderQueue() = default;
+        RenderQueue(const RenderQueue &) = delete;
+        RenderQueue operator=(const RenderQueue &) = delete;
+
+        // Most significant bits first: | pass (8) | pipeline (16) | material (16) | depth (24) |
+        static constexpr uint64_t PackSortKey(uint8_t pass, uint16_t pipeline_id, uint16_t material_id,
+                                              uint32_t depth) {
+            return static_cast<uint64_t>(pass) << 56 | static_cast<uint64_t>(pipeline_id) << 40
+                 | static_cast<uint64_t>(material_id) << 24 | (depth & 0xFFFFFF);
+        }
+
+        // 24 bits of a [0, 1] depth, drawn front to back. Pass `1 - depth` for back to front (transparency).
+        static constexpr uint32_t QuantizeDepth(float depth) {
+            return static_cast<uint32_t>(std::clamp(depth, 0.0f, 1.0f) * 0xFFFFFF);
+        }
+
+        // Pipelines and materials get small ids in the order they are first seen since the last `Flush`
+        uint64_t MakeSortKey(uint8_t pass, const Pipeline &pipeline, VkDescriptorSet material, float depth);
+
+        void Submit(const DrawPacket &packet);
+
+        // Sorts and records every packet submitted since the last flush, called by `Application::Run` after the
+        // layers `OnRender`
+        void Flush(CommandRecorder &recorder);
+
+        // Packets recorded by the last `Flush`
+        uint32_t GetPacketCount() const {
+            return m_PacketCount;
+        }
+
+      private:
+        struct SortEntry
+        {
+            uint64_t Key;
+            uint32_t Index;
+        };
+
+        static uint16_t GetId(std::unordered_map<uint64_t, uint16_t> &ids, uint64_t handle);
+        static void RadixSort(std::vector<SortEntry> &entries, std::vector<SortEntry> &scratch);
+
+      private:
+        std::vector<DrawPacket> m_Packets;
+        std::vector<SortEntry> m_Entries;
+        std::vector<SortEntry> m_Scratch;
+
+        std::unordered_map<uint64_t, uint16_t> m_PipelineIds;
+        std::unordered_map<uint64_t, uint16_t> m_MaterialIds;
+
+        uint32_t m_PacketCount = 0;
+    };
+} // namespace spock
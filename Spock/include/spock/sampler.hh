@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vulkan/vulkan_core.h>
+
+namespace spock
+{
+    // Sampler state, identical descriptions share a single VkSampler (see `Sampler::Get`)
+    struct SamplerDescription
+    {
+        VkFilter MagFilter = VK_FILTER_LINEAR;
+        VkFilter MinFilter = VK_FILTER_LINEAR;
+        VkSamplerMipmapMode MipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        VkSamplerAddressMode AddressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        VkSamplerAddressMode AddressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        VkSamplerAddressMode AddressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        VkBorderColor BorderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+
+        // Clamped to the device limit, 1 or less disables anisotropic filtering
+        float MaxAnisotropy = 16.0f;
+        float MipLodBias = 0.0f;
+        float MinLod = 0.0f;
+        // The image view already limits the mip levels, no need for a sampler per mip count
+        float MaxLod = VK_LOD_CLAMP_NONE;
+
+        // Depth comparison, for shadow maps
+        bool CompareEnable = false;
+        VkCompareOp CompareOp = VK_COMPARE_OP_ALWAYS;
+
+        bool operator==(const SamplerDescription &) const = default;
+        size_t GetHash() const;
+    };
+
+    struct SamplerDescriptionHash
+    {
+        size_t operator()(const SamplerDescription &description) const {
+            return description.GetHash();
+        }
+    };
+
+    // Cache of the samplers, they live until `Spock::Cleanup`.
+    // Devices may only allow a few thousand samplers (`maxSamplerAllocationCount`), share them instead of creating
+    // one per texture.
+    class Sampler {
+      public:
+        static VkSampler Get(const SamplerDescription &description = {});
+
+        static uint32_t GetCount();
+        static void Clear();
+    };
+} // namespace spock
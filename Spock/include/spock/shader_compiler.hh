@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <future>
+#include <string>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+namespace spock
+{
+    // `#define NAME VALUE` pairs, one set per shader permutation
+    using ShaderDefines = std::vector<std::pair<std::string, std::string>>;
+
+    // Runtime GLSL to SPIR-V compilation (shaderc).
+    // Results are cached on disk in `SpockSettings::ShaderCacheDirectory`, keyed by source, included files, stage,
+    // defines and compiler version, so a permutation is only ever compiled once.
+    // `#include` paths are relative to the including file, `name` for the top level source.
+    class ShaderCompiler {
+      public:
+        static std::vector<uint32_t> Compile(const std::string &source, const std::string &name,
+                                             VkShaderStageFlagBits stage, const ShaderDefines &defines = {});
+        static std::vector<uint32_t> CompileFile(const std::string &path, VkShaderStageFlagBits stage,
+                                                 const ShaderDefines &defines = {});
+
+        // Same as `CompileFile`, on a worker thread
+        static std::future<std::vector<uint32_t>> CompileFileAsync(const std::string &path, VkShaderStageFlagBits stage,
+                                                                   const ShaderDefines &defines = {});
+
+        static bool IsAvailable();
+    };
+} // namespace spock
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+namespace spock
+{
+    // First word of every SPIR-V module
+    static constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+
+    // A VkShaderModule shared by every stage using the same SPIR-V, the registry is safe to use from any thread.
+    // Modules are registered by content hash and live until `ShaderModule::Trim` or `Spock::Cleanup`, which also
+    // destroys the VkShaderModule of those still held by a stage so none outlives the device.
+    class ShaderModule {
+      public:
+        struct Statistics
+        {
+            uint32_t Created = 0;
+            uint32_t Reused = 0;
+            size_t Cached = 0;
+        };
+
+        // `code` is referenced as is when `owned_code` is empty
+        ShaderModule(VkShaderModule shader_module, std::span<const uint32_t> code, std::vector<uint32_t> &&owned_code,
+                     uint64_t hash);
+        ShaderModule(const ShaderModule &) = delete;
+        ShaderModule operator=(const ShaderModule &) = delete;
+        ~ShaderModule();
+
+        VkShaderModule GetShaderModule() const {
+            return m_ShaderModule;
+        }
+
+        std::span<const uint32_t> GetCode() const {
+            return m_Code;
+        }
+
+        uint64_t GetHash() const {
+            return m_Hash;
+        }
+
+      public:
+        // Returns the registered module for this SPIR-V (`size` in bytes), creating it on first use
+        static std::shared_ptr<ShaderModule> FromData(const uint32_t *code, size_t size);
+        // Same as `FromData` without copying the code, which must outlive the module (e.g. embedded SPIR-V)
+        static std::shared_ptr<ShaderModule> FromStaticData(std::span<const uint32_t> code);
+        // Same as `FromData`, files already loaded are only read again once their size or write time changed
+        static std::shared_ptr<ShaderModule> FromFile(const std::string &path);
+
+        // Destroys the modules no longer referenced by any stage
+        static void Trim();
+        // Destroys every VkShaderModule, modules still referenced are left without one
+        static void Clear();
+        static Statistics GetStatistics();
+
+      private:
+        void Release();
+
+        // The registry must be locked
+        static std::shared_ptr<ShaderModule> Find(std::span<const uint32_t> code, uint64_t hash);
+        static std::shared_ptr<ShaderModule> Create(std::span<const uint32_t> code, std::vector<uint32_t> &&owned_code,
+                                                    uint64_t hash);
+
+      private:
+        VkShaderModule m_ShaderModule;
+        std::vector<uint32_t> m_OwnedCode;
+        std::span<const uint32_t> m_Code;
+        uint64_t m_Hash;
+    };
+} // namespace spock
@@ -26,6 +26,13 @@ namespace spock
         // Choose `VK_PRESENT_MODE_FIFO_KHR` for V-Sync
         std::vector<VkPresentModeKHR> PresentModes = {VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR,
                                                       VK_PRESENT_MODE_FIFO_KHR};
+
+        // Where runtime compiled shaders are cached, `nullptr` disables the cache
+        const char *ShaderCacheDirectory = ".spock/shader_cache";
+
+        // Enables VK_EXT_descriptor_buffer when supported, see `DescriptorBuffer`.
+        // Every uniform and storage buffer is then created with a device address.
+        bool UseDescriptorBuffers = false;
     };
 
     class Window;
@@ -38,7 +45,9 @@ namespace spock
         static void WaitForIdle();
 
         // Rendering
+        // The frame is recorded outside of any render pass until `BeginRendering`, e.g. for compute dispatches
         static VkCommandBuffer BeginFrame();
+        static void BeginRendering(VkCommandBuffer command_buffer);
         static void EndFrame(VkCommandBuffer command_buffer);
         static uint32_t GetCurrentFrame();
 
@@ -55,18 +64,24 @@ namespace spock
 
         static void CreateSwapchain();
         static void CreateImageViews();
-        static void CreateRenderPass();
         static void CreateColorResources();
         static void CreateDepthResources();
-        static void CreateFramebuffers();
         static void CreateSyncObjects();
 
         static void CreateCommandBuffers();
         static void CreateDescriptorPool();
+        static void CreateBindlessTextures();
+        static void CreateFrameGlobals();
+
+        // Per frame updates
+        static void UpdateFrameGlobals();
+        static void UploadFrameGlobals();
 
         // Cleanup functions
         static void CleanupSwapchain();
         static void RecreateSwapchain();
+        static void CleanupBindlessTextures();
+        static void CleanupFrameGlobals();
 
         // UI
         static void InitImGUI();
@@ -82,6 +97,8 @@ namespace spock
                                 VkMemoryPropertyFlags properties, VkImage &image, VkDeviceMemory &image_memory);
         static void CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
                                  VkBuffer &buffer, VkDeviceMemory &buffer_memory);
+        // The buffer must be created with VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
+        static VkDeviceAddress GetBufferDeviceAddress(VkBuffer buffer);
         static void CopyBuffer(VkBuffer src, VkBuffer dst, VkDeviceSize size);
         static void CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
         static void TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout old_layout,
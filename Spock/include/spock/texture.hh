@@ -2,19 +2,24 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <vulkan/vulkan_core.h>
 
+#include "spock/sampler.hh"
+
 namespace spock
 {
     class Texture2D {
       public:
-        Texture2D(uint8_t *data, int width, int height, int channels, int mip_levels);
+        // The sampler comes from the sampler cache and is shared with every texture using the same description
+        Texture2D(uint8_t *data, int width, int height, int channels, int mip_levels,
+                  const SamplerDescription &sampler = {});
         Texture2D(const Texture2D &) = delete;
         Texture2D operator=(const Texture2D &) = delete;
         ~Texture2D();
 
         // Opens an image file from disk and create a GPU texture from it.
-        static std::shared_ptr<Texture2D> FromFile(const std::string &path);
+        static std::shared_ptr<Texture2D> FromFile(const std::string &path, const SamplerDescription &sampler = {});
 
         // Getters
         VkImageView GetImageView() const {
@@ -25,10 +30,14 @@ namespace spock
             return m_TextureSampler;
         }
 
+        // Index in the bindless texture table, `BindlessTextures::INVALID_INDEX` when unavailable
+        uint32_t GetBindlessIndex() const {
+            return m_BindlessIndex;
+        }
+
       private:
         void GenerateMipmaps(VkImage image, VkFormat format, int32_t width, int32_t height, uint32_t mip_levels);
         void CreateTextureImageView();
-        void CreateTextureSampler();
 
       private:
         int m_Width;
@@ -39,5 +48,6 @@ namespace spock
         VkDeviceMemory m_TextureImageMemory;
         VkImageView m_TextureImageView;
         VkSampler m_TextureSampler;
+        uint32_t m_BindlessIndex;
     };
 } // namespace spock
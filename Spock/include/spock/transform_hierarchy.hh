@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+namespace spock
+{
+    // Parent child transforms kept in contiguous arrays sorted by depth, every parent before its children.
+    // `Update` walks the levels from the shallowest changed one and only recomputes the world transforms under a
+    // changed local one, each level split over the `JobSystem`. Nodes holding an object write their world transform
+    // at its index, e.g. in the mapped memory of a GPU object buffer.
+    class TransformHierarchy {
+      public:
+        static constexpr uint32_t INVALID_NODE = UINT32_MAX;
+        static constexpr uint32_t NO_OBJECT = UINT32_MAX;
+
+        TransformHierarchy() = default;
+        TransformHierarchy(const TransformHierarchy &) = delete;
+        TransformHierarchy operator=(const TransformHierarchy &) = delete;
+
+        // Returns the handle of the node, kept when the arrays are sorted again
+        uint32_t AddNode(uint32_t parent, const glm::mat4 &local, uint32_t object = NO_OBJECT);
+        void Reserve(size_t count);
+        void Clear();
+
+        void SetLocal(uint32_t node, const glm::mat4 &local);
+        const glm::mat4 &GetLocal(uint32_t node) const {
+            return m_Local[m_Indices[node]];
+        }
+
+        // As of the last `Update`
+        const glm::mat4 &GetWorld(uint32_t node) const {
+            return m_World[m_Indices[node]];
+        }
+
+        uint32_t GetNodeCount() const {
+            return static_cast<uint32_t>(m_Indices.size());
+        }
+
+        // Propagates the local transforms set since the last update, returns how many world transforms changed
+        uint32_t Update();
+
+        // Nodes whose world transform changed in the last `Update`
+        std::span<const uint32_t> GetChangedNodes() const {
+            return m_ChangedNodes;
+        }
+
+        // Copies world transforms to `destination + object * stride` for the nodes holding an object. Only those that
+        // changed in the last `Update` when `changed_only`, buffers rewritten every frame need all of them.
+        void WriteWorldTransforms(void *destination, size_t stride = sizeof(glm::mat4),
+                                  bool changed_only = false) const;
+
+      private:
+        void Sort();
+
+      private:
+        // By depth, indices in these arrays are not handles
+        std::vector<glm::mat4> m_Local;
+        std::vector<glm::mat4> m_World;
+        std::vector<uint32_t> m_Parents; // Index, or INVALID_NODE for roots
+        std::vector<uint32_t> m_Depths;
+        std::vector<uint32_t> m_Objects;
+        std::vector<uint32_t> m_Handles;
+        std::vector<uint8_t> m_Dirty;
+
+        // Handle to index
+        std::vector<uint32_t> m_Indices;
+        // First index of every depth, and the node count
+        std::vector<uint32_t> m_LevelStarts;
+        // Nodes were added under a shallower level than the last one
+        bool m_Unsorted = false;
+        bool m_AnyDirty = false;
+        // Shallowest level with a changed local transform, the ones above are skipped
+        uint32_t m_DirtyLevel = UINT32_MAX;
+
+        // Indices changed by each batch of a level, merged in order once the level is done
+        std::vector<std::vector<uint32_t>> m_BatchChanges;
+        std::vector<uint32_t> m_ChangedIndices;
+        std::vector<uint32_t> m_ChangedNodes;
+    };
+} // namespace spock
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/buffers.hxx"
+#include "spock/descriptor_allocator.hh"
+#include "spock/descriptor_set_layout.hxx"
+#include "spock/texture.hh"
+#include "spock/uniform_buffer.hxx"
+#include "spock/vulkan.hh"
+
+namespace spock
+{
+    // A single descriptor binding, the subclasses name the resource they accept (`Resource`) and how it is written
+    template <uint32_t Binding, VkDescriptorType Type, VkShaderStageFlags Stages>
+    struct DescriptorBinding
+    {
+        static constexpr VkDescriptorSetLayoutBinding LAYOUT_BINDING{Binding, Type, 1, Stages, nullptr};
+    };
+
+    template <uint32_t Binding, typename T, VkShaderStageFlags Stages>
+    struct UniformBufferBinding : DescriptorBinding<Binding, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, Stages>
+    {
+        using Resource = UniformBuffer<T>;
+
+        static DescriptorInfo GetInfo(const Resource &uniform_buffer, int frame_index) {
+            DescriptorInfo info{};
+            info.Buffer.buffer = uniform_buffer.GetBuffer(frame_index);
+            info.Buffer.offset = 0;
+            info.Buffer.range = sizeof(T);
+            return info;
+        }
+    };
+
+    template <uint32_t Binding, VkShaderStageFlags Stages>
+    struct StorageBufferBinding : DescriptorBinding<Binding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, Stages>
+    {
+        using Resource = Buffer;
+
+        static DescriptorInfo GetInfo(const Resource &buffer, int) {
+            DescriptorInfo info{};
+            info.Buffer.buffer = buffer.GetBuffer();
+            info.Buffer.offset = 0;
+            info.Buffer.range = buffer.GetSize();
+            return info;
+        }
+    };
+
+    template <uint32_t Binding, VkShaderStageFlags Stages>
+    struct ImageSamplerBinding : DescriptorBinding<Binding, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, Stages>
+    {
+        using Resource = Texture2D;
+
+        static DescriptorInfo GetInfo(const Resource &texture, int) {
+            DescriptorInfo info{};
+            info.Image.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            info.Image.imageView = texture.GetImageView();
+            info.Image.sampler = texture.GetSampler();
+            return info;
+        }
+    };
+
+    // Images not owned by a `Texture2D`, e.g. attachments or compute outputs
+    struct ImageViewSampler
+    {
+        VkImageView ImageView = VK_NULL_HANDLE;
+        VkSampler Sampler = VK_NULL_HANDLE;
+    };
+
+    // The image must be in `Layout` when accessed
+    template <uint32_t Binding, VkShaderStageFlags Stages,
+              VkImageLayout Layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL>
+    struct ImageViewSamplerBinding : DescriptorBinding<Binding, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, Stages>
+    {
+        using Resource = ImageViewSampler;
+
+        static DescriptorInfo GetInfo(const Resource &image, int) {
+            DescriptorInfo info{};
+            info.Image.imageLayout = Layout;
+            info.Image.imageView = image.ImageView;
+            info.Image.sampler = image.Sampler;
+            return info;
+        }
+    };
+
+    // The image must be in VK_IMAGE_LAYOUT_GENERAL when accessed
+    template <uint32_t Binding, VkShaderStageFlags Stages>
+    struct StorageImageBinding : DescriptorBinding<Binding, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, Stages>
+    {
+        using Resource = VkImageView;
+
+        static DescriptorInfo GetInfo(const Resource &image_view, int) {
+            DescriptorInfo info{};
+            info.Image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+            info.Image.imageView = image_view;
+            info.Image.sampler = VK_NULL_HANDLE;
+            return info;
+        }
+    };
+
+    template <std::size_t Nm>
+    constexpr bool HasUniqueBindings(const std::array<VkDescriptorSetLayoutBinding, Nm> &bindings) {
+        for (std::size_t i = 0; i < Nm; i++) {
+            for (std::size_t j = i + 1; j < Nm; j++) {
+                if (bindings[i].binding == bindings[j].binding)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    // A set layout declared by its bindings, e.g.
+    // `TypedDescriptorSetLayout<UniformBufferBinding<0, Camera, VK_SHADER_STAGE_VERTEX_BIT>,
+    //                           ImageSamplerBinding<1, VK_SHADER_STAGE_FRAGMENT_BIT>>`.
+    // The layout bindings are built at compile time and sets are created from resources of the declared types, in
+    // declaration order, so they can not go out of sync with the layout.
+    template <typename... Bindings>
+    class TypedDescriptorSetLayout {
+      public:
+        static constexpr std::size_t BINDING_COUNT = sizeof...(Bindings);
+        static constexpr std::array<VkDescriptorSetLayoutBinding, BINDING_COUNT> BINDINGS{Bindings::LAYOUT_BINDING...};
+        // Same as `DescriptorSetLayout::GetKey` of the created layouts
+        static constexpr uint64_t KEY = GetBindingsKey(BINDINGS);
+
+        static_assert(BINDING_COUNT > 0, "a descriptor set layout needs at least one binding");
+        static_assert(HasUniqueBindings(BINDINGS), "descriptor bindings must be unique");
+
+        using Descriptors = std::array<DescriptorInfo, BINDING_COUNT>;
+
+        TypedDescriptorSetLayout(std::unique_ptr<DescriptorSetLayout> &&descriptor_set_layout)
+            : m_DescriptorSetLayout(std::move(descriptor_set_layout)) {
+        }
+        TypedDescriptorSetLayout(const TypedDescriptorSetLayout &) = delete;
+        TypedDescriptorSetLayout operator=(const TypedDescriptorSetLayout &) = delete;
+
+        const std::unique_ptr<DescriptorSetLayout> &GetLayout() const {
+            return m_DescriptorSetLayout;
+        }
+
+        VkDescriptorSetLayout GetDescriptorSetLayout() const {
+            return m_DescriptorSetLayout->GetDescriptorSetLayout();
+        }
+
+        // Every binding holds a single descriptor, the packed order is the declaration order
+        static Descriptors Pack(int frame_index, const typename Bindings::Resource &...resources) {
+            return {Bindings::GetInfo(resources, frame_index)...};
+        }
+
+        // One set per frame in flight, shared with identical sets (see `DescriptorAllocator::GetCached`)
+        std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT>
+        CreateDescriptorSets(const typename Bindings::Resource &...resources) const;
+
+        // A set only valid for the frame being recorded
+        VkDescriptorSet CreateFrameDescriptorSet(const typename Bindings::Resource &...resources) const;
+
+        // See `PushDescriptorSet`
+        void Push(VkCommandBuffer command_buffer, VkPipelineLayout pipeline_layout, uint32_t set,
+                  const typename Bindings::Resource &...resources) const;
+
+      public:
+        static std::unique_ptr<TypedDescriptorSetLayout> CreateDescriptorSetLayout();
+        static std::unique_ptr<TypedDescriptorSetLayout> CreatePushDescriptorSetLayout();
+        static std::unique_ptr<TypedDescriptorSetLayout> CreateDescriptorBufferLayout();
+
+      private:
+        std::unique_ptr<DescriptorSetLayout> m_DescriptorSetLayout;
+    };
+
+    template <typename... Bindings>
+    std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT>
+    TypedDescriptorSetLayout<Bindings...>::CreateDescriptorSets(const typename Bindings::Resource &...resources) const {
+        std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> descriptor_sets{};
+
+        for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            auto descriptor_infos = Pack(i, resources...);
+            descriptor_sets[i] = DescriptorAllocator::GetCached(*m_DescriptorSetLayout, descriptor_infos);
+        }
+
+        return descriptor_sets;
+    }
+
+    template <typename... Bindings>
+    VkDescriptorSet TypedDescriptorSetLayout<Bindings...>::CreateFrameDescriptorSet(
+        const typename Bindings::Resource &...resources) const {
+        auto descriptor_set = DescriptorAllocator::GetFrame().Allocate(m_DescriptorSetLayout->GetDescriptorSetLayout());
+
+        auto descriptor_infos = Pack(s_VulkanContext.CurrentFrame, resources...);
+        m_DescriptorSetLayout->Update(descriptor_set, descriptor_infos);
+
+        return descriptor_set;
+    }
+
+    template <typename... Bindings>
+    void TypedDescriptorSetLayout<Bindings...>::Push(VkCommandBuffer command_buffer, VkPipelineLayout pipeline_layout,
+                                                     uint32_t set,
+                                                     const typename Bindings::Resource &...resources) const {
+        if (!m_DescriptorSetLayout->IsPushDescriptor()) {
+            auto descriptor_set = CreateFrameDescriptorSet(resources...);
+            vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, set, 1,
+                                    &descriptor_set, 0, nullptr);
+            return;
+        }
+
+        auto descriptor_infos = Pack(s_VulkanContext.CurrentFrame, resources...);
+
+        std::array<VkWriteDescriptorSet, BINDING_COUNT> descriptor_writes{};
+        for (std::size_t i = 0; i < BINDING_COUNT; i++) {
+            descriptor_writes[i] = GetWriteDescriptorSet(VK_NULL_HANDLE, BINDINGS[i].binding,
+                                                         BINDINGS[i].descriptorType, descriptor_infos[i]);
+        }
+
+        s_VulkanContext.Extensions.CmdPushDescriptorSetKHR(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                                           pipeline_layout, set,
+                                                           static_cast<uint32_t>(descriptor_writes.size()),
+                                                           descriptor_writes.data());
+    }
+
+    template <typename... Bindings>
+    std::unique_ptr<TypedDescriptorSetLayout<Bindings...>>
+    TypedDescriptorSetLayout<Bindings...>::CreateDescriptorSetLayout() {
+        return std::make_unique<TypedDescriptorSetLayout>(
+            DescriptorSetLayout::CreateDescriptorSetLayout(BINDINGS, 0, KEY));
+    }
+
+    template <typename... Bindings>
+    std::unique_ptr<TypedDescriptorSetLayout<Bindings...>>
+    TypedDescriptorSetLayout<Bindings...>::CreatePushDescriptorSetLayout() {
+        return std::make_unique<TypedDescriptorSetLayout>(
+            DescriptorSetLayout::CreatePushDescriptorSetLayout(BINDINGS, KEY));
+    }
+
+    template <typename... Bindings>
+    std::unique_ptr<TypedDescriptorSetLayout<Bindings...>>
+    TypedDescriptorSetLayout<Bindings...>::CreateDescriptorBufferLayout() {
+        return std::make_unique<TypedDescriptorSetLayout>(
+            DescriptorSetLayout::CreateDescriptorBufferLayout(BINDINGS, KEY));
+    }
+} // namespace spock
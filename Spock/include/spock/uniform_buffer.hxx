@@ -74,6 +74,7 @@ namespace spock
     template <typename T>
     UniformBuffer<T>::~UniformBuffer() {
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            DescriptorAllocator::Invalidate(m_UniformBuffers[i]);
             vkDestroyBuffer(s_VulkanContext.Device, m_UniformBuffers[i], nullptr);
             vkFreeMemory(s_VulkanContext.Device, m_UniformBuffersMemory[i], nullptr);
         }
@@ -1,12 +1,21 @@
 #pragma once
 
 #include <array>
+#include <chrono>
 #include <cstdint>
+#include <filesystem>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <vulkan/vulkan_core.h>
 
+#include "spock/descriptor_allocator.hh"
+#include "spock/frame_globals.hh"
+#include "spock/sampler.hh"
 #include "spock/spock.hh"
 #include "spock/window.hh"
 
@@ -35,6 +44,123 @@ namespace spock
 
     SwapChainSupportDetails QuerySwapChainSupport(VkPhysicalDevice device, VkSurfaceKHR surface);
 
+    class ShaderModule;
+
+    // SPIR-V file as it was when loaded, it is read again once modified
+    struct ShaderModuleFile
+    {
+        uint64_t Hash = 0;
+        std::filesystem::file_time_type WriteTime;
+        uintmax_t Size = 0;
+    };
+
+    // Shader modules registered by SPIR-V hash, see `ShaderModule`
+    struct ShaderModuleCache
+    {
+        std::mutex Mutex;
+        std::unordered_map<uint64_t, std::shared_ptr<ShaderModule>> Modules;
+        std::unordered_map<std::string, ShaderModuleFile> Files;
+        // Every module alive, registered or not, released on `Spock::Cleanup` even if a stage still holds it
+        std::unordered_set<ShaderModule *> Alive;
+        uint32_t Created = 0;
+        uint32_t Reused = 0;
+    };
+
+    // Global descriptor set holding every registered texture, see `BindlessTextures`
+    struct BindlessTextureTable
+    {
+        VkDescriptorSetLayout Layout = VK_NULL_HANDLE;
+        VkDescriptorPool Pool = VK_NULL_HANDLE;
+        VkDescriptorSet Set = VK_NULL_HANDLE;
+        uint32_t Capacity = 0;
+        uint32_t Count = 0;
+        std::vector<uint32_t> FreeIndices;
+        // Released indices are only reused once the frames that may still sample them are done
+        std::array<std::vector<uint32_t>, MAX_FRAMES_IN_FLIGHT> PendingIndices;
+    };
+
+    // Bindings and flags of a shared VkDescriptorSetLayout, see `DescriptorSetLayout::CreateDescriptorSetLayout`
+    struct DescriptorSetLayoutDescription
+    {
+        VkDescriptorSetLayoutCreateFlags Flags = 0;
+        std::vector<VkDescriptorSetLayoutBinding> Bindings;
+        // `GetBindingsKey(Bindings)`, computed at compile time for typed layouts
+        uint64_t BindingsKey = 0;
+        // Immutable samplers of every binding having them, one after the other
+        std::vector<VkSampler> ImmutableSamplers;
+
+        bool operator==(const DescriptorSetLayoutDescription &other) const;
+        size_t GetHash() const;
+    };
+
+    struct DescriptorSetLayoutDescriptionHash
+    {
+        size_t operator()(const DescriptorSetLayoutDescription &description) const {
+            return description.GetHash();
+        }
+    };
+
+    // Per frame uniform bound at set 0, see `FrameGlobals`
+    struct FrameGlobalsTable
+    {
+        VkDescriptorSetLayout Layout = VK_NULL_HANDLE;
+        std::array<VkBuffer, MAX_FRAMES_IN_FLIGHT> Buffers{};
+        std::array<VkDeviceMemory, MAX_FRAMES_IN_FLIGHT> BuffersMemory{};
+        std::array<void *, MAX_FRAMES_IN_FLIGHT> BuffersMapped{};
+        std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> Sets{};
+        FrameGlobalsData Data;
+        std::chrono::steady_clock::time_point StartTime;
+        std::chrono::steady_clock::time_point LastFrameTime;
+    };
+
+    // Optional device extensions, enabled at device creation when the physical device supports them
+    struct DeviceExtensions
+    {
+        // VK_EXT_shader_object
+        bool ShaderObject = false;
+        PFN_vkCreateShadersEXT CreateShadersEXT = nullptr;
+        PFN_vkDestroyShaderEXT DestroyShaderEXT = nullptr;
+        PFN_vkCmdBindShadersEXT CmdBindShadersEXT = nullptr;
+        PFN_vkCmdSetVertexInputEXT CmdSetVertexInputEXT = nullptr;
+        PFN_vkCmdSetPolygonModeEXT CmdSetPolygonModeEXT = nullptr;
+        PFN_vkCmdSetRasterizationSamplesEXT CmdSetRasterizationSamplesEXT = nullptr;
+        PFN_vkCmdSetSampleMaskEXT CmdSetSampleMaskEXT = nullptr;
+        PFN_vkCmdSetAlphaToCoverageEnableEXT CmdSetAlphaToCoverageEnableEXT = nullptr;
+        PFN_vkCmdSetColorBlendEnableEXT CmdSetColorBlendEnableEXT = nullptr;
+        PFN_vkCmdSetColorBlendEquationEXT CmdSetColorBlendEquationEXT = nullptr;
+        PFN_vkCmdSetColorWriteMaskEXT CmdSetColorWriteMaskEXT = nullptr;
+
+        // VK_KHR_push_descriptor
+        bool PushDescriptor = false;
+        PFN_vkCmdPushDescriptorSetKHR CmdPushDescriptorSetKHR = nullptr;
+
+        // Descriptor indexing (core in Vulkan 1.2, the features we need are optional)
+        bool DescriptorIndexing = false;
+
+        // bufferDeviceAddress (core in Vulkan 1.2, optional feature)
+        bool BufferDeviceAddress = false;
+
+        // multiDrawIndirect and drawIndirectFirstInstance, required by `IndirectScene`
+        bool MultiDrawIndirect = false;
+
+        // drawIndirectCount (core in Vulkan 1.2, optional feature)
+        bool DrawIndirectCount = false;
+
+        // VK_EXT_multi_draw
+        bool MultiDraw = false;
+        uint32_t MaxMultiDrawCount = 0;
+        PFN_vkCmdDrawMultiIndexedEXT CmdDrawMultiIndexedEXT = nullptr;
+
+        // VK_EXT_descriptor_buffer
+        bool DescriptorBuffer = false;
+        VkPhysicalDeviceDescriptorBufferPropertiesEXT DescriptorBufferProperties{};
+        PFN_vkGetDescriptorSetLayoutSizeEXT GetDescriptorSetLayoutSizeEXT = nullptr;
+        PFN_vkGetDescriptorSetLayoutBindingOffsetEXT GetDescriptorSetLayoutBindingOffsetEXT = nullptr;
+        PFN_vkGetDescriptorEXT GetDescriptorEXT = nullptr;
+        PFN_vkCmdBindDescriptorBuffersEXT CmdBindDescriptorBuffersEXT = nullptr;
+        PFN_vkCmdSetDescriptorBufferOffsetsEXT CmdSetDescriptorBufferOffsetsEXT = nullptr;
+    };
+
     struct VulkanContext
     {
         std::unique_ptr<Window> Win;
@@ -51,6 +177,7 @@ namespace spock
         VkQueue GraphicsQueue;
         VkQueue PresentQueue;
         VkCommandPool CommandPool;
+        DeviceExtensions Extensions;
 
         // Swapchain stuff
         VkSwapchainKHR SwapChain;
@@ -58,22 +185,42 @@ namespace spock
         VkFormat SwapChainImageFormat;
         std::vector<VkImage> SwapChainImages;
         std::vector<VkImageView> SwapChainImageViews;
-        VkRenderPass RenderPass;
+        VkFormat DepthFormat;
         VkImage DepthImage;
         VkDeviceMemory DepthImageMemory;
         VkImageView DepthImageView;
+        // Single sampled depth kept after rendering for `HiZPyramid`, the depth image itself without multisampling
+        VkImage ResolvedDepthImage;
+        VkDeviceMemory ResolvedDepthImageMemory;
+        VkImageView ResolvedDepthImageView;
+        VkResolveModeFlagBits DepthResolveMode = VK_RESOLVE_MODE_NONE;
+        // Incremented whenever the swapchain and its attachments are recreated
+        uint32_t SwapChainGeneration = 0;
         VkImage ColorImage;
         VkDeviceMemory ColorImageMemory;
         VkImageView ColorImageView;
-        std::vector<VkFramebuffer> SwapChainFramebuffers;
         std::vector<VkSemaphore> ImageAvailableSemaphores;
         std::vector<VkSemaphore> RenderFinishedSemaphores;
         std::vector<VkFence> InFlightFences;
         uint32_t CurrentFrame = 0;
+        // Frames submitted so far, `CurrentFrame` keeps cycling
+        uint64_t FrameNumber = 0;
         uint32_t CurrentImageIndex = 0;
 
         // Rendering stuff
-        VkDescriptorPool DescriptorPool;
+        ShaderModuleCache ShaderModules;
+        VkDescriptorPool DescriptorPool; // ImGui
+        // Cached sets are freed when their resources are destroyed
+        DescriptorAllocator Descriptors{64, VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT};
+        std::array<DescriptorAllocator, MAX_FRAMES_IN_FLIGHT> FrameDescriptors;
+        std::unordered_map<CachedDescriptorSetKey, CachedDescriptorSet, CachedDescriptorSetKeyHash>
+            CachedDescriptorSets;
+        std::vector<PendingDescriptorSet> PendingDescriptorSets;
+        std::unordered_map<DescriptorSetLayoutDescription, VkDescriptorSetLayout, DescriptorSetLayoutDescriptionHash>
+            DescriptorSetLayouts;
+        std::unordered_map<SamplerDescription, VkSampler, SamplerDescriptionHash> Samplers;
+        BindlessTextureTable BindlessTextures;
+        FrameGlobalsTable FrameGlobals;
         std::array<VkCommandBuffer, MAX_FRAMES_IN_FLIGHT> CommandBuffers;
     };
 
@@ -0,0 +1,20 @@
+#version 460 core
+#extension GL_GOOGLE_include_directive : require
+
+// Frustum culls `spock::IndirectScene` objects into indexed indirect draws, one invocation per object
+#include "cull_common.glsli"
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= cull.objectCount)
+        return;
+
+    Object object = objects[index];
+
+    vec3 center;
+    float radius;
+    GetBoundingSphere(object, center, radius);
+
+    if (IsInFrustum(center, radius))
+        EmitDraw(object, index);
+}
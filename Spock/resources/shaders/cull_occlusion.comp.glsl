@@ -0,0 +1,64 @@
+#version 460 core
+#extension GL_GOOGLE_include_directive : require
+
+// Same as cull.comp, objects hidden behind the depth of the previous frame are also dropped
+#include "cull_common.glsli"
+
+// See `spock::HiZPyramid`
+layout(set = 1, binding = 0) uniform sampler2D hiz;
+
+layout(set = 1, binding = 1) uniform HiZ {
+    mat4 viewProj; // Camera the depth was rendered with
+    vec2 size;
+    uint levelCount;
+    uint valid;
+} pyramid;
+
+bool IsOccluded(vec3 center, float radius) {
+    if (pyramid.valid == 0)
+        return false;
+
+    // Screen bounds of the box around the sphere, as seen by the previous frame
+    vec3 ndcMin = vec3(1.0);
+    vec3 ndcMax = vec3(-1.0);
+    for (int i = 0; i < 8; i++) {
+        vec3 corner = center + radius * vec3((i & 1) != 0 ? 1 : -1, (i & 2) != 0 ? 1 : -1, (i & 4) != 0 ? 1 : -1);
+        vec4 clip = pyramid.viewProj * vec4(corner, 1.0);
+
+        // Crosses the camera plane, nothing to test against
+        if (clip.w <= 0.0)
+            return false;
+
+        vec3 ndc = clip.xyz / clip.w;
+        ndcMin = i == 0 ? ndc : min(ndcMin, ndc);
+        ndcMax = i == 0 ? ndc : max(ndcMax, ndc);
+    }
+
+    vec2 uvMin = clamp(ndcMin.xy * 0.5 + 0.5, 0.0, 1.0);
+    vec2 uvMax = clamp(ndcMax.xy * 0.5 + 0.5, 0.0, 1.0);
+
+    // The level where the bounds span at most one texel, its four corners then cover them
+    vec2 extent = (uvMax - uvMin) * pyramid.size;
+    float level = min(ceil(log2(max(max(extent.x, extent.y), 1.0))), float(pyramid.levelCount - 1));
+
+    float farthest = max(max(textureLod(hiz, uvMin, level).r, textureLod(hiz, vec2(uvMax.x, uvMin.y), level).r),
+                         max(textureLod(hiz, vec2(uvMin.x, uvMax.y), level).r, textureLod(hiz, uvMax, level).r));
+
+    // Hidden when its nearest point is behind everything drawn there
+    return ndcMin.z > farthest;
+}
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= cull.objectCount)
+        return;
+
+    Object object = objects[index];
+
+    vec3 center;
+    float radius;
+    GetBoundingSphere(object, center, radius);
+
+    if (IsInFrustum(center, radius) && !IsOccluded(center, radius))
+        EmitDraw(object, index);
+}
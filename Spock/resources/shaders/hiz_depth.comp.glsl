@@ -0,0 +1,29 @@
+#version 460 core
+
+// First level of `spock::HiZPyramid`: the farthest depth under each texel. The level is the largest power of two
+// fitting in the depth, so a texel covers up to 3x3 depth texels.
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(set = 0, binding = 0) uniform sampler2D depth;
+layout(set = 0, binding = 1, r32f) uniform writeonly image2D level;
+
+void main() {
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 levelSize = imageSize(level);
+    if (any(greaterThanEqual(texel, levelSize)))
+        return;
+
+    ivec2 depthSize = textureSize(depth, 0);
+    vec2 ratio = vec2(depthSize) / vec2(levelSize);
+    ivec2 first = ivec2(floor(vec2(texel) * ratio));
+    ivec2 last = min(ivec2(ceil(vec2(texel + 1) * ratio)) - 1, depthSize - 1);
+
+    float farthest = 0.0;
+    for (int y = first.y; y <= last.y; y++) {
+        for (int x = first.x; x <= last.x; x++) {
+            farthest = max(farthest, texelFetch(depth, ivec2(x, y), 0).r);
+        }
+    }
+
+    imageStore(level, texel, vec4(farthest));
+}
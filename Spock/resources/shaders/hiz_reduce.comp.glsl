@@ -0,0 +1,24 @@
+#version 460 core
+
+// Next level of `spock::HiZPyramid`: the farthest of the 2x2 texels below, levels are powers of two
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(set = 0, binding = 0, r32f) uniform readonly image2D source;
+layout(set = 0, binding = 1, r32f) uniform writeonly image2D level;
+
+void main() {
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(texel, imageSize(level))))
+        return;
+
+    // Once a side is down to one texel, it is read twice
+    ivec2 sourceLast = imageSize(source) - 1;
+    ivec2 base = texel * 2;
+
+    float farthest = max(max(imageLoad(source, min(base, sourceLast)).r,
+                             imageLoad(source, min(base + ivec2(1, 0), sourceLast)).r),
+                         max(imageLoad(source, min(base + ivec2(0, 1), sourceLast)).r,
+                             imageLoad(source, min(base + ivec2(1, 1), sourceLast)).r));
+
+    imageStore(level, texel, vec4(farthest));
+}
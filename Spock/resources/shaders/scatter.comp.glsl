@@ -0,0 +1,33 @@
+#version 460 core
+
+// Copies the changed objects of a `spock::ObjectBuffer` to their place, one word per invocation
+layout(local_size_x = 64) in;
+
+layout(std430, set = 0, binding = 0) writeonly buffer Objects {
+    uint objects[];
+};
+
+// Object index of every entry
+layout(std430, set = 0, binding = 1) readonly buffer DeltaIndices {
+    uint indices[];
+};
+
+// Entries packed one after the other
+layout(std430, set = 0, binding = 2) readonly buffer DeltaData {
+    uint data[];
+};
+
+layout(push_constant) uniform Scatter {
+    uint wordCount; // Of all the entries
+    uint objectWords;
+} scatter;
+
+void main() {
+    uint word = gl_GlobalInvocationID.x;
+    if (word >= scatter.wordCount)
+        return;
+
+    uint entry = word / scatter.objectWords;
+    uint offset = word - entry * scatter.objectWords;
+    objects[indices[entry] * scatter.objectWords + offset] = data[word];
+}
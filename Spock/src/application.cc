@@ -39,11 +39,20 @@ namespace spock
             for (std::shared_ptr<Layer> &layer : m_Layers)
                 layer->OnUpdate(delta_time);
 
-            // Render frames
+            // Compute work the frame depends on, recorded before rendering begins
             for (auto &layer : m_Layers) {
-                layer->OnRender(command_buffer);
+                layer->OnCompute(command_buffer);
             }
 
+            Spock::BeginRendering(command_buffer);
+
+            // Render frames, the recorder starts without any known state
+            m_CommandRecorder.Reset(command_buffer);
+            for (auto &layer : m_Layers) {
+                layer->OnRender(m_CommandRecorder);
+            }
+            m_RenderQueue.Flush(m_CommandRecorder);
+
             // Render UI
             ImGui_ImplVulkan_NewFrame();
             ImGui_ImplGlfw_NewFrame();
@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/bindless.hh"
+#include "spock/spock.hh"
+#include "spock/vulkan.hh"
+
+namespace spock
+{
+    // Upper bound of the table, the device limits are usually far higher
+    static constexpr uint32_t MAX_BINDLESS_TEXTURES = 16384;
+
+    static uint32_t GetMaxBindlessTextures() {
+        VkPhysicalDeviceVulkan12Properties vulkan12Properties{};
+        vulkan12Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+
+        VkPhysicalDeviceProperties2 properties{};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties.pNext = &vulkan12Properties;
+        vkGetPhysicalDeviceProperties2(s_VulkanContext.PhysicalDevice, &properties);
+
+        return std::min({MAX_BINDLESS_TEXTURES, vulkan12Properties.maxDescriptorSetUpdateAfterBindSampledImages,
+                         vulkan12Properties.maxDescriptorSetUpdateAfterBindSamplers,
+                         vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                         vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSamplers});
+    }
+
+    void Spock::CreateBindlessTextures() {
+        if (!s_VulkanContext.Extensions.DescriptorIndexing)
+            return;
+
+        auto &table = s_VulkanContext.BindlessTextures;
+        table.Capacity = GetMaxBindlessTextures();
+
+        // Layout, a single variable sized array of combined image samplers
+        VkDescriptorSetLayoutBinding binding{};
+        binding.binding = 0;
+        binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        binding.descriptorCount = table.Capacity;
+        binding.stageFlags = VK_SHADER_STAGE_ALL;
+
+        VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT
+                                              | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+                                              | VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT;
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+        bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+        bindingFlagsInfo.bindingCount = 1;
+        bindingFlagsInfo.pBindingFlags = &bindingFlags;
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.pNext = &bindingFlagsInfo;
+        layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+        layoutInfo.bindingCount = 1;
+        layoutInfo.pBindings = &binding;
+
+        if (vkCreateDescriptorSetLayout(s_VulkanContext.Device, &layoutInfo, nullptr, &table.Layout) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create bindless descriptor set layout!");
+        }
+
+        // Pool
+        VkDescriptorPoolSize poolSize{};
+        poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSize.descriptorCount = table.Capacity;
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+        poolInfo.maxSets = 1;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+
+        if (vkCreateDescriptorPool(s_VulkanContext.Device, &poolInfo, nullptr, &table.Pool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create bindless descriptor pool!");
+        }
+
+        // Set
+        VkDescriptorSetVariableDescriptorCountAllocateInfo countInfo{};
+        countInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO;
+        countInfo.descriptorSetCount = 1;
+        countInfo.pDescriptorCounts = &table.Capacity;
+
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.pNext = &countInfo;
+        allocInfo.descriptorPool = table.Pool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &table.Layout;
+
+        if (vkAllocateDescriptorSets(s_VulkanContext.Device, &allocInfo, &table.Set) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate bindless descriptor set!");
+        }
+    }
+
+    void Spock::CleanupBindlessTextures() {
+        auto &table = s_VulkanContext.BindlessTextures;
+
+        // Frees the set as well
+        vkDestroyDescriptorPool(s_VulkanContext.Device, table.Pool, nullptr);
+        vkDestroyDescriptorSetLayout(s_VulkanContext.Device, table.Layout, nullptr);
+
+        table = BindlessTextureTable{};
+    }
+
+    bool BindlessTextures::IsAvailable() {
+        return s_VulkanContext.BindlessTextures.Set != VK_NULL_HANDLE;
+    }
+
+    uint32_t BindlessTextures::Register(VkImageView image_view, VkSampler sampler) {
+        auto &table = s_VulkanContext.BindlessTextures;
+
+        uint32_t index;
+        if (!table.FreeIndices.empty()) {
+            index = table.FreeIndices.back();
+            table.FreeIndices.pop_back();
+        } else if (table.Count < table.Capacity) {
+            index = table.Count++;
+        } else {
+            throw std::runtime_error("bindless texture table is full!");
+        }
+
+        VkDescriptorImageInfo imageInfo{};
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfo.imageView = image_view;
+        imageInfo.sampler = sampler;
+
+        VkWriteDescriptorSet descriptorWrite{};
+        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrite.dstSet = table.Set;
+        descriptorWrite.dstBinding = 0;
+        descriptorWrite.dstArrayElement = index;
+        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrite.descriptorCount = 1;
+        descriptorWrite.pImageInfo = &imageInfo;
+
+        // Update after bind, fine while the set is in use by frames in flight
+        vkUpdateDescriptorSets(s_VulkanContext.Device, 1, &descriptorWrite, 0, nullptr);
+
+        return index;
+    }
+
+    void BindlessTextures::Unregister(uint32_t index) {
+        if (index == INVALID_INDEX)
+            return;
+
+        // Partially bound, the stale descriptor is never accessed once no draw uses the index
+        s_VulkanContext.BindlessTextures.PendingIndices[s_VulkanContext.CurrentFrame].emplace_back(index);
+    }
+
+    void BindlessTextures::Bind(VkCommandBuffer command_buffer, VkPipelineLayout pipeline_layout, uint32_t set) {
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, set, 1,
+                                &s_VulkanContext.BindlessTextures.Set, 0, nullptr);
+    }
+
+    VkDescriptorSet BindlessTextures::GetDescriptorSet() {
+        return s_VulkanContext.BindlessTextures.Set;
+    }
+
+    VkDescriptorSetLayout BindlessTextures::GetDescriptorSetLayout() {
+        return s_VulkanContext.BindlessTextures.Layout;
+    }
+
+    uint32_t BindlessTextures::GetCapacity() {
+        return s_VulkanContext.BindlessTextures.Capacity;
+    }
+} // namespace spock
@@ -1,6 +1,10 @@
+#include <cstring>
+#include <memory>
 #include <vulkan/vulkan_core.h>
 
 #include "spock/buffers.hxx"
+#include "spock/descriptor_allocator.hh"
+#include "spock/spock.hh"
 #include "spock/vulkan.hh"
 
 namespace spock
@@ -11,7 +15,51 @@ namespace spock
         , m_BufferSize(size) {
     }
 
+    void *Buffer::Map() {
+        if (m_Mapped == nullptr)
+            vkMapMemory(s_VulkanContext.Device, m_BufferMemory, 0, m_BufferSize, 0, &m_Mapped);
+
+        return m_Mapped;
+    }
+
+    std::unique_ptr<Buffer> Buffer::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                                                 VkMemoryPropertyFlags properties) {
+        VkBuffer buffer;
+        VkDeviceMemory buffer_memory;
+        Spock::CreateBuffer(size, usage, properties, buffer, buffer_memory);
+
+        return std::make_unique<Buffer>(buffer, buffer_memory, size);
+    }
+
+    std::unique_ptr<Buffer> Buffer::CreateDeviceBuffer(const void *data, VkDeviceSize size, VkBufferUsageFlags usage) {
+        VkBuffer stagingBuffer;
+        VkDeviceMemory stagingBufferMemory;
+        Spock::CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer,
+                            stagingBufferMemory);
+
+        void *mapped;
+        vkMapMemory(s_VulkanContext.Device, stagingBufferMemory, 0, size, 0, &mapped);
+        memcpy(mapped, data, size);
+        vkUnmapMemory(s_VulkanContext.Device, stagingBufferMemory);
+
+        auto buffer = CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        Spock::CopyBuffer(stagingBuffer, buffer->GetBuffer(), size);
+
+        vkDestroyBuffer(s_VulkanContext.Device, stagingBuffer, nullptr);
+        vkFreeMemory(s_VulkanContext.Device, stagingBufferMemory, nullptr);
+
+        return buffer;
+    }
+
+    std::unique_ptr<Buffer> Buffer::CreateIndexBuffer(const std::vector<uint32_t> &indices) {
+        return CreateDeviceBuffer(indices.data(), sizeof(uint32_t) * indices.size(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+    }
+
     Buffer::~Buffer() {
+        // Freeing the memory unmaps it
+        DescriptorAllocator::Invalidate(m_Buffer);
         vkDestroyBuffer(s_VulkanContext.Device, m_Buffer, nullptr);
         vkFreeMemory(s_VulkanContext.Device, m_BufferMemory, nullptr);
     }
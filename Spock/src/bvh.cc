@@ -0,0 +1,379 @@
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "spock/bvh.hh"
+
+namespace spock
+{
+    // Centroid bins per axis tried by the surface area heuristic
+    static constexpr uint32_t SAH_BIN_COUNT = 16;
+    // Deeper nodes are left as leaves, bounds the traversal stacks
+    static constexpr uint32_t MAX_DEPTH = 62;
+    static constexpr uint32_t MAX_TRAVERSAL_DEPTH = MAX_DEPTH + 2;
+
+    // Entry distance of the ray in the box, infinity when missed or not nearer than `nearest`
+    static float IntersectBox(const Ray &ray, const glm::vec3 &inverse_direction, const glm::vec3 &min,
+                              const glm::vec3 &max, float nearest) {
+        auto t0 = (min - ray.Origin) * inverse_direction;
+        auto t1 = (max - ray.Origin) * inverse_direction;
+        auto t_min = glm::min(t0, t1);
+        auto t_max = glm::max(t0, t1);
+
+        float enter = std::max(std::max(t_min.x, t_min.y), std::max(t_min.z, 0.0f));
+        float exit = std::min(std::min(t_max.x, t_max.y), t_max.z);
+
+        // Written so that NaNs, from a ray starting on a slab of an axis it is parallel to, miss
+        if (!(enter <= exit) || !(enter < nearest))
+            return std::numeric_limits<float>::infinity();
+
+        return enter;
+    }
+
+    Ray Ray::FromScreen(const glm::mat4 &view_projection, const glm::vec2 &position) {
+        auto inverse = glm::inverse(view_projection);
+        auto ndc = position * 2.0f - 1.0f;
+
+        // From the near plane to the far one, glm projections put the near plane at -1 unless told otherwise
+#ifdef GLM_FORCE_DEPTH_ZERO_TO_ONE
+        constexpr float NEAR_DEPTH = 0.0f;
+#else
+        constexpr float NEAR_DEPTH = -1.0f;
+#endif
+        auto near_point = inverse * glm::vec4(ndc, NEAR_DEPTH, 1.0f);
+        auto far_point = inverse * glm::vec4(ndc, 1.0f, 1.0f);
+
+        Ray ray;
+        ray.Origin = glm::vec3(near_point) / near_point.w;
+        ray.Direction = glm::normalize(glm::vec3(far_point) / far_point.w - ray.Origin);
+        return ray;
+    }
+
+    void Bvh::Build(std::span<const BoundingBox> bounds) {
+        auto object_count = static_cast<uint32_t>(bounds.size());
+
+        m_Bounds.assign(bounds.begin(), bounds.end());
+        m_Objects.resize(object_count);
+        std::iota(m_Objects.begin(), m_Objects.end(), 0);
+        m_Centers.resize(object_count);
+        for (uint32_t i = 0; i < object_count; i++) {
+            m_Centers[i] = m_Bounds[i].GetCenter();
+        }
+
+        m_Nodes.clear();
+        if (object_count == 0)
+            return;
+
+        // A binary tree of N leaves has 2N - 1 nodes, plus the unused one
+        m_Nodes.reserve(2 * object_count);
+        m_Nodes.resize(2);
+        m_Nodes[0].First = 0;
+        m_Nodes[0].Count = object_count;
+        UpdateNodeBounds(m_Nodes[0]);
+
+        // Nodes to subdivide and their depth
+        std::vector<std::pair<uint32_t, uint32_t>> pending = {{0, 0}};
+        while (!pending.empty()) {
+            auto [node_index, depth] = pending.back();
+            pending.pop_back();
+
+            if (depth < MAX_DEPTH)
+                Subdivide(node_index);
+            if (!m_Nodes[node_index].IsLeaf()) {
+                pending.emplace_back(m_Nodes[node_index].First, depth + 1);
+                pending.emplace_back(m_Nodes[node_index].First + 1, depth + 1);
+            }
+        }
+
+        m_Nodes.shrink_to_fit();
+    }
+
+    void Bvh::SetBounds(uint32_t object, const BoundingBox &bounds) {
+        if (object >= GetObjectCount()) {
+            throw std::out_of_range("invalid bvh object!");
+        }
+
+        m_Bounds[object] = bounds;
+    }
+
+    void Bvh::Refit() {
+        // Children are always created after their parent, walking backwards visits them first
+        for (size_t i = m_Nodes.size(); i-- > 0;) {
+            if (i == 1)
+                continue;
+
+            auto &node = m_Nodes[i];
+            if (node.IsLeaf()) {
+                UpdateNodeBounds(node);
+                continue;
+            }
+
+            const auto &left = m_Nodes[node.First];
+            const auto &right = m_Nodes[node.First + 1];
+            node.Min = glm::min(left.Min, right.Min);
+            node.Max = glm::max(left.Max, right.Max);
+        }
+    }
+
+    void Bvh::UpdateNodeBounds(Node &node) const {
+        BoundingBox box;
+        for (uint32_t i = node.First; i < node.First + node.Count; i++) {
+            box.Grow(m_Bounds[m_Objects[i]]);
+        }
+
+        node.Min = box.Min;
+        node.Max = box.Max;
+    }
+
+    void Bvh::Subdivide(uint32_t node_index) {
+        auto node = m_Nodes[node_index];
+        if (node.Count <= 1)
+            return;
+
+        BoundingBox centers;
+        for (uint32_t i = node.First; i < node.First + node.Count; i++) {
+            centers.Grow(m_Centers[m_Objects[i]]);
+        }
+
+        struct Bin
+        {
+            BoundingBox Bounds;
+            uint32_t Count = 0;
+        };
+
+        // Cheapest split between bins on any axis: objects times the area of the box holding them
+        float best_cost = FLT_MAX;
+        int best_axis = -1;
+        uint32_t best_split = 0;
+        for (int axis = 0; axis < 3; axis++) {
+            float extent = centers.Max[axis] - centers.Min[axis];
+            if (extent <= 0.0f)
+                continue;
+
+            std::array<Bin, SAH_BIN_COUNT> bins{};
+            float scale = SAH_BIN_COUNT / extent;
+            for (uint32_t i = node.First; i < node.First + node.Count; i++) {
+                auto object = m_Objects[i];
+                auto bin = std::min(SAH_BIN_COUNT - 1,
+                                    static_cast<uint32_t>((m_Centers[object][axis] - centers.Min[axis]) * scale));
+                bins[bin].Bounds.Grow(m_Bounds[object]);
+                bins[bin].Count++;
+            }
+
+            // Left side swept forward, right side backward
+            std::array<float, SAH_BIN_COUNT - 1> left_costs{};
+            BoundingBox left;
+            uint32_t left_count = 0;
+            for (uint32_t split = 0; split < SAH_BIN_COUNT - 1; split++) {
+                left.Grow(bins[split].Bounds);
+                left_count += bins[split].Count;
+                left_costs[split] = left_count ? left_count * left.GetHalfArea() : 0.0f;
+            }
+
+            BoundingBox right;
+            uint32_t right_count = 0;
+            for (uint32_t split = SAH_BIN_COUNT - 1; split > 0; split--) {
+                right.Grow(bins[split].Bounds);
+                right_count += bins[split].Count;
+
+                float cost = left_costs[split - 1] + (right_count ? right_count * right.GetHalfArea() : 0.0f);
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    best_axis = axis;
+                    best_split = split;
+                }
+            }
+        }
+
+        // Splitting must be cheaper than testing every object of the leaf
+        BoundingBox node_box{node.Min, node.Max};
+        if (best_axis < 0 || best_cost >= node.Count * node_box.GetHalfArea())
+            return;
+
+        float extent = centers.Max[best_axis] - centers.Min[best_axis];
+        float scale = SAH_BIN_COUNT / extent;
+        auto first = m_Objects.begin() + node.First;
+        auto middle = std::partition(first, first + node.Count, [&](uint32_t object) {
+            auto bin = std::min(SAH_BIN_COUNT - 1,
+                                static_cast<uint32_t>((m_Centers[object][best_axis] - centers.Min[best_axis]) * scale));
+            return bin < best_split;
+        });
+
+        auto left_count = static_cast<uint32_t>(middle - first);
+        if (left_count == 0 || left_count == node.Count)
+            return;
+
+        auto left_index = static_cast<uint32_t>(m_Nodes.size());
+        m_Nodes.resize(m_Nodes.size() + 2);
+
+        auto &left = m_Nodes[left_index];
+        left.First = node.First;
+        left.Count = left_count;
+        UpdateNodeBounds(left);
+
+        auto &right = m_Nodes[left_index + 1];
+        right.First = node.First + left_count;
+        right.Count = node.Count - left_count;
+        UpdateNodeBounds(right);
+
+        m_Nodes[node_index].First = left_index;
+        m_Nodes[node_index].Count = 0;
+    }
+
+    void Bvh::Cull(const Frustum &frustum, std::vector<uint32_t> &visible) const {
+        if (m_Nodes.empty())
+            return;
+
+        // Planes still to test, those a box is entirely inside of are cleared for everything under it
+        auto test = [&frustum](const glm::vec3 &min, const glm::vec3 &max, uint32_t &plane_mask) {
+            auto center = (min + max) * 0.5f;
+            auto extents = (max - min) * 0.5f;
+
+            for (uint32_t p = 0; p < 6; p++) {
+                if (!(plane_mask & (1u << p)))
+                    continue;
+
+                const auto &plane = frustum.Planes[p];
+                auto normal = glm::vec3(plane);
+                float distance = glm::dot(normal, center) + plane.w;
+                float radius = glm::dot(glm::abs(normal), extents);
+
+                if (distance + radius < 0.0f)
+                    return false;
+                if (distance - radius >= 0.0f)
+                    plane_mask &= ~(1u << p);
+            }
+
+            return true;
+        };
+
+        struct Entry
+        {
+            uint32_t Node;
+            uint32_t PlaneMask;
+        };
+        std::array<Entry, MAX_TRAVERSAL_DEPTH> stack;
+        uint32_t stack_size = 0;
+        stack[stack_size++] = {0, 0b111111};
+
+        while (stack_size > 0) {
+            auto [node_index, plane_mask] = stack[--stack_size];
+            const auto &node = m_Nodes[node_index];
+
+            if (!test(node.Min, node.Max, plane_mask))
+                continue;
+
+            if (plane_mask == 0) {
+                GatherObjects(node_index, visible);
+                continue;
+            }
+
+            if (!node.IsLeaf()) {
+                stack[stack_size++] = {node.First, plane_mask};
+                stack[stack_size++] = {node.First + 1, plane_mask};
+                continue;
+            }
+
+            for (uint32_t i = node.First; i < node.First + node.Count; i++) {
+                auto object = m_Objects[i];
+                auto object_mask = plane_mask;
+                if (test(m_Bounds[object].Min, m_Bounds[object].Max, object_mask))
+                    visible.emplace_back(object);
+            }
+        }
+    }
+
+    void Bvh::GatherObjects(uint32_t node_index, std::vector<uint32_t> &visible) const {
+        std::array<uint32_t, MAX_TRAVERSAL_DEPTH> stack;
+        uint32_t stack_size = 0;
+        stack[stack_size++] = node_index;
+
+        while (stack_size > 0) {
+            const auto &node = m_Nodes[stack[--stack_size]];
+            if (node.IsLeaf()) {
+                visible.insert(visible.end(), m_Objects.begin() + node.First,
+                               m_Objects.begin() + node.First + node.Count);
+                continue;
+            }
+
+            stack[stack_size++] = node.First;
+            stack[stack_size++] = node.First + 1;
+        }
+    }
+
+    Bvh::Hit Bvh::Raycast(const Ray &ray, float max_distance, const IntersectFunction &intersect) const {
+        Hit hit;
+        hit.Distance = max_distance;
+        if (m_Nodes.empty())
+            return hit;
+
+        auto inverse_direction = 1.0f / ray.Direction;
+        if (std::isinf(IntersectBox(ray, inverse_direction, m_Nodes[0].Min, m_Nodes[0].Max, hit.Distance)))
+            return hit;
+
+        // Nearest child first, farther ones are skipped once something nearer was hit
+        std::array<uint32_t, MAX_TRAVERSAL_DEPTH> stack;
+        uint32_t stack_size = 0;
+        uint32_t node_index = 0;
+
+        while (true) {
+            const auto &node = m_Nodes[node_index];
+
+            if (node.IsLeaf()) {
+                for (uint32_t i = node.First; i < node.First + node.Count; i++) {
+                    auto object = m_Objects[i];
+                    float distance =
+                        IntersectBox(ray, inverse_direction, m_Bounds[object].Min, m_Bounds[object].Max, hit.Distance);
+                    if (std::isinf(distance))
+                        continue;
+
+                    if (intersect && (!intersect(object, ray, distance) || distance >= hit.Distance))
+                        continue;
+
+                    hit.Object = object;
+                    hit.Distance = distance;
+                }
+            } else {
+                const auto &left = m_Nodes[node.First];
+                const auto &right = m_Nodes[node.First + 1];
+                float near_distance = IntersectBox(ray, inverse_direction, left.Min, left.Max, hit.Distance);
+                float far_distance = IntersectBox(ray, inverse_direction, right.Min, right.Max, hit.Distance);
+
+                uint32_t near_index = node.First, far_index = node.First + 1;
+                if (far_distance < near_distance) {
+                    std::swap(near_index, far_index);
+                    std::swap(near_distance, far_distance);
+                }
+
+                if (!std::isinf(near_distance)) {
+                    if (!std::isinf(far_distance))
+                        stack[stack_size++] = far_index;
+                    node_index = near_index;
+                    continue;
+                }
+            }
+
+            // Skips subtrees that are now farther than the nearest hit
+            bool found = false;
+            while (stack_size > 0 && !found) {
+                node_index = stack[--stack_size];
+                const auto &next = m_Nodes[node_index];
+                found = !std::isinf(IntersectBox(ray, inverse_direction, next.Min, next.Max, hit.Distance));
+            }
+
+            if (!found)
+                break;
+        }
+
+        return hit;
+    }
+} // namespace spock
@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/command_recorder.hh"
+#include "spock/frame_globals.hh"
+#include "spock/pipeline.hh"
+#include "spock/vulkan.hh"
+
+namespace spock
+{
+    CommandRecorder::CommandRecorder(VkCommandBuffer command_buffer)
+        : m_CommandBuffer(command_buffer) {
+    }
+
+    void CommandRecorder::Reset(VkCommandBuffer command_buffer) {
+        m_CommandBuffer = command_buffer;
+        m_Statistics = Statistics{};
+        Invalidate();
+    }
+
+    void CommandRecorder::Invalidate() {
+        m_Pipeline = nullptr;
+        m_PipelineLayout = VK_NULL_HANDLE;
+        m_DescriptorSets.fill(VK_NULL_HANDLE);
+        m_VertexBuffers.fill(VK_NULL_HANDLE);
+        m_VertexOffsets.fill(0);
+        m_IndexBuffer = VK_NULL_HANDLE;
+        m_HasViewport = false;
+        m_HasScissor = false;
+    }
+
+    void CommandRecorder::BindPipeline(const Pipeline &pipeline) {
+        if (m_Pipeline == &pipeline) {
+            m_Statistics.SkippedPipelineBinds++;
+            return;
+        }
+
+        pipeline.Bind(m_CommandBuffer);
+        m_Statistics.PipelineBinds++;
+        m_Pipeline = &pipeline;
+
+        // Sets bound for another layout may not be compatible
+        if (m_PipelineLayout != pipeline.GetLayout()) {
+            m_PipelineLayout = pipeline.GetLayout();
+            m_DescriptorSets.fill(VK_NULL_HANDLE);
+        }
+
+        // Bound by the pipeline itself
+        if (pipeline.UsesFrameGlobals())
+            m_DescriptorSets[FRAME_SET] = VK_NULL_HANDLE;
+
+        // Shader objects set every piece of dynamic state on bind
+        if (pipeline.UsesShaderObjects()) {
+            m_HasViewport = false;
+            m_HasScissor = false;
+        }
+    }
+
+    void CommandRecorder::BindDescriptorSet(uint32_t set, VkDescriptorSet descriptor_set) {
+        if (m_Pipeline == nullptr) {
+            throw std::runtime_error("a pipeline must be bound before its descriptor sets!");
+        }
+
+        if (set < MAX_SHADOWED_SETS && m_DescriptorSets[set] == descriptor_set) {
+            m_Statistics.SkippedDescriptorSetBinds++;
+            return;
+        }
+
+        vkCmdBindDescriptorSets(m_CommandBuffer, m_Pipeline->GetBindPoint(), m_PipelineLayout, set, 1,
+                                &descriptor_set, 0, nullptr);
+        m_Statistics.DescriptorSetBinds++;
+
+        if (set < MAX_SHADOWED_SETS)
+            m_DescriptorSets[set] = descriptor_set;
+    }
+
+    void CommandRecorder::BindVertexBuffers(uint32_t first_binding, std::span<const VkBuffer> buffers,
+                                            std::span<const VkDeviceSize> offsets) {
+        if (!offsets.empty() && offsets.size() != buffers.size()) {
+            throw std::invalid_argument("one offset per vertex buffer!");
+        }
+
+        // Zero offsets when none are given, on the stack unless more bindings than shadowed are bound
+        std::array<VkDeviceSize, MAX_SHADOWED_VERTEX_BINDINGS> zero_offsets{};
+        std::vector<VkDeviceSize> more_zero_offsets;
+        if (offsets.empty() && buffers.size() <= zero_offsets.size()) {
+            offsets = std::span<const VkDeviceSize>(zero_offsets.data(), buffers.size());
+        } else if (offsets.empty()) {
+            more_zero_offsets.resize(buffers.size());
+            offsets = more_zero_offsets;
+        }
+
+        bool bound = first_binding + buffers.size() <= MAX_SHADOWED_VERTEX_BINDINGS;
+        for (size_t i = 0; bound && i < buffers.size(); i++) {
+            auto binding = first_binding + i;
+            bound = m_VertexBuffers[binding] == buffers[i] && m_VertexOffsets[binding] == offsets[i];
+        }
+
+        if (bound) {
+            m_Statistics.SkippedVertexBufferBinds++;
+            return;
+        }
+
+        vkCmdBindVertexBuffers(m_CommandBuffer, first_binding, static_cast<uint32_t>(buffers.size()), buffers.data(),
+                               offsets.data());
+        m_Statistics.VertexBufferBinds++;
+
+        for (size_t i = 0; i < buffers.size() && first_binding + i < MAX_SHADOWED_VERTEX_BINDINGS; i++) {
+            m_VertexBuffers[first_binding + i] = buffers[i];
+            m_VertexOffsets[first_binding + i] = offsets[i];
+        }
+    }
+
+    void CommandRecorder::BindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType index_type) {
+        if (m_IndexBuffer == buffer && m_IndexOffset == offset && m_IndexType == index_type) {
+            m_Statistics.SkippedIndexBufferBinds++;
+            return;
+        }
+
+        vkCmdBindIndexBuffer(m_CommandBuffer, buffer, offset, index_type);
+        m_Statistics.IndexBufferBinds++;
+
+        m_IndexBuffer = buffer;
+        m_IndexOffset = offset;
+        m_IndexType = index_type;
+    }
+
+    void CommandRecorder::SetViewport(const VkViewport &viewport) {
+        if (m_HasViewport && m_Viewport.x == viewport.x && m_Viewport.y == viewport.y
+            && m_Viewport.width == viewport.width && m_Viewport.height == viewport.height
+            && m_Viewport.minDepth == viewport.minDepth && m_Viewport.maxDepth == viewport.maxDepth) {
+            m_Statistics.SkippedDynamicStates++;
+            return;
+        }
+
+        vkCmdSetViewport(m_CommandBuffer, 0, 1, &viewport);
+        m_Statistics.DynamicStates++;
+
+        m_HasViewport = true;
+        m_Viewport = viewport;
+    }
+
+    void CommandRecorder::SetScissor(const VkRect2D &scissor) {
+        if (m_HasScissor && m_Scissor.offset.x == scissor.offset.x && m_Scissor.offset.y == scissor.offset.y
+            && m_Scissor.extent.width == scissor.extent.width && m_Scissor.extent.height == scissor.extent.height) {
+            m_Statistics.SkippedDynamicStates++;
+            return;
+        }
+
+        vkCmdSetScissor(m_CommandBuffer, 0, 1, &scissor);
+        m_Statistics.DynamicStates++;
+
+        m_HasScissor = true;
+        m_Scissor = scissor;
+    }
+
+    void CommandRecorder::PushConstants(VkShaderStageFlags stages, uint32_t offset, uint32_t size, const void *data) {
+        if (m_Pipeline == nullptr) {
+            throw std::runtime_error("a pipeline must be bound before pushing constants!");
+        }
+
+        vkCmdPushConstants(m_CommandBuffer, m_PipelineLayout, stages, offset, size, data);
+    }
+
+    void CommandRecorder::Draw(uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex,
+                               uint32_t first_instance) {
+        vkCmdDraw(m_CommandBuffer, vertex_count, instance_count, first_vertex, first_instance);
+    }
+
+    void CommandRecorder::DrawIndexed(uint32_t index_count, uint32_t instance_count, uint32_t first_index,
+                                      int32_t vertex_offset, uint32_t first_instance) {
+        vkCmdDrawIndexed(m_CommandBuffer, index_count, instance_count, first_index, vertex_offset, first_instance);
+    }
+
+    void CommandRecorder::DrawMultiIndexed(std::span<const VkMultiDrawIndexedInfoEXT> draws, uint32_t instance_count,
+                                           uint32_t first_instance) {
+        const auto &extensions = s_VulkanContext.Extensions;
+        if (!extensions.MultiDraw) {
+            for (const auto &draw : draws) {
+                vkCmdDrawIndexed(m_CommandBuffer, draw.indexCount, instance_count, draw.firstIndex, draw.vertexOffset,
+                                 first_instance);
+            }
+            return;
+        }
+
+        // Split in as many calls as the device limit requires
+        for (size_t first = 0; first < draws.size(); first += extensions.MaxMultiDrawCount) {
+            auto count = std::min<size_t>(draws.size() - first, extensions.MaxMultiDrawCount);
+            extensions.CmdDrawMultiIndexedEXT(m_CommandBuffer, static_cast<uint32_t>(count), draws.data() + first,
+                                              instance_count, first_instance, sizeof(VkMultiDrawIndexedInfoEXT),
+                                              nullptr);
+        }
+    }
+} // namespace spock
@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/descriptor_allocator.hh"
+#include "spock/descriptor_set_layout.hxx"
+#include "spock/hash.hh"
+#include "spock/vulkan.hh"
+
+namespace spock
+{
+    static constexpr uint32_t MAX_SETS_PER_POOL = 4096;
+
+    // Descriptors reserved per set, for each type
+    // clang-format off
+    static constexpr std::array<std::pair<VkDescriptorType, float>, 11> POOL_RATIOS = {{
+        {VK_DESCRIPTOR_TYPE_SAMPLER,                0.5f},
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.f},
+        {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,          4.f},
+        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,          1.f},
+        {VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER,   1.f},
+        {VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER,   1.f},
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         2.f},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         2.f},
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.f},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1.f},
+        {VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,       0.5f},
+    }};
+    // clang-format on
+
+    size_t CachedDescriptorSetKey::GetHash() const {
+        return HashBytes(Descriptors.data(), Descriptors.size(), HashBytes(&Layout, sizeof(Layout)));
+    }
+
+    DescriptorAllocator::DescriptorAllocator(uint32_t sets_per_pool, VkDescriptorPoolCreateFlags flags)
+        : m_SetsPerPool(sets_per_pool)
+        , m_Flags(flags) {
+    }
+
+    VkDescriptorPool DescriptorAllocator::CreatePool(uint32_t set_count) {
+        std::array<VkDescriptorPoolSize, POOL_RATIOS.size()> poolSizes{};
+        for (size_t i = 0; i < POOL_RATIOS.size(); i++) {
+            poolSizes[i].type = POOL_RATIOS[i].first;
+            poolSizes[i].descriptorCount = std::max(1u, static_cast<uint32_t>(POOL_RATIOS[i].second * set_count));
+        }
+
+        VkDescriptorPoolCreateInfo pool_info{};
+        pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        pool_info.flags = m_Flags;
+        pool_info.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        pool_info.pPoolSizes = poolSizes.data();
+        pool_info.maxSets = set_count;
+
+        VkDescriptorPool pool;
+        if (vkCreateDescriptorPool(s_VulkanContext.Device, &pool_info, nullptr, &pool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create descriptor pool!");
+        }
+
+        return pool;
+    }
+
+    VkDescriptorPool DescriptorAllocator::GetPool() {
+        if (!m_ReadyPools.empty()) {
+            auto pool = m_ReadyPools.back();
+            m_ReadyPools.pop_back();
+            return pool;
+        }
+
+        // Each new pool is bigger than the last, a busy allocator quickly settles on a few large pools
+        auto pool = CreatePool(m_SetsPerPool);
+        m_SetsPerPool = std::min(m_SetsPerPool * 2, MAX_SETS_PER_POOL);
+
+        return pool;
+    }
+
+    VkDescriptorSet DescriptorAllocator::Allocate(VkDescriptorSetLayout layout, VkDescriptorPool *pool_out) {
+        auto pool = GetPool();
+
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = pool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &layout;
+
+        VkDescriptorSet descriptor_set;
+        auto result = vkAllocateDescriptorSets(s_VulkanContext.Device, &allocInfo, &descriptor_set);
+
+        // Retry once in a fresh pool
+        if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL) {
+            m_FullPools.emplace_back(pool);
+
+            pool = GetPool();
+            allocInfo.descriptorPool = pool;
+            result = vkAllocateDescriptorSets(s_VulkanContext.Device, &allocInfo, &descriptor_set);
+        }
+
+        if (result != VK_SUCCESS) {
+            m_ReadyPools.emplace_back(pool);
+            throw std::runtime_error("failed to allocate descriptor set!");
+        }
+
+        m_ReadyPools.emplace_back(pool);
+        if (pool_out != nullptr)
+            *pool_out = pool;
+
+        return descriptor_set;
+    }
+
+    void DescriptorAllocator::Free(VkDescriptorPool pool, VkDescriptorSet descriptor_set) {
+        if (!(m_Flags & VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT)) {
+            throw std::runtime_error("descriptor sets of this allocator can not be freed!");
+        }
+
+        vkFreeDescriptorSets(s_VulkanContext.Device, pool, 1, &descriptor_set);
+
+        // The pool has room again
+        if (auto it = std::find(m_FullPools.begin(), m_FullPools.end(), pool); it != m_FullPools.end()) {
+            m_FullPools.erase(it);
+            m_ReadyPools.emplace_back(pool);
+        }
+    }
+
+    void DescriptorAllocator::Reset() {
+        for (auto pool : m_ReadyPools) {
+            vkResetDescriptorPool(s_VulkanContext.Device, pool, 0);
+        }
+        for (auto pool : m_FullPools) {
+            vkResetDescriptorPool(s_VulkanContext.Device, pool, 0);
+            m_ReadyPools.emplace_back(pool);
+        }
+        m_FullPools.clear();
+    }
+
+    void DescriptorAllocator::Cleanup() {
+        for (auto pool : m_ReadyPools) {
+            vkDestroyDescriptorPool(s_VulkanContext.Device, pool, nullptr);
+        }
+        for (auto pool : m_FullPools) {
+            vkDestroyDescriptorPool(s_VulkanContext.Device, pool, nullptr);
+        }
+        m_ReadyPools.clear();
+        m_FullPools.clear();
+    }
+
+    DescriptorAllocator &DescriptorAllocator::GetGlobal() {
+        return s_VulkanContext.Descriptors;
+    }
+
+    DescriptorAllocator &DescriptorAllocator::GetFrame() {
+        return s_VulkanContext.FrameDescriptors[s_VulkanContext.CurrentFrame];
+    }
+
+    VkDescriptorSet DescriptorAllocator::GetCached(const DescriptorSetLayout &layout,
+                                                   std::span<const DescriptorInfo> descriptors) {
+        CachedDescriptorSetKey key{};
+        key.Layout = layout.GetDescriptorSetLayout();
+        key.Descriptors.resize(descriptors.size_bytes());
+        memcpy(key.Descriptors.data(), descriptors.data(), descriptors.size_bytes());
+
+        auto &cache = s_VulkanContext.CachedDescriptorSets;
+        if (auto it = cache.find(key); it != cache.end()) {
+            return it->second.Set;
+        }
+
+        CachedDescriptorSet cached{};
+        cached.Set = GetGlobal().Allocate(key.Layout, &cached.Pool);
+        layout.Update(cached.Set, descriptors);
+
+        for (const auto &binding : layout.GetBindings()) {
+            auto offset = layout.GetDescriptorOffset(binding.binding);
+            for (uint32_t i = 0; i < binding.descriptorCount; i++) {
+                const auto &descriptor = descriptors[offset + i];
+
+                switch (binding.descriptorType) {
+                case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+                case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+                case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+                case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+                    cached.Buffers.emplace_back(descriptor.Buffer.buffer);
+                    break;
+                case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+                case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+                case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+                case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+                    cached.ImageViews.emplace_back(descriptor.Image.imageView);
+                    break;
+                default:
+                    // Samplers are cached until `Spock::Cleanup`
+                    break;
+                }
+            }
+        }
+
+        auto descriptor_set = cached.Set;
+        cache.emplace(std::move(key), std::move(cached));
+        return descriptor_set;
+    }
+
+    // Out of the cache right away, the set itself may still be bound by the frames up to this one
+    template <typename Predicate>
+    static void EraseCached(Predicate predicate) {
+        auto &cache = s_VulkanContext.CachedDescriptorSets;
+        for (auto it = cache.begin(); it != cache.end();) {
+            if (predicate(it->second)) {
+                s_VulkanContext.PendingDescriptorSets.emplace_back(
+                    PendingDescriptorSet{it->second.Set, it->second.Pool, s_VulkanContext.FrameNumber});
+                it = cache.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void DescriptorAllocator::Invalidate(VkBuffer buffer) {
+        EraseCached([buffer](const CachedDescriptorSet &cached) {
+            return std::find(cached.Buffers.begin(), cached.Buffers.end(), buffer) != cached.Buffers.end();
+        });
+    }
+
+    void DescriptorAllocator::Invalidate(VkImageView image_view) {
+        EraseCached([image_view](const CachedDescriptorSet &cached) {
+            return std::find(cached.ImageViews.begin(), cached.ImageViews.end(), image_view)
+                   != cached.ImageViews.end();
+        });
+    }
+
+    void DescriptorAllocator::FreeInvalidated() {
+        // The frame being begun waited on the fence of the one submitted MAX_FRAMES_IN_FLIGHT frames before it,
+        // every frame up to that one is done
+        auto &pending = s_VulkanContext.PendingDescriptorSets;
+        size_t freed = 0;
+        for (const auto &pending_set : pending) {
+            if (pending_set.FrameNumber + MAX_FRAMES_IN_FLIGHT > s_VulkanContext.FrameNumber)
+                break;
+
+            GetGlobal().Free(pending_set.Pool, pending_set.Set);
+            freed++;
+        }
+
+        // Invalidated in order, the remaining ones are the most recent
+        pending.erase(pending.begin(), pending.begin() + freed);
+    }
+
+    uint32_t DescriptorAllocator::GetCachedCount() {
+        return static_cast<uint32_t>(s_VulkanContext.CachedDescriptorSets.size());
+    }
+} // namespace spock
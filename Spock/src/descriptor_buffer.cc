@@ -0,0 +1,172 @@
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/descriptor_buffer.hh"
+#include "spock/spock.hh"
+#include "spock/vulkan.hh"
+
+namespace spock
+{
+    static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    DescriptorBuffer::DescriptorBuffer(const DescriptorSetLayout &descriptor_set_layout, uint32_t max_sets)
+        : m_DescriptorSetLayout(descriptor_set_layout)
+        , m_SetSize(0)
+        , m_MaxSets(max_sets)
+        , m_SetCount(0)
+        , m_Buffer(nullptr)
+        , m_BufferMemory(nullptr)
+        , m_BufferAddress(0)
+        , m_BufferUsage(0)
+        , m_BufferMapped(nullptr) {
+        auto &extensions = s_VulkanContext.Extensions;
+        auto layout = descriptor_set_layout.GetDescriptorSetLayout();
+
+        if (!descriptor_set_layout.IsDescriptorBuffer()) {
+            throw std::invalid_argument("descriptor set layout was not created for descriptor buffers!");
+        }
+
+        extensions.GetDescriptorSetLayoutSizeEXT(s_VulkanContext.Device, layout, &m_SetSize);
+        m_SetSize = AlignUp(m_SetSize, extensions.DescriptorBufferProperties.descriptorBufferOffsetAlignment);
+
+        for (const auto &binding : descriptor_set_layout.GetBindings()) {
+            VkDeviceSize offset;
+            extensions.GetDescriptorSetLayoutBindingOffsetEXT(s_VulkanContext.Device, layout, binding.binding,
+                                                              &offset);
+            m_BindingOffsets.emplace_back(offset);
+        }
+
+        // Samplers need their own usage, combined image samplers included
+        m_BufferUsage = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT;
+        for (const auto &binding : descriptor_set_layout.GetBindings()) {
+            if (binding.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER
+                || binding.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) {
+                m_BufferUsage |= VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT;
+            }
+        }
+
+        Spock::CreateBuffer(m_SetSize * max_sets, m_BufferUsage | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_Buffer,
+                            m_BufferMemory);
+
+        vkMapMemory(s_VulkanContext.Device, m_BufferMemory, 0, m_SetSize * max_sets, 0,
+                    reinterpret_cast<void **>(&m_BufferMapped));
+        m_BufferAddress = Spock::GetBufferDeviceAddress(m_Buffer);
+    }
+
+    DescriptorBuffer::~DescriptorBuffer() {
+        vkUnmapMemory(s_VulkanContext.Device, m_BufferMemory);
+        vkDestroyBuffer(s_VulkanContext.Device, m_Buffer, nullptr);
+        vkFreeMemory(s_VulkanContext.Device, m_BufferMemory, nullptr);
+    }
+
+    uint32_t DescriptorBuffer::Allocate() {
+        if (!m_FreeSets.empty()) {
+            auto set_index = m_FreeSets.back();
+            m_FreeSets.pop_back();
+            return set_index;
+        }
+
+        if (m_SetCount == m_MaxSets) {
+            throw std::runtime_error("descriptor buffer is full!");
+        }
+
+        return m_SetCount++;
+    }
+
+    void DescriptorBuffer::Free(uint32_t set_index) {
+        m_FreeSets.emplace_back(set_index);
+    }
+
+    void DescriptorBuffer::Write(uint32_t set_index, std::span<const DescriptorInfo> descriptors) {
+        const auto &properties = s_VulkanContext.Extensions.DescriptorBufferProperties;
+        const auto &bindings = m_DescriptorSetLayout.GetBindings();
+
+        if (descriptors.size() != m_DescriptorSetLayout.GetDescriptorCount()) {
+            throw std::invalid_argument("descriptors do not match the descriptor set layout!");
+        }
+
+        uint8_t *set_data = m_BufferMapped + set_index * m_SetSize;
+        size_t descriptor_index = 0;
+
+        for (size_t i = 0; i < bindings.size(); i++) {
+            for (uint32_t element = 0; element < bindings[i].descriptorCount; element++) {
+                const auto &info = descriptors[descriptor_index++];
+
+                VkDescriptorGetInfoEXT getInfo{};
+                getInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT;
+                getInfo.type = bindings[i].descriptorType;
+
+                VkDescriptorAddressInfoEXT addressInfo{};
+                addressInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT;
+
+                size_t descriptor_size;
+                switch (getInfo.type) {
+                case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+                case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+                    addressInfo.address = Spock::GetBufferDeviceAddress(info.Buffer.buffer) + info.Buffer.offset;
+                    addressInfo.range = info.Buffer.range;
+                    addressInfo.format = VK_FORMAT_UNDEFINED;
+                    if (getInfo.type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) {
+                        getInfo.data.pUniformBuffer = &addressInfo;
+                        descriptor_size = properties.uniformBufferDescriptorSize;
+                    } else {
+                        getInfo.data.pStorageBuffer = &addressInfo;
+                        descriptor_size = properties.storageBufferDescriptorSize;
+                    }
+                    break;
+                case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+                    getInfo.data.pCombinedImageSampler = &info.Image;
+                    descriptor_size = properties.combinedImageSamplerDescriptorSize;
+                    break;
+                case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+                    getInfo.data.pSampledImage = &info.Image;
+                    descriptor_size = properties.sampledImageDescriptorSize;
+                    break;
+                case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+                    getInfo.data.pStorageImage = &info.Image;
+                    descriptor_size = properties.storageImageDescriptorSize;
+                    break;
+                case VK_DESCRIPTOR_TYPE_SAMPLER:
+                    getInfo.data.pSampler = &info.Image.sampler;
+                    descriptor_size = properties.samplerDescriptorSize;
+                    break;
+                default:
+                    throw std::invalid_argument("descriptor type is not supported by descriptor buffers!");
+                }
+
+                s_VulkanContext.Extensions.GetDescriptorEXT(s_VulkanContext.Device, &getInfo, descriptor_size,
+                                                            set_data + m_BindingOffsets[i]
+                                                                + element * descriptor_size);
+            }
+        }
+    }
+
+    void DescriptorBuffer::Bind(VkCommandBuffer command_buffer, VkPipelineLayout pipeline_layout, uint32_t set,
+                                uint32_t set_index) const {
+        VkDescriptorBufferBindingInfoEXT bindingInfo{};
+        bindingInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT;
+        bindingInfo.address = m_BufferAddress;
+        bindingInfo.usage = m_BufferUsage;
+        s_VulkanContext.Extensions.CmdBindDescriptorBuffersEXT(command_buffer, 1, &bindingInfo);
+
+        uint32_t buffer_index = 0;
+        VkDeviceSize offset = set_index * m_SetSize;
+        s_VulkanContext.Extensions.CmdSetDescriptorBufferOffsetsEXT(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                                                    pipeline_layout, set, 1, &buffer_index, &offset);
+    }
+
+    bool DescriptorBuffer::IsAvailable() {
+        return s_VulkanContext.Extensions.DescriptorBuffer;
+    }
+
+    std::unique_ptr<DescriptorBuffer>
+    DescriptorBuffer::CreateDescriptorBuffer(const std::unique_ptr<DescriptorSetLayout> &descriptor_set_layout,
+                                             uint32_t max_sets) {
+        return std::make_unique<DescriptorBuffer>(*descriptor_set_layout, max_sets);
+    }
+} // namespace spock
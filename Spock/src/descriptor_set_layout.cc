@@ -1,15 +1,156 @@
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 #include <vulkan/vulkan_core.h>
 
 #include "spock/descriptor_set_layout.hxx"
+#include "spock/hash.hh"
 #include "spock/vulkan.hh"
 
 namespace spock
 {
-    DescriptorSetLayout::DescriptorSetLayout(VkDescriptorSetLayout descriptor_set_layout)
-        : m_DescriptorSetLayout(descriptor_set_layout) {
+    DescriptorSetLayout::DescriptorSetLayout(VkDescriptorSetLayout descriptor_set_layout,
+                                             std::span<const VkDescriptorSetLayoutBinding> bindings,
+                                             VkDescriptorSetLayoutCreateFlags flags, uint64_t key)
+        : m_DescriptorSetLayout(descriptor_set_layout)
+        , m_Flags(flags)
+        , m_Bindings(bindings.begin(), bindings.end())
+        , m_Key(key)
+        , m_DescriptorCount(0)
+        , m_UpdateTemplate(VK_NULL_HANDLE) {
+        for (const auto &binding : m_Bindings) {
+            m_DescriptorOffsets.emplace_back(m_DescriptorCount);
+            m_DescriptorCount += binding.descriptorCount;
+        }
+
+        // Push descriptor templates are tied to a pipeline layout, descriptor buffers are written directly
+        if (!IsPushDescriptor() && !IsDescriptorBuffer()) {
+            CreateUpdateTemplate();
+        }
+    }
+
+    void DescriptorSetLayout::CreateUpdateTemplate() {
+        std::vector<VkDescriptorUpdateTemplateEntry> entries(m_Bindings.size());
+        for (size_t i = 0; i < m_Bindings.size(); i++) {
+            entries[i].dstBinding = m_Bindings[i].binding;
+            entries[i].dstArrayElement = 0;
+            entries[i].descriptorCount = m_Bindings[i].descriptorCount;
+            entries[i].descriptorType = m_Bindings[i].descriptorType;
+            entries[i].offset = m_DescriptorOffsets[i] * sizeof(DescriptorInfo);
+            entries[i].stride = sizeof(DescriptorInfo);
+        }
+
+        VkDescriptorUpdateTemplateCreateInfo templateInfo{};
+        templateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+        templateInfo.descriptorUpdateEntryCount = static_cast<uint32_t>(entries.size());
+        templateInfo.pDescriptorUpdateEntries = entries.data();
+        templateInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+        templateInfo.descriptorSetLayout = m_DescriptorSetLayout;
+
+        if (vkCreateDescriptorUpdateTemplate(s_VulkanContext.Device, &templateInfo, nullptr, &m_UpdateTemplate)
+            != VK_SUCCESS) {
+            throw std::runtime_error("failed to create descriptor update template!");
+        }
+    }
+
+    uint32_t DescriptorSetLayout::GetDescriptorOffset(uint32_t binding) const {
+        for (size_t i = 0; i < m_Bindings.size(); i++) {
+            if (m_Bindings[i].binding == binding)
+                return m_DescriptorOffsets[i];
+        }
+
+        throw std::invalid_argument("binding is not part of the descriptor set layout!");
+    }
+
+    void DescriptorSetLayout::Update(VkDescriptorSet descriptor_set, std::span<const DescriptorInfo> descriptors) const {
+        if (descriptors.size() != m_DescriptorCount) {
+            throw std::invalid_argument("descriptors do not match the descriptor set layout!");
+        }
+
+        vkUpdateDescriptorSetWithTemplate(s_VulkanContext.Device, descriptor_set, m_UpdateTemplate, descriptors.data());
+    }
+
+    bool DescriptorSetLayoutDescription::operator==(const DescriptorSetLayoutDescription &other) const {
+        if (Flags != other.Flags || Bindings.size() != other.Bindings.size()
+            || ImmutableSamplers != other.ImmutableSamplers)
+            return false;
+
+        for (size_t i = 0; i < Bindings.size(); i++) {
+            const auto &a = Bindings[i];
+            const auto &b = other.Bindings[i];
+            if (a.binding != b.binding || a.descriptorType != b.descriptorType
+                || a.descriptorCount != b.descriptorCount || a.stageFlags != b.stageFlags
+                || (a.pImmutableSamplers == nullptr) != (b.pImmutableSamplers == nullptr))
+                return false;
+        }
+
+        return true;
+    }
+
+    size_t DescriptorSetLayoutDescription::GetHash() const {
+        return HashBytes(ImmutableSamplers.data(), ImmutableSamplers.size() * sizeof(VkSampler),
+                         HashWord(Flags, BindingsKey));
+    }
+
+    std::unique_ptr<DescriptorSetLayout>
+    DescriptorSetLayout::CreateDescriptorSetLayout(std::span<const VkDescriptorSetLayoutBinding> bindings,
+                                                   VkDescriptorSetLayoutCreateFlags flags) {
+        return CreateDescriptorSetLayout(bindings, flags, GetBindingsKey(bindings));
+    }
+
+    std::unique_ptr<DescriptorSetLayout>
+    DescriptorSetLayout::CreateDescriptorSetLayout(std::span<const VkDescriptorSetLayoutBinding> bindings,
+                                                   VkDescriptorSetLayoutCreateFlags flags, uint64_t key) {
+        // The binding pointers are not kept, the samplers they point to are copied. The key is only the hash, a
+        // match still compares the bindings.
+        DescriptorSetLayoutDescription description{};
+        description.Flags = flags;
+        description.Bindings.assign(bindings.begin(), bindings.end());
+        description.BindingsKey = key;
+        for (const auto &binding : bindings) {
+            if (binding.pImmutableSamplers != nullptr)
+                description.ImmutableSamplers.insert(description.ImmutableSamplers.end(), binding.pImmutableSamplers,
+                                                     binding.pImmutableSamplers + binding.descriptorCount);
+        }
+
+        auto &cache = s_VulkanContext.DescriptorSetLayouts;
+        auto it = cache.find(description);
+
+        if (it == cache.end()) {
+            VkDescriptorSetLayoutCreateInfo layoutInfo{};
+            layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            layoutInfo.flags = flags;
+            layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+            layoutInfo.pBindings = bindings.data();
+
+            VkDescriptorSetLayout descriptor_set_layout;
+            if (vkCreateDescriptorSetLayout(s_VulkanContext.Device, &layoutInfo, nullptr, &descriptor_set_layout)
+                != VK_SUCCESS) {
+                throw std::runtime_error("failed to create descriptor set layout!");
+            }
+
+            it = cache.emplace(std::move(description), descriptor_set_layout).first;
+        }
+
+        return std::make_unique<DescriptorSetLayout>(it->second, bindings, flags, key);
+    }
+
+    void DescriptorSetLayout::Clear() {
+        for (const auto &[description, descriptor_set_layout] : s_VulkanContext.DescriptorSetLayouts) {
+            vkDestroyDescriptorSetLayout(s_VulkanContext.Device, descriptor_set_layout, nullptr);
+        }
+
+        s_VulkanContext.DescriptorSetLayouts.clear();
     }
 
     DescriptorSetLayout::~DescriptorSetLayout() {
-        vkDestroyDescriptorSetLayout(s_VulkanContext.Device, m_DescriptorSetLayout, nullptr);
+        // The layout itself belongs to the cache
+        if (m_UpdateTemplate != VK_NULL_HANDLE) {
+            vkDestroyDescriptorUpdateTemplate(s_VulkanContext.Device, m_UpdateTemplate, nullptr);
+        }
     }
 } // namespace spock
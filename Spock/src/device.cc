@@ -120,6 +120,82 @@ namespace spock
         }
     }
 
+    static bool IsDeviceExtensionSupported(VkPhysicalDevice device, const char *extension_name) {
+        uint32_t extensionCount;
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+        for (const auto &extension : availableExtensions) {
+            if (strcmp(extension.extensionName, extension_name) == 0) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    template <typename T>
+    static void LoadDeviceFunction(T &function, const char *name) {
+        function = reinterpret_cast<T>(vkGetDeviceProcAddr(s_VulkanContext.Device, name));
+        if (function == nullptr) {
+            throw std::runtime_error(std::string("failed to load device function ") + name + "!");
+        }
+    }
+
+    static void LoadDeviceExtensions() {
+        auto &extensions = s_VulkanContext.Extensions;
+
+        if (extensions.ShaderObject) {
+            LoadDeviceFunction(extensions.CreateShadersEXT, "vkCreateShadersEXT");
+            LoadDeviceFunction(extensions.DestroyShaderEXT, "vkDestroyShaderEXT");
+            LoadDeviceFunction(extensions.CmdBindShadersEXT, "vkCmdBindShadersEXT");
+            LoadDeviceFunction(extensions.CmdSetVertexInputEXT, "vkCmdSetVertexInputEXT");
+            LoadDeviceFunction(extensions.CmdSetPolygonModeEXT, "vkCmdSetPolygonModeEXT");
+            LoadDeviceFunction(extensions.CmdSetRasterizationSamplesEXT, "vkCmdSetRasterizationSamplesEXT");
+            LoadDeviceFunction(extensions.CmdSetSampleMaskEXT, "vkCmdSetSampleMaskEXT");
+            LoadDeviceFunction(extensions.CmdSetAlphaToCoverageEnableEXT, "vkCmdSetAlphaToCoverageEnableEXT");
+            LoadDeviceFunction(extensions.CmdSetColorBlendEnableEXT, "vkCmdSetColorBlendEnableEXT");
+            LoadDeviceFunction(extensions.CmdSetColorBlendEquationEXT, "vkCmdSetColorBlendEquationEXT");
+            LoadDeviceFunction(extensions.CmdSetColorWriteMaskEXT, "vkCmdSetColorWriteMaskEXT");
+        }
+
+        if (extensions.PushDescriptor) {
+            LoadDeviceFunction(extensions.CmdPushDescriptorSetKHR, "vkCmdPushDescriptorSetKHR");
+        }
+
+        if (extensions.MultiDraw) {
+            LoadDeviceFunction(extensions.CmdDrawMultiIndexedEXT, "vkCmdDrawMultiIndexedEXT");
+
+            VkPhysicalDeviceMultiDrawPropertiesEXT multiDrawProperties{};
+            multiDrawProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTI_DRAW_PROPERTIES_EXT;
+
+            VkPhysicalDeviceProperties2 properties{};
+            properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+            properties.pNext = &multiDrawProperties;
+            vkGetPhysicalDeviceProperties2(s_VulkanContext.PhysicalDevice, &properties);
+            extensions.MaxMultiDrawCount = multiDrawProperties.maxMultiDrawCount;
+        }
+
+        if (extensions.DescriptorBuffer) {
+            LoadDeviceFunction(extensions.GetDescriptorSetLayoutSizeEXT, "vkGetDescriptorSetLayoutSizeEXT");
+            LoadDeviceFunction(extensions.GetDescriptorSetLayoutBindingOffsetEXT,
+                               "vkGetDescriptorSetLayoutBindingOffsetEXT");
+            LoadDeviceFunction(extensions.GetDescriptorEXT, "vkGetDescriptorEXT");
+            LoadDeviceFunction(extensions.CmdBindDescriptorBuffersEXT, "vkCmdBindDescriptorBuffersEXT");
+            LoadDeviceFunction(extensions.CmdSetDescriptorBufferOffsetsEXT, "vkCmdSetDescriptorBufferOffsetsEXT");
+
+            extensions.DescriptorBufferProperties.sType =
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_PROPERTIES_EXT;
+
+            VkPhysicalDeviceProperties2 properties{};
+            properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+            properties.pNext = &extensions.DescriptorBufferProperties;
+            vkGetPhysicalDeviceProperties2(s_VulkanContext.PhysicalDevice, &properties);
+        }
+    }
+
     static bool CheckDeviceExtensionSupport(VkPhysicalDevice device) {
         uint32_t extensionCount;
         vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
@@ -271,19 +347,129 @@ namespace spock
             queueCreateInfos.emplace_back(queueCreateInfo);
         }
 
-        VkPhysicalDeviceFeatures deviceFeatures{};
-        deviceFeatures.samplerAnisotropy = VK_TRUE;
+        std::vector<const char *> enabledExtensions(deviceExtensions.begin(), deviceExtensions.end());
+        auto &extensions = s_VulkanContext.Extensions;
+
+        // Query the optional features we know about
+        VkPhysicalDeviceShaderObjectFeaturesEXT supportedShaderObjectFeatures{};
+        supportedShaderObjectFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_FEATURES_EXT;
+
+        VkPhysicalDeviceDescriptorBufferFeaturesEXT supportedDescriptorBufferFeatures{};
+        supportedDescriptorBufferFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT;
+
+        VkPhysicalDeviceMultiDrawFeaturesEXT supportedMultiDrawFeatures{};
+        supportedMultiDrawFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTI_DRAW_FEATURES_EXT;
+
+        VkPhysicalDeviceVulkan12Features supportedVulkan12Features{};
+        supportedVulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+        VkPhysicalDeviceFeatures2 supportedFeatures{};
+        supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        supportedFeatures.pNext = &supportedVulkan12Features;
+        if (IsDeviceExtensionSupported(s_VulkanContext.PhysicalDevice, VK_EXT_SHADER_OBJECT_EXTENSION_NAME)) {
+            supportedShaderObjectFeatures.pNext = supportedFeatures.pNext;
+            supportedFeatures.pNext = &supportedShaderObjectFeatures;
+        }
+        if (IsDeviceExtensionSupported(s_VulkanContext.PhysicalDevice, VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME)) {
+            supportedDescriptorBufferFeatures.pNext = supportedFeatures.pNext;
+            supportedFeatures.pNext = &supportedDescriptorBufferFeatures;
+        }
+        if (IsDeviceExtensionSupported(s_VulkanContext.PhysicalDevice, VK_EXT_MULTI_DRAW_EXTENSION_NAME)) {
+            supportedMultiDrawFeatures.pNext = supportedFeatures.pNext;
+            supportedFeatures.pNext = &supportedMultiDrawFeatures;
+        }
+        vkGetPhysicalDeviceFeatures2(s_VulkanContext.PhysicalDevice, &supportedFeatures);
+
+        // Features to enable, optional ones are chained in front of the core ones
+        VkPhysicalDeviceVulkan13Features vulkan13Features{};
+        vulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+        vulkan13Features.dynamicRendering = VK_TRUE;
+
+        // Bindless textures
+        VkPhysicalDeviceVulkan12Features vulkan12Features{};
+        vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        vulkan12Features.pNext = &vulkan13Features;
+        if (supportedVulkan12Features.runtimeDescriptorArray && supportedVulkan12Features.descriptorBindingPartiallyBound
+            && supportedVulkan12Features.descriptorBindingVariableDescriptorCount
+            && supportedVulkan12Features.descriptorBindingSampledImageUpdateAfterBind
+            && supportedVulkan12Features.shaderSampledImageArrayNonUniformIndexing) {
+            extensions.DescriptorIndexing = true;
+            vulkan12Features.descriptorIndexing = supportedVulkan12Features.descriptorIndexing;
+            vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+            vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+            vulkan12Features.descriptorBindingVariableDescriptorCount = VK_TRUE;
+            vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+            vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+        }
+
+        // Buffer addresses, required by descriptor buffers
+        if (supportedVulkan12Features.bufferDeviceAddress) {
+            extensions.BufferDeviceAddress = true;
+            vulkan12Features.bufferDeviceAddress = VK_TRUE;
+        }
+
+        // GPU driven draws, see `IndirectScene`
+        if (supportedVulkan12Features.drawIndirectCount) {
+            extensions.DrawIndirectCount = true;
+            vulkan12Features.drawIndirectCount = VK_TRUE;
+        }
+
+        VkPhysicalDeviceFeatures2 deviceFeatures{};
+        deviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        deviceFeatures.features.samplerAnisotropy = VK_TRUE;
+        deviceFeatures.pNext = &vulkan12Features;
+        if (supportedFeatures.features.multiDrawIndirect && supportedFeatures.features.drawIndirectFirstInstance) {
+            extensions.MultiDrawIndirect = true;
+            deviceFeatures.features.multiDrawIndirect = VK_TRUE;
+            deviceFeatures.features.drawIndirectFirstInstance = VK_TRUE;
+        }
+
+        VkPhysicalDeviceShaderObjectFeaturesEXT shaderObjectFeatures{};
+        shaderObjectFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_FEATURES_EXT;
+        if (supportedShaderObjectFeatures.shaderObject) {
+            extensions.ShaderObject = true;
+            enabledExtensions.emplace_back(VK_EXT_SHADER_OBJECT_EXTENSION_NAME);
+            shaderObjectFeatures.shaderObject = VK_TRUE;
+            shaderObjectFeatures.pNext = deviceFeatures.pNext;
+            deviceFeatures.pNext = &shaderObjectFeatures;
+        }
+
+        VkPhysicalDeviceDescriptorBufferFeaturesEXT descriptorBufferFeatures{};
+        descriptorBufferFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT;
+        if (s_VulkanContext.Settings.UseDescriptorBuffers && supportedDescriptorBufferFeatures.descriptorBuffer
+            && extensions.BufferDeviceAddress) {
+            extensions.DescriptorBuffer = true;
+            enabledExtensions.emplace_back(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME);
+            descriptorBufferFeatures.descriptorBuffer = VK_TRUE;
+            descriptorBufferFeatures.pNext = deviceFeatures.pNext;
+            deviceFeatures.pNext = &descriptorBufferFeatures;
+        }
+
+        VkPhysicalDeviceMultiDrawFeaturesEXT multiDrawFeatures{};
+        multiDrawFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTI_DRAW_FEATURES_EXT;
+        if (supportedMultiDrawFeatures.multiDraw) {
+            extensions.MultiDraw = true;
+            enabledExtensions.emplace_back(VK_EXT_MULTI_DRAW_EXTENSION_NAME);
+            multiDrawFeatures.multiDraw = VK_TRUE;
+            multiDrawFeatures.pNext = deviceFeatures.pNext;
+            deviceFeatures.pNext = &multiDrawFeatures;
+        }
+
+        // Extensions without features
+        if (IsDeviceExtensionSupported(s_VulkanContext.PhysicalDevice, VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME)) {
+            extensions.PushDescriptor = true;
+            enabledExtensions.emplace_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+        }
 
         VkDeviceCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        createInfo.pNext = &deviceFeatures;
 
         createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
         createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
-        createInfo.pEnabledFeatures = &deviceFeatures;
-
-        createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-        createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+        createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+        createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
         if (s_EnableValidationLayers) {
             createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
@@ -299,6 +485,8 @@ namespace spock
 
         vkGetDeviceQueue(s_VulkanContext.Device, indices.GraphicsFamily.value(), 0, &s_VulkanContext.GraphicsQueue);
         vkGetDeviceQueue(s_VulkanContext.Device, indices.PresentFamily.value(), 0, &s_VulkanContext.PresentQueue);
+
+        LoadDeviceExtensions();
     }
 
     void Spock::CreateCommandPool() {
@@ -377,6 +565,12 @@ namespace spock
 
     void Spock::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
                              VkBuffer &buffer, VkDeviceMemory &buffer_memory) {
+        // Descriptor buffers reference uniform and storage buffers by address, only when enabled by the settings
+        if (s_VulkanContext.Extensions.DescriptorBuffer
+            && (usage & (VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT))) {
+            usage |= VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+        }
+
         VkBufferCreateInfo bufferInfo{};
         bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
         bufferInfo.size = size;
@@ -396,6 +590,13 @@ namespace spock
         allocInfo.memoryTypeIndex =
             FindMemoryType(s_VulkanContext.PhysicalDevice, memRequirements.memoryTypeBits, properties);
 
+        VkMemoryAllocateFlagsInfo allocFlagsInfo{};
+        allocFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+        allocFlagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
+        if (usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) {
+            allocInfo.pNext = &allocFlagsInfo;
+        }
+
         if (vkAllocateMemory(s_VulkanContext.Device, &allocInfo, nullptr, &buffer_memory) != VK_SUCCESS) {
             throw std::runtime_error("failed to allocate buffer memory!");
         }
@@ -403,6 +604,14 @@ namespace spock
         vkBindBufferMemory(s_VulkanContext.Device, buffer, buffer_memory, 0);
     }
 
+    VkDeviceAddress Spock::GetBufferDeviceAddress(VkBuffer buffer) {
+        VkBufferDeviceAddressInfo addressInfo{};
+        addressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+        addressInfo.buffer = buffer;
+
+        return vkGetBufferDeviceAddress(s_VulkanContext.Device, &addressInfo);
+    }
+
     void Spock::CopyBuffer(VkBuffer src, VkBuffer dst, VkDeviceSize size) {
         auto command_buffer = BeginSingleTimeCommands();
 
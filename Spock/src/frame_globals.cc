@@ -0,0 +1,115 @@
+#include <chrono>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <stdexcept>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/frame_globals.hh"
+#include "spock/spock.hh"
+#include "spock/typed_descriptor_set_layout.hxx"
+#include "spock/vulkan.hh"
+
+namespace spock
+{
+    void Spock::CreateFrameGlobals() {
+        auto &globals = s_VulkanContext.FrameGlobals;
+
+        auto binding = UniformBufferBinding<0, FrameGlobalsData, VK_SHADER_STAGE_ALL>::LAYOUT_BINDING;
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = 1;
+        layoutInfo.pBindings = &binding;
+
+        if (vkCreateDescriptorSetLayout(s_VulkanContext.Device, &layoutInfo, nullptr, &globals.Layout) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create frame globals descriptor set layout!");
+        }
+
+        // One buffer and set per frame in flight, written once and never updated
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            CreateBuffer(sizeof(FrameGlobalsData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         globals.Buffers[i], globals.BuffersMemory[i]);
+            vkMapMemory(s_VulkanContext.Device, globals.BuffersMemory[i], 0, sizeof(FrameGlobalsData), 0,
+                        &globals.BuffersMapped[i]);
+
+            globals.Sets[i] = DescriptorAllocator::GetGlobal().Allocate(globals.Layout);
+
+            VkDescriptorBufferInfo bufferInfo{};
+            bufferInfo.buffer = globals.Buffers[i];
+            bufferInfo.offset = 0;
+            bufferInfo.range = sizeof(FrameGlobalsData);
+
+            VkWriteDescriptorSet descriptorWrite{};
+            descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrite.dstSet = globals.Sets[i];
+            descriptorWrite.dstBinding = 0;
+            descriptorWrite.dstArrayElement = 0;
+            descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            descriptorWrite.descriptorCount = 1;
+            descriptorWrite.pBufferInfo = &bufferInfo;
+
+            vkUpdateDescriptorSets(s_VulkanContext.Device, 1, &descriptorWrite, 0, nullptr);
+        }
+
+        globals.StartTime = std::chrono::steady_clock::now();
+        globals.LastFrameTime = globals.StartTime;
+    }
+
+    void Spock::CleanupFrameGlobals() {
+        auto &globals = s_VulkanContext.FrameGlobals;
+
+        // The sets belong to the global descriptor allocator
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            vkDestroyBuffer(s_VulkanContext.Device, globals.Buffers[i], nullptr);
+            vkFreeMemory(s_VulkanContext.Device, globals.BuffersMemory[i], nullptr);
+        }
+        vkDestroyDescriptorSetLayout(s_VulkanContext.Device, globals.Layout, nullptr);
+
+        globals = FrameGlobalsTable{};
+    }
+
+    void Spock::UpdateFrameGlobals() {
+        auto &globals = s_VulkanContext.FrameGlobals;
+
+        auto now = std::chrono::steady_clock::now();
+        globals.Data.Time = std::chrono::duration<float>(now - globals.StartTime).count();
+        globals.Data.DeltaTime = std::chrono::duration<float>(now - globals.LastFrameTime).count();
+        globals.LastFrameTime = now;
+
+        globals.Data.Viewport = glm::vec2(static_cast<float>(s_VulkanContext.SwapChainExtent.width),
+                                          static_cast<float>(s_VulkanContext.SwapChainExtent.height));
+    }
+
+    void Spock::UploadFrameGlobals() {
+        auto &globals = s_VulkanContext.FrameGlobals;
+
+        // Host coherent, visible to the frame once submitted
+        memcpy(globals.BuffersMapped[s_VulkanContext.CurrentFrame], &globals.Data, sizeof(FrameGlobalsData));
+    }
+
+    void FrameGlobals::SetCamera(const glm::mat4 &view, const glm::mat4 &projection) {
+        auto &data = s_VulkanContext.FrameGlobals.Data;
+
+        data.View = view;
+        data.Projection = projection;
+        data.ViewProjection = projection * view;
+        data.CameraPosition = glm::vec4(glm::vec3(glm::inverse(view)[3]), 1.0f);
+    }
+
+    const FrameGlobalsData &FrameGlobals::GetData() {
+        return s_VulkanContext.FrameGlobals.Data;
+    }
+
+    void FrameGlobals::Bind(VkCommandBuffer command_buffer, VkPipelineLayout pipeline_layout,
+                            VkPipelineBindPoint bind_point) {
+        auto &globals = s_VulkanContext.FrameGlobals;
+
+        vkCmdBindDescriptorSets(command_buffer, bind_point, pipeline_layout, FRAME_SET, 1,
+                                &globals.Sets[s_VulkanContext.CurrentFrame], 0, nullptr);
+    }
+
+    VkDescriptorSetLayout FrameGlobals::GetDescriptorSetLayout() {
+        return s_VulkanContext.FrameGlobals.Layout;
+    }
+} // namespace spock
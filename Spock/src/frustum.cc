@@ -0,0 +1,34 @@
+#include <glm/glm.hpp>
+
+#include "spock/frustum.hh"
+
+namespace spock
+{
+    bool Frustum::IntersectsSphere(const glm::vec3 &center, float radius) const {
+        for (const auto &plane : Planes) {
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+                return false;
+        }
+
+        return true;
+    }
+
+    Frustum Frustum::FromMatrix(const glm::mat4 &view_projection) {
+        // Rows of the column major matrix (Gribb & Hartmann)
+        auto row = [&view_projection](int i) {
+            return glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i],
+                             view_projection[3][i]);
+        };
+
+        // The near plane is the OpenGL one (-w <= z), looser than Vulkan's 0 <= z but never culls too much
+        Frustum frustum;
+        frustum.Planes = {row(3) + row(0), row(3) - row(0), row(3) + row(1),
+                          row(3) - row(1), row(3) + row(2), row(3) - row(2)};
+
+        for (auto &plane : frustum.Planes) {
+            plane /= glm::length(glm::vec3(plane));
+        }
+
+        return frustum;
+    }
+} // namespace spock
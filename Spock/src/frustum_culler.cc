@@ -0,0 +1,293 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <stdexcept>
+#include <vector>
+
+#include "spock/frustum_culler.hh"
+#include "spock/job_system.hh"
+
+// Kernels are compiled for their instruction set whatever the target, and picked at runtime
+#if defined(__x86_64__)
+#define SPOCK_CULL_X86
+#include <immintrin.h>
+#endif
+
+namespace spock
+{
+    // Objects per job, small sets are culled on the calling thread
+    static constexpr size_t CULL_BATCH_SIZE = 16384;
+
+    // The planes as scalars, broadcast by the kernels
+    struct CullPlanes
+    {
+        float X[6], Y[6], Z[6], W[6];
+        // Absolute normal, projects the box extents on the plane normal
+        float AbsX[6], AbsY[6], AbsZ[6];
+    };
+
+    struct CullArrays
+    {
+        const float *CenterX, *CenterY, *CenterZ;
+        const float *ExtentX, *ExtentY, *ExtentZ;
+        const float *Radius;
+        uint8_t *Visible;
+    };
+
+    // Culls [begin, end), returns how many are visible
+    using CullKernel = uint32_t (*)(const CullPlanes &planes, const CullArrays &arrays, size_t begin, size_t end);
+
+    static uint32_t CullScalar(const CullPlanes &planes, const CullArrays &arrays, size_t begin, size_t end) {
+        uint32_t visible_count = 0;
+
+        for (size_t i = begin; i < end; i++) {
+            bool visible = true;
+            for (int p = 0; p < 6 && visible; p++) {
+                float distance = planes.X[p] * arrays.CenterX[i] + planes.Y[p] * arrays.CenterY[i]
+                               + planes.Z[p] * arrays.CenterZ[i] + planes.W[p];
+                float box = planes.AbsX[p] * arrays.ExtentX[i] + planes.AbsY[p] * arrays.ExtentY[i]
+                          + planes.AbsZ[p] * arrays.ExtentZ[i];
+                visible = distance + std::min(box, arrays.Radius[i]) >= 0.0f;
+            }
+
+            arrays.Visible[i] = visible;
+            visible_count += visible;
+        }
+
+        return visible_count;
+    }
+
+#ifdef SPOCK_CULL_X86
+    __attribute__((target("sse2"))) static uint32_t CullSSE(const CullPlanes &planes, const CullArrays &arrays,
+                                                             size_t begin, size_t end) {
+        uint32_t visible_count = 0;
+
+        size_t i = begin;
+        for (; i + 4 <= end; i += 4) {
+            __m128 center_x = _mm_loadu_ps(arrays.CenterX + i);
+            __m128 center_y = _mm_loadu_ps(arrays.CenterY + i);
+            __m128 center_z = _mm_loadu_ps(arrays.CenterZ + i);
+            __m128 extent_x = _mm_loadu_ps(arrays.ExtentX + i);
+            __m128 extent_y = _mm_loadu_ps(arrays.ExtentY + i);
+            __m128 extent_z = _mm_loadu_ps(arrays.ExtentZ + i);
+            __m128 radius = _mm_loadu_ps(arrays.Radius + i);
+
+            // All lanes set while inside every plane
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (int p = 0; p < 6; p++) {
+                __m128 distance = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.X[p]), center_x),
+                               _mm_mul_ps(_mm_set1_ps(planes.Y[p]), center_y)),
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.Z[p]), center_z), _mm_set1_ps(planes.W[p])));
+                __m128 box = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.AbsX[p]), extent_x),
+                                                   _mm_mul_ps(_mm_set1_ps(planes.AbsY[p]), extent_y)),
+                                        _mm_mul_ps(_mm_set1_ps(planes.AbsZ[p]), extent_z));
+                __m128 extent = _mm_min_ps(box, radius);
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, extent), _mm_setzero_ps()));
+            }
+
+            int mask = _mm_movemask_ps(inside);
+            for (int lane = 0; lane < 4; lane++) {
+                arrays.Visible[i + lane] = (mask >> lane) & 1;
+            }
+            visible_count += std::popcount(static_cast<uint32_t>(mask));
+        }
+
+        return visible_count + CullScalar(planes, arrays, i, end);
+    }
+
+    // The 8 bits of a lane mask spread to the low bit of each byte. A table rather than `_pdep_u64`, which is
+    // microcoded and takes hundreds of cycles on AMD before Zen 3.
+    static constexpr std::array<uint64_t, 256> LANE_BYTES = []() {
+        std::array<uint64_t, 256> table{};
+        for (uint32_t mask = 0; mask < 256; mask++) {
+            for (uint32_t lane = 0; lane < 8; lane++) {
+                table[mask] |= static_cast<uint64_t>((mask >> lane) & 1) << (lane * 8);
+            }
+        }
+        return table;
+    }();
+
+    __attribute__((target("avx2"))) static uint32_t CullAVX2(const CullPlanes &planes, const CullArrays &arrays,
+                                                              size_t begin, size_t end) {
+        uint32_t visible_count = 0;
+
+        size_t i = begin;
+        for (; i + 8 <= end; i += 8) {
+            __m256 center_x = _mm256_loadu_ps(arrays.CenterX + i);
+            __m256 center_y = _mm256_loadu_ps(arrays.CenterY + i);
+            __m256 center_z = _mm256_loadu_ps(arrays.CenterZ + i);
+            __m256 extent_x = _mm256_loadu_ps(arrays.ExtentX + i);
+            __m256 extent_y = _mm256_loadu_ps(arrays.ExtentY + i);
+            __m256 extent_z = _mm256_loadu_ps(arrays.ExtentZ + i);
+            __m256 radius = _mm256_loadu_ps(arrays.Radius + i);
+
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (int p = 0; p < 6; p++) {
+                __m256 distance = _mm256_add_ps(
+                    _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes.X[p]), center_x),
+                                  _mm256_mul_ps(_mm256_set1_ps(planes.Y[p]), center_y)),
+                    _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes.Z[p]), center_z), _mm256_set1_ps(planes.W[p])));
+                __m256 box = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes.AbsX[p]), extent_x),
+                                                         _mm256_mul_ps(_mm256_set1_ps(planes.AbsY[p]), extent_y)),
+                                           _mm256_mul_ps(_mm256_set1_ps(planes.AbsZ[p]), extent_z));
+                __m256 extent = _mm256_min_ps(box, radius);
+                inside = _mm256_and_ps(inside,
+                                       _mm256_cmp_ps(_mm256_add_ps(distance, extent), _mm256_setzero_ps(), _CMP_GE_OQ));
+            }
+
+            // One byte per lane
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(inside));
+            memcpy(arrays.Visible + i, &LANE_BYTES[mask], sizeof(uint64_t));
+            visible_count += std::popcount(mask);
+        }
+
+        return visible_count + CullScalar(planes, arrays, i, end);
+    }
+#endif
+
+    static CullKernel GetKernel(FrustumCuller::Kernel kernel) {
+        switch (kernel) {
+#ifdef SPOCK_CULL_X86
+            case FrustumCuller::Kernel::SSE:
+                return CullSSE;
+            case FrustumCuller::Kernel::AVX2:
+                return CullAVX2;
+#endif
+            default:
+                return CullScalar;
+        }
+    }
+
+    uint32_t FrustumCuller::AddBox(const glm::vec3 &min, const glm::vec3 &max) {
+        auto extents = (max - min) * 0.5f;
+        return Add((min + max) * 0.5f, extents, glm::length(extents));
+    }
+
+    uint32_t FrustumCuller::AddSphere(const glm::vec3 &center, float radius) {
+        return Add(center, glm::vec3(radius), radius);
+    }
+
+    void FrustumCuller::SetBox(uint32_t index, const glm::vec3 &min, const glm::vec3 &max) {
+        auto extents = (max - min) * 0.5f;
+        Set(index, (min + max) * 0.5f, extents, glm::length(extents));
+    }
+
+    void FrustumCuller::SetSphere(uint32_t index, const glm::vec3 &center, float radius) {
+        Set(index, center, glm::vec3(radius), radius);
+    }
+
+    void FrustumCuller::Reserve(size_t count) {
+        for (auto *array : {&m_CenterX, &m_CenterY, &m_CenterZ, &m_ExtentX, &m_ExtentY, &m_ExtentZ, &m_Radius}) {
+            array->reserve(count);
+        }
+        m_Visible.reserve(count);
+    }
+
+    void FrustumCuller::Clear() {
+        for (auto *array : {&m_CenterX, &m_CenterY, &m_CenterZ, &m_ExtentX, &m_ExtentY, &m_ExtentZ, &m_Radius}) {
+            array->clear();
+        }
+        m_Visible.clear();
+    }
+
+    uint32_t FrustumCuller::Add(const glm::vec3 &center, const glm::vec3 &extents, float radius) {
+        m_CenterX.emplace_back(center.x);
+        m_CenterY.emplace_back(center.y);
+        m_CenterZ.emplace_back(center.z);
+        m_ExtentX.emplace_back(extents.x);
+        m_ExtentY.emplace_back(extents.y);
+        m_ExtentZ.emplace_back(extents.z);
+        m_Radius.emplace_back(radius);
+        m_Visible.emplace_back(1);
+
+        return GetObjectCount() - 1;
+    }
+
+    void FrustumCuller::Set(uint32_t index, const glm::vec3 &center, const glm::vec3 &extents, float radius) {
+        if (index >= GetObjectCount()) {
+            throw std::out_of_range("invalid frustum culler object!");
+        }
+
+        m_CenterX[index] = center.x;
+        m_CenterY[index] = center.y;
+        m_CenterZ[index] = center.z;
+        m_ExtentX[index] = extents.x;
+        m_ExtentY[index] = extents.y;
+        m_ExtentZ[index] = extents.z;
+        m_Radius[index] = radius;
+    }
+
+    uint32_t FrustumCuller::Cull(const Frustum &frustum, Kernel kernel, bool parallel) {
+        if (!IsSupported(kernel)) {
+            throw std::invalid_argument("culling kernel not supported by this CPU!");
+        }
+
+        CullPlanes planes;
+        for (int p = 0; p < 6; p++) {
+            const auto &plane = frustum.Planes[p];
+            planes.X[p] = plane.x;
+            planes.Y[p] = plane.y;
+            planes.Z[p] = plane.z;
+            planes.W[p] = plane.w;
+            planes.AbsX[p] = std::abs(plane.x);
+            planes.AbsY[p] = std::abs(plane.y);
+            planes.AbsZ[p] = std::abs(plane.z);
+        }
+
+        CullArrays arrays{m_CenterX.data(), m_CenterY.data(), m_CenterZ.data(), m_ExtentX.data(),
+                          m_ExtentY.data(), m_ExtentZ.data(), m_Radius.data(),  m_Visible.data()};
+        auto cull = GetKernel(kernel);
+
+        if (!parallel)
+            return cull(planes, arrays, 0, GetObjectCount());
+
+        // Batches are multiples of the widest kernel, they never share a vector
+        std::atomic<uint32_t> visible_count = 0;
+        JobSystem::ParallelFor(GetObjectCount(), CULL_BATCH_SIZE, [&](size_t begin, size_t end) {
+            visible_count.fetch_add(cull(planes, arrays, begin, end), std::memory_order_relaxed);
+        });
+
+        return visible_count;
+    }
+
+    FrustumCuller::Kernel FrustumCuller::GetBestKernel() {
+        static const Kernel best = IsSupported(Kernel::AVX2) ? Kernel::AVX2
+                                 : IsSupported(Kernel::SSE)  ? Kernel::SSE
+                                                             : Kernel::Scalar;
+        return best;
+    }
+
+    bool FrustumCuller::IsSupported(Kernel kernel) {
+        switch (kernel) {
+#ifdef SPOCK_CULL_X86
+            case Kernel::SSE:
+                return __builtin_cpu_supports("sse2");
+            case Kernel::AVX2:
+                return __builtin_cpu_supports("avx2");
+#endif
+            case Kernel::Scalar:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    const char *FrustumCuller::GetKernelName(Kernel kernel) {
+        switch (kernel) {
+            case Kernel::Scalar:
+                return "Scalar";
+            case Kernel::SSE:
+                return "SSE";
+            case Kernel::AVX2:
+                return "AVX2";
+        }
+
+        return "Unknown";
+    }
+} // namespace spock
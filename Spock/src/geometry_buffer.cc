@@ -0,0 +1,179 @@
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/buffers.hxx"
+#include "spock/command_recorder.hh"
+#include "spock/geometry_buffer.hh"
+#include "spock/mesh_simplifier.hh"
+#include "spock/range_allocator.hh"
+#include "spock/spock.hh"
+#include "spock/vulkan.hh"
+
+namespace spock
+{
+    GeometryBuffer::GeometryBuffer(uint32_t vertex_stride, uint32_t vertex_capacity, uint32_t index_capacity)
+        : m_VertexStride(vertex_stride)
+        , m_Vertices(vertex_capacity)
+        , m_Indices(index_capacity) {
+        if (vertex_stride == 0 || vertex_capacity == 0 || index_capacity == 0)
+            throw std::invalid_argument("geometry buffer stride and capacities must not be zero!");
+
+        m_VertexBuffer = Buffer::CreateBuffer(static_cast<VkDeviceSize>(vertex_stride) * vertex_capacity,
+                                              VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        m_IndexBuffer = Buffer::CreateBuffer(sizeof(uint32_t) * static_cast<VkDeviceSize>(index_capacity),
+                                             VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    }
+
+    GeometryBuffer::Mesh GeometryBuffer::Allocate(const void *vertices, uint32_t vertex_count,
+                                                  const uint32_t *indices, uint32_t index_count) {
+        LodLevel lod{std::vector<uint32_t>(indices, indices + index_count), 0.0f};
+        return AllocateLods(vertices, vertex_count, {&lod, 1});
+    }
+
+    GeometryBuffer::Mesh GeometryBuffer::AllocateLods(const void *vertices, uint32_t vertex_count,
+                                                      std::span<const LodLevel> lods) {
+        if (lods.empty() || lods.size() > MAX_MESH_LODS)
+            throw std::invalid_argument("meshes must have between one and MAX_MESH_LODS levels of detail!");
+
+        // Every level one after the other
+        Mesh mesh{};
+        mesh.VertexCount = vertex_count;
+        mesh.LodCount = static_cast<uint32_t>(lods.size());
+        for (uint32_t i = 0; i < mesh.LodCount; i++) {
+            mesh.Lods[i].FirstIndex = mesh.AllocatedIndexCount;
+            mesh.Lods[i].IndexCount = static_cast<uint32_t>(lods[i].Indices.size());
+            mesh.Lods[i].Error = lods[i].Error;
+            mesh.AllocatedIndexCount += mesh.Lods[i].IndexCount;
+        }
+
+        if (vertex_count == 0 || mesh.Lods[0].IndexCount == 0)
+            throw std::invalid_argument("meshes must have vertices and indices!");
+
+        ReclaimFreedMeshes();
+
+        mesh.FirstVertex = m_Vertices.Allocate(vertex_count);
+        mesh.FirstAllocatedIndex = m_Indices.Allocate(mesh.AllocatedIndexCount);
+
+        if (mesh.FirstVertex == RangeAllocator::INVALID_OFFSET
+            || mesh.FirstAllocatedIndex == RangeAllocator::INVALID_OFFSET) {
+            if (mesh.FirstVertex != RangeAllocator::INVALID_OFFSET)
+                m_Vertices.Free(mesh.FirstVertex, vertex_count);
+            if (mesh.FirstAllocatedIndex != RangeAllocator::INVALID_OFFSET)
+                m_Indices.Free(mesh.FirstAllocatedIndex, mesh.AllocatedIndexCount);
+
+            throw std::runtime_error("failed to allocate mesh, geometry buffer is full!");
+        }
+
+        for (uint32_t i = 0; i < mesh.LodCount; i++) {
+            mesh.Lods[i].FirstIndex += mesh.FirstAllocatedIndex;
+        }
+        mesh.FirstIndex = mesh.Lods[0].FirstIndex;
+        mesh.IndexCount = mesh.Lods[0].IndexCount;
+
+        // Vertices then indices in one staging buffer, both copied by the same submission
+        VkDeviceSize vertices_size = static_cast<VkDeviceSize>(m_VertexStride) * vertex_count;
+        VkDeviceSize indices_size = sizeof(uint32_t) * static_cast<VkDeviceSize>(mesh.AllocatedIndexCount);
+
+        auto staging_buffer = Buffer::CreateBuffer(vertices_size + indices_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                                                       | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        auto *mapped = static_cast<std::byte *>(staging_buffer->Map());
+        memcpy(mapped, vertices, vertices_size);
+        auto *mapped_indices = mapped + vertices_size;
+        for (const auto &lod : lods) {
+            memcpy(mapped_indices, lod.Indices.data(), sizeof(uint32_t) * lod.Indices.size());
+            mapped_indices += sizeof(uint32_t) * lod.Indices.size();
+        }
+
+        auto command_buffer = Spock::BeginSingleTimeCommands();
+
+        VkBufferCopy vertex_region{};
+        vertex_region.srcOffset = 0;
+        vertex_region.dstOffset = static_cast<VkDeviceSize>(m_VertexStride) * mesh.FirstVertex;
+        vertex_region.size = vertices_size;
+        vkCmdCopyBuffer(command_buffer, staging_buffer->GetBuffer(), m_VertexBuffer->GetBuffer(), 1, &vertex_region);
+
+        VkBufferCopy index_region{};
+        index_region.srcOffset = vertices_size;
+        index_region.dstOffset = sizeof(uint32_t) * static_cast<VkDeviceSize>(mesh.FirstAllocatedIndex);
+        index_region.size = indices_size;
+        vkCmdCopyBuffer(command_buffer, staging_buffer->GetBuffer(), m_IndexBuffer->GetBuffer(), 1, &index_region);
+
+        Spock::EndSingleTimeCommands(command_buffer);
+
+        return mesh;
+    }
+
+    void GeometryBuffer::Free(const Mesh &mesh) {
+        if (mesh.VertexCount == 0)
+            return;
+
+        m_FreedMeshes.emplace_back(FreedMesh{mesh, s_VulkanContext.FrameNumber});
+    }
+
+    void GeometryBuffer::ReclaimFreedMeshes() {
+        // Frames up to the one recorded when the mesh was freed may draw it. The fence of that frame is waited on
+        // when its slot is acquired again, which is done once MAX_FRAMES_IN_FLIGHT more frames were submitted.
+        size_t reclaimed = 0;
+        for (const auto &freed : m_FreedMeshes) {
+            if (freed.FrameNumber + MAX_FRAMES_IN_FLIGHT >= s_VulkanContext.FrameNumber)
+                break;
+
+            m_Vertices.Free(freed.Range.FirstVertex, freed.Range.VertexCount);
+            m_Indices.Free(freed.Range.FirstAllocatedIndex, freed.Range.AllocatedIndexCount);
+            reclaimed++;
+        }
+
+        // Freed in order, the remaining ones are the most recent
+        m_FreedMeshes.erase(m_FreedMeshes.begin(), m_FreedMeshes.begin() + reclaimed);
+    }
+
+    void GeometryBuffer::Bind(CommandRecorder &recorder) const {
+        VkBuffer vertex_buffer = m_VertexBuffer->GetBuffer();
+        recorder.BindVertexBuffers(0, {&vertex_buffer, 1});
+        recorder.BindIndexBuffer(m_IndexBuffer->GetBuffer());
+    }
+
+    void GeometryBuffer::Draw(CommandRecorder &recorder, const Mesh &mesh, uint32_t lod, uint32_t instance_count,
+                              uint32_t first_instance) const {
+        assert(lod < mesh.LodCount && "level of detail out of range");
+
+        const auto &range = mesh.Lods[lod];
+        recorder.DrawIndexed(range.IndexCount, instance_count, range.FirstIndex,
+                             static_cast<int32_t>(mesh.FirstVertex), first_instance);
+    }
+
+    void GeometryBuffer::DrawMeshes(CommandRecorder &recorder, std::span<const Mesh> meshes, uint32_t instance_count,
+                                    uint32_t first_instance) {
+        m_Draws.clear();
+        for (const auto &mesh : meshes) {
+            m_Draws.emplace_back(
+                VkMultiDrawIndexedInfoEXT{mesh.FirstIndex, mesh.IndexCount, static_cast<int32_t>(mesh.FirstVertex)});
+        }
+
+        recorder.DrawMultiIndexed(m_Draws, instance_count, first_instance);
+    }
+
+    uint32_t GeometryBuffer::GetFreeVertexCount() const {
+        return m_Vertices.GetFreeSize();
+    }
+
+    uint32_t GeometryBuffer::GetFreeIndexCount() const {
+        return m_Indices.GetFreeSize();
+    }
+
+    std::unique_ptr<GeometryBuffer> GeometryBuffer::CreateGeometryBuffer(uint32_t vertex_stride,
+                                                                         uint32_t vertex_capacity,
+                                                                         uint32_t index_capacity) {
+        return std::make_unique<GeometryBuffer>(vertex_stride, vertex_capacity, index_capacity);
+    }
+} // namespace spock
@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <stdexcept>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/descriptor_allocator.hh"
+#include "spock/frame_globals.hh"
+#include "spock/hiz_pyramid.hh"
+#include "spock/pipeline.hh"
+#include "spock/sampler.hh"
+#include "spock/spock.hh"
+#include "spock/vulkan.hh"
+#include "spock_shaders.hh"
+
+namespace spock
+{
+    static constexpr uint32_t HIZ_GROUP_SIZE = 8;
+
+    static void ComputeBarrier(VkCommandBuffer command_buffer) {
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    static VkImageView CreateLevelView(VkImage image, uint32_t level, uint32_t level_count) {
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = VK_FORMAT_R32_SFLOAT;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.baseMipLevel = level;
+        viewInfo.subresourceRange.levelCount = level_count;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        VkImageView image_view;
+        if (vkCreateImageView(s_VulkanContext.Device, &viewInfo, nullptr, &image_view) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create image view!");
+        }
+
+        return image_view;
+    }
+
+    HiZPyramid::HiZPyramid() {
+        m_DepthSetLayout = DepthSetLayout::CreateDescriptorSetLayout();
+        m_ReduceSetLayout = ReduceSetLayout::CreateDescriptorSetLayout();
+        m_SampleSetLayout = SampleSetLayout::CreateDescriptorSetLayout();
+        m_Data = UniformBuffer<HiZData>::CreateUniformBuffer();
+
+        PipelineConfig depth_config{};
+        depth_config.Stages.emplace_back(
+            PipelineStage::PipelineStageFromData(shaders::hiz_depth_comp, VK_SHADER_STAGE_COMPUTE_BIT));
+        depth_config.DescriptorSetLayouts = {m_DepthSetLayout->GetDescriptorSetLayout()};
+        m_DepthPipeline = Pipeline::CreatePipeline(std::move(depth_config));
+
+        PipelineConfig reduce_config{};
+        reduce_config.Stages.emplace_back(
+            PipelineStage::PipelineStageFromData(shaders::hiz_reduce_comp, VK_SHADER_STAGE_COMPUTE_BIT));
+        reduce_config.DescriptorSetLayouts = {m_ReduceSetLayout->GetDescriptorSetLayout()};
+        m_ReducePipeline = Pipeline::CreatePipeline(std::move(reduce_config));
+
+        // Texels are read as they are, never filtered
+        SamplerDescription sampler{};
+        sampler.MagFilter = VK_FILTER_NEAREST;
+        sampler.MinFilter = VK_FILTER_NEAREST;
+        sampler.MipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        sampler.AddressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        sampler.AddressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        sampler.AddressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        sampler.MaxAnisotropy = 1.0f;
+        m_Sampler = Sampler::Get(sampler);
+    }
+
+    HiZPyramid::~HiZPyramid() {
+        DestroyImage();
+    }
+
+    void HiZPyramid::CreateImage(VkCommandBuffer command_buffer) {
+        // Largest power of two fitting in the depth, every level then halves exactly
+        auto extent = s_VulkanContext.SwapChainExtent;
+        m_Extent.width = std::bit_floor(std::max(extent.width, 1u));
+        m_Extent.height = std::bit_floor(std::max(extent.height, 1u));
+        m_LevelCount = std::bit_width(std::max(m_Extent.width, m_Extent.height));
+
+        Spock::CreateImage(m_Extent.width, m_Extent.height, m_LevelCount, VK_FORMAT_R32_SFLOAT,
+                           VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_TILING_OPTIMAL,
+                           VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_Image, m_ImageMemory);
+
+        m_ImageView = CreateLevelView(m_Image, 0, m_LevelCount);
+        for (uint32_t level = 0; level < m_LevelCount; level++) {
+            m_LevelViews.emplace_back(CreateLevelView(m_Image, level, 1));
+        }
+
+        // Written and sampled in the general layout, never transitioned again
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = m_Image;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = m_LevelCount;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                             0, nullptr, 0, nullptr, 1, &barrier);
+    }
+
+    void HiZPyramid::DestroyImage() {
+        if (m_Image == VK_NULL_HANDLE)
+            return;
+
+        for (auto level_view : m_LevelViews) {
+            DescriptorAllocator::Invalidate(level_view);
+            vkDestroyImageView(s_VulkanContext.Device, level_view, nullptr);
+        }
+        m_LevelViews.clear();
+        DescriptorAllocator::Invalidate(m_ImageView);
+        vkDestroyImageView(s_VulkanContext.Device, m_ImageView, nullptr);
+        vkDestroyImage(s_VulkanContext.Device, m_Image, nullptr);
+        vkFreeMemory(s_VulkanContext.Device, m_ImageMemory, nullptr);
+        m_Image = VK_NULL_HANDLE;
+    }
+
+    void HiZPyramid::Build(VkCommandBuffer command_buffer) {
+        // Recreating the swapchain waits for the device, no frame in flight still samples the old pyramid
+        if (m_Image == VK_NULL_HANDLE || m_SwapChainGeneration != s_VulkanContext.SwapChainGeneration) {
+            DestroyImage();
+            CreateImage(command_buffer);
+            m_SwapChainGeneration = s_VulkanContext.SwapChainGeneration;
+            m_HasPreviousDepth = false;
+        }
+
+        m_Valid = m_HasPreviousDepth;
+        if (m_Valid) {
+            // Depth written by the previous frame (resolves are color attachment writes), pyramid sampled by its
+            // culling
+            VkImageMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+            barrier.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+            barrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = s_VulkanContext.ResolvedDepthImage;
+            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+            barrier.subresourceRange.baseMipLevel = 0;
+            barrier.subresourceRange.levelCount = 1;
+            barrier.subresourceRange.baseArrayLayer = 0;
+            barrier.subresourceRange.layerCount = 1;
+            if (s_VulkanContext.DepthFormat == VK_FORMAT_D32_SFLOAT_S8_UINT
+                || s_VulkanContext.DepthFormat == VK_FORMAT_D24_UNORM_S8_UINT)
+                barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+
+            vkCmdPipelineBarrier(command_buffer,
+                                 VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT
+                                     | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+                                     | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+            // First level from the depth
+            auto depth_set = m_DepthSetLayout->CreateFrameDescriptorSet(
+                ImageViewSampler{s_VulkanContext.ResolvedDepthImageView, m_Sampler}, m_LevelViews[0]);
+
+            m_DepthPipeline->Bind(command_buffer);
+            vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_DepthPipeline->GetLayout(), 0, 1,
+                                    &depth_set, 0, nullptr);
+            vkCmdDispatch(command_buffer, (m_Extent.width + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE,
+                          (m_Extent.height + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE, 1);
+
+            // Then each level from the one below
+            m_ReducePipeline->Bind(command_buffer);
+            for (uint32_t level = 1; level < m_LevelCount; level++) {
+                ComputeBarrier(command_buffer);
+
+                auto reduce_set = m_ReduceSetLayout->CreateFrameDescriptorSet(m_LevelViews[level - 1],
+                                                                              m_LevelViews[level]);
+                vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_ReducePipeline->GetLayout(),
+                                        0, 1, &reduce_set, 0, nullptr);
+
+                auto width = std::max(m_Extent.width >> level, 1u);
+                auto height = std::max(m_Extent.height >> level, 1u);
+                vkCmdDispatch(command_buffer, (width + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE,
+                              (height + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE, 1);
+            }
+
+            ComputeBarrier(command_buffer);
+        }
+
+        HiZData data{};
+        data.ViewProjection = m_PreviousViewProjection;
+        data.Size = glm::vec2(m_Extent.width, m_Extent.height);
+        data.LevelCount = m_LevelCount;
+        data.Valid = m_Valid;
+        m_Data->SetData(data);
+
+        m_SampleSet = m_SampleSetLayout->CreateFrameDescriptorSet(ImageViewSampler{m_ImageView, m_Sampler}, *m_Data);
+
+        // What this frame renders is reduced by the next one
+        m_PreviousViewProjection = FrameGlobals::GetData().ViewProjection;
+        m_HasPreviousDepth = true;
+    }
+
+    std::unique_ptr<HiZPyramid> HiZPyramid::CreateHiZPyramid() {
+        return std::make_unique<HiZPyramid>();
+    }
+} // namespace spock
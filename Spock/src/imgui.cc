@@ -90,8 +90,11 @@ namespace spock
         init_info.Queue = s_VulkanContext.GraphicsQueue;
         init_info.PipelineCache = nullptr;
         init_info.DescriptorPool = s_VulkanContext.DescriptorPool;
-        init_info.RenderPass = s_VulkanContext.RenderPass;
-        init_info.Subpass = 0;
+        init_info.UseDynamicRendering = true;
+        init_info.PipelineRenderingCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+        init_info.PipelineRenderingCreateInfo.colorAttachmentCount = 1;
+        init_info.PipelineRenderingCreateInfo.pColorAttachmentFormats = &s_VulkanContext.SwapChainImageFormat;
+        init_info.PipelineRenderingCreateInfo.depthAttachmentFormat = s_VulkanContext.DepthFormat;
         init_info.MinImageCount = MAX_FRAMES_IN_FLIGHT;
         init_info.ImageCount = MAX_FRAMES_IN_FLIGHT;
         init_info.MSAASamples = s_VulkanContext.MaxUsableSamples;
@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <stdexcept>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/descriptor_allocator.hh"
+#include "spock/frame_globals.hh"
+#include "spock/frustum.hh"
+#include "spock/indirect_scene.hh"
+#include "spock/pipeline.hh"
+#include "spock/vulkan.hh"
+#include "spock_shaders.hh"
+
+namespace spock
+{
+    // Matches the `Cull` push constants of the culling shader
+    struct CullConstants
+    {
+        std::array<glm::vec4, 6> Planes;
+        uint32_t ObjectCount;
+        uint32_t Padding[3];
+    };
+
+    static constexpr uint32_t CULL_GROUP_SIZE = 64;
+
+    static void GlobalBarrier(VkCommandBuffer command_buffer, VkPipelineStageFlags src_stage, VkAccessFlags src_access,
+                              VkPipelineStageFlags dst_stage, VkAccessFlags dst_access) {
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = src_access;
+        barrier.dstAccessMask = dst_access;
+
+        vkCmdPipelineBarrier(command_buffer, src_stage, dst_stage, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    bool IndirectScene::IsAvailable() {
+        return s_VulkanContext.Extensions.MultiDrawIndirect;
+    }
+
+    std::unique_ptr<IndirectScene> IndirectScene::CreateIndirectScene(uint32_t capacity) {
+        return std::make_unique<IndirectScene>(capacity);
+    }
+
+    IndirectScene::IndirectScene(uint32_t capacity)
+        : m_Capacity(std::max(capacity, 1u)) {
+        if (!IsAvailable()) {
+            throw std::runtime_error("multi draw indirect is not supported!");
+        }
+
+        m_CullSetLayout = CullSetLayout::CreateDescriptorSetLayout();
+        m_ObjectSetLayout = ObjectSetLayout::CreateDescriptorSetLayout();
+
+        PipelineConfig pipeline_config{};
+        pipeline_config.Stages.emplace_back(
+            PipelineStage::PipelineStageFromData(shaders::cull_comp, VK_SHADER_STAGE_COMPUTE_BIT));
+        pipeline_config.DescriptorSetLayouts = {m_CullSetLayout->GetDescriptorSetLayout()};
+        pipeline_config.PushConstants = {PushConstantRange<CullConstants>(VK_SHADER_STAGE_COMPUTE_BIT)};
+        m_CullPipeline = Pipeline::CreatePipeline(std::move(pipeline_config));
+
+        // Same bindings and constants, plus the pyramid at set 1
+        m_HiZSetLayout = HiZPyramid::SampleSetLayout::CreateDescriptorSetLayout();
+
+        PipelineConfig occlusion_config{};
+        occlusion_config.Stages.emplace_back(
+            PipelineStage::PipelineStageFromData(shaders::cull_occlusion_comp, VK_SHADER_STAGE_COMPUTE_BIT));
+        occlusion_config.DescriptorSetLayouts = {m_CullSetLayout->GetDescriptorSetLayout(),
+                                                 m_HiZSetLayout->GetDescriptorSetLayout()};
+        occlusion_config.PushConstants = {PushConstantRange<CullConstants>(VK_SHADER_STAGE_COMPUTE_BIT)};
+        m_OcclusionCullPipeline = Pipeline::CreatePipeline(std::move(occlusion_config));
+
+        // Device local, only the objects that changed are sent
+        m_ObjectData = ObjectBuffer::CreateObjectBuffer<IndirectObject>(m_Capacity);
+
+        auto object_descriptors = ObjectSetLayout::Pack(0, m_ObjectData->GetBuffer());
+        m_ObjectSet = DescriptorAllocator::GetCached(*m_ObjectSetLayout->GetLayout(), object_descriptors);
+
+        // Commands and count are written by the culling shader and read by the draw
+        VkDeviceSize commands_size = sizeof(VkDrawIndexedIndirectCommand) * m_Capacity;
+        for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            m_CommandBuffers[i] = Buffer::CreateBuffer(commands_size,
+                                                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+                                                           | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT
+                                                           | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            m_CountBuffers[i] = Buffer::CreateBuffer(sizeof(uint32_t),
+                                                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+                                                         | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT
+                                                         | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+            auto cull_descriptors =
+                CullSetLayout::Pack(i, m_ObjectData->GetBuffer(), *m_CommandBuffers[i], *m_CountBuffers[i]);
+            m_CullSets[i] = DescriptorAllocator::GetCached(*m_CullSetLayout->GetLayout(), cull_descriptors);
+        }
+    }
+
+    uint32_t IndirectScene::AddObject(const IndirectObject &object) {
+        if (m_ObjectCount >= m_Capacity) {
+            throw std::runtime_error("indirect scene is full!");
+        }
+
+        m_ObjectData->Set(m_ObjectCount, object);
+        return m_ObjectCount++;
+    }
+
+    void IndirectScene::SetObject(uint32_t index, const IndirectObject &object) {
+        if (index >= m_ObjectCount) {
+            throw std::out_of_range("invalid indirect scene object!");
+        }
+
+        m_ObjectData->Set(index, object);
+    }
+
+    void IndirectScene::Clear() {
+        m_ObjectCount = 0;
+    }
+
+    void IndirectScene::Cull(VkCommandBuffer command_buffer, const HiZPyramid *occlusion) {
+        auto frame_index = s_VulkanContext.CurrentFrame;
+        auto object_count = GetObjectCount();
+
+        // Objects changed since the previous frame, ready for the culling shader once recorded
+        m_ObjectData->Upload(command_buffer);
+
+        m_CulledCounts[frame_index] = object_count;
+        if (object_count == 0)
+            return;
+
+        // Without a draw count, the draw reads every command and culled ones must draw nothing
+        vkCmdFillBuffer(command_buffer, m_CountBuffers[frame_index]->GetBuffer(), 0, sizeof(uint32_t), 0);
+        if (!s_VulkanContext.Extensions.DrawIndirectCount) {
+            vkCmdFillBuffer(command_buffer, m_CommandBuffers[frame_index]->GetBuffer(), 0, VK_WHOLE_SIZE, 0);
+        }
+        GlobalBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+        CullConstants constants{};
+        constants.Planes = Frustum::FromMatrix(FrameGlobals::GetData().ViewProjection).Planes;
+        constants.ObjectCount = object_count;
+
+        const auto &pipeline = occlusion ? *m_OcclusionCullPipeline : *m_CullPipeline;
+        std::array<VkDescriptorSet, 2> sets = {m_CullSets[frame_index],
+                                               occlusion ? occlusion->GetDescriptorSet() : VK_NULL_HANDLE};
+
+        pipeline.Bind(command_buffer);
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.GetLayout(), 0,
+                                occlusion ? 2 : 1, sets.data(), 0, nullptr);
+        pipeline.Push(command_buffer, VK_SHADER_STAGE_COMPUTE_BIT, constants);
+        vkCmdDispatch(command_buffer, (object_count + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+        GlobalBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                      VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+    }
+
+    void IndirectScene::Bind(VkCommandBuffer command_buffer, VkPipelineLayout pipeline_layout, uint32_t set) const {
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, set, 1,
+                                &m_ObjectSet, 0, nullptr);
+    }
+
+    void IndirectScene::Draw(VkCommandBuffer command_buffer) const {
+        auto frame_index = s_VulkanContext.CurrentFrame;
+        auto max_draw_count = m_CulledCounts[frame_index];
+        if (max_draw_count == 0)
+            return;
+
+        if (s_VulkanContext.Extensions.DrawIndirectCount) {
+            vkCmdDrawIndexedIndirectCount(command_buffer, m_CommandBuffers[frame_index]->GetBuffer(), 0,
+                                          m_CountBuffers[frame_index]->GetBuffer(), 0, max_draw_count,
+                                          sizeof(VkDrawIndexedIndirectCommand));
+        } else {
+            vkCmdDrawIndexedIndirect(command_buffer, m_CommandBuffers[frame_index]->GetBuffer(), 0, max_draw_count,
+                                     sizeof(VkDrawIndexedIndirectCommand));
+        }
+    }
+} // namespace spock
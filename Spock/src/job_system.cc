@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "spock/job_system.hh"
+
+namespace spock
+{
+    class JobQueue {
+      public:
+        JobQueue() {
+            uint32_t worker_count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+            for (uint32_t i = 0; i < worker_count; i++) {
+                m_Workers.emplace_back([this]() { Work(); });
+            }
+        }
+
+        ~JobQueue() {
+            {
+                std::lock_guard lock(m_Mutex);
+                m_Stopping = true;
+            }
+            m_JobAvailable.notify_all();
+
+            for (auto &worker : m_Workers) {
+                worker.join();
+            }
+        }
+
+        void Push(std::function<void()> &&job) {
+            {
+                std::lock_guard lock(m_Mutex);
+                m_Jobs.emplace_back(std::move(job));
+            }
+            m_JobAvailable.notify_one();
+        }
+
+        uint32_t GetWorkerCount() const {
+            return static_cast<uint32_t>(m_Workers.size());
+        }
+
+      private:
+        void Work() {
+            while (true) {
+                std::function<void()> job;
+
+                {
+                    std::unique_lock lock(m_Mutex);
+                    m_JobAvailable.wait(lock, [this]() { return m_Stopping || !m_Jobs.empty(); });
+
+                    if (m_Stopping && m_Jobs.empty())
+                        return;
+
+                    job = std::move(m_Jobs.front());
+                    m_Jobs.pop_front();
+                }
+
+                job();
+            }
+        }
+
+      private:
+        std::vector<std::thread> m_Workers;
+        std::deque<std::function<void()>> m_Jobs;
+        std::mutex m_Mutex;
+        std::condition_variable m_JobAvailable;
+        bool m_Stopping = false;
+    };
+
+    static JobQueue &GetJobQueue() {
+        static JobQueue queue;
+        return queue;
+    }
+
+    void JobSystem::Enqueue(std::function<void()> &&job) {
+        GetJobQueue().Push(std::move(job));
+    }
+
+    uint32_t JobSystem::GetWorkerCount() {
+        return GetJobQueue().GetWorkerCount();
+    }
+
+    void JobSystem::ParallelFor(size_t count, size_t batch_size,
+                                const std::function<void(size_t begin, size_t end)> &job) {
+        if (count == 0)
+            return;
+
+        batch_size = std::max<size_t>(batch_size, 1);
+        size_t batch_count = (count + batch_size - 1) / batch_size;
+
+        if (batch_count == 1 || GetWorkerCount() == 0) {
+            job(0, count);
+            return;
+        }
+
+        struct State
+        {
+            std::atomic<size_t> NextBatch = 0;
+            std::atomic<size_t> DoneBatches = 0;
+            std::mutex Mutex;
+            std::condition_variable Finished;
+            // First exception thrown by a batch, guarded by `Mutex`
+            std::exception_ptr Error;
+        };
+        auto state = std::make_shared<State>();
+
+        // Helpers starting after every batch was taken return without touching `job`
+        auto run = [state, &job, count, batch_size, batch_count]() {
+            size_t batch;
+            while ((batch = state->NextBatch.fetch_add(1)) < batch_count) {
+                size_t begin = batch * batch_size;
+                try {
+                    job(begin, std::min(begin + batch_size, count));
+                } catch (...) {
+                    // A throwing worker would terminate, the batch still counts as done so the wait below ends
+                    std::lock_guard lock(state->Mutex);
+                    if (!state->Error)
+                        state->Error = std::current_exception();
+                }
+
+                if (state->DoneBatches.fetch_add(1) + 1 == batch_count) {
+                    std::lock_guard lock(state->Mutex);
+                    state->Finished.notify_all();
+                }
+            }
+        };
+
+        size_t helper_count = std::min<size_t>(GetWorkerCount(), batch_count - 1);
+        for (size_t i = 0; i < helper_count; i++) {
+            Enqueue(run);
+        }
+
+        run();
+
+        std::unique_lock lock(state->Mutex);
+        state->Finished.wait(lock, [&state, batch_count]() { return state->DoneBatches == batch_count; });
+
+        if (state->Error)
+            std::rethrow_exception(state->Error);
+    }
+} // namespace spock
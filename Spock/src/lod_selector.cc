@@ -0,0 +1,37 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "spock/frame_globals.hh"
+#include "spock/geometry_buffer.hh"
+#include "spock/lod_selector.hh"
+
+namespace spock
+{
+    // Closer than this every mesh is at full resolution, avoids dividing by zero inside the bounding sphere
+    static constexpr float MIN_LOD_DISTANCE = 1e-3f;
+
+    LodSelector::LodSelector(const FrameGlobalsData &frame, float threshold)
+        : m_CameraPosition(frame.CameraPosition)
+        , m_Threshold(threshold) {
+        // Perspective projection: the viewport half height spans `1 / proj[1][1]` units at a distance of one
+        m_ProjectionScale = frame.Viewport.y * 0.5f * std::abs(frame.Projection[1][1]);
+    }
+
+    uint32_t LodSelector::Select(const GeometryBuffer::Mesh &mesh, const glm::vec3 &center, float radius,
+                                 float scale) const {
+        // Nearest point of the bounding sphere, conservative for the whole mesh
+        auto distance = glm::length(center - m_CameraPosition) - radius;
+        if (distance < MIN_LOD_DISTANCE)
+            return 0;
+
+        // Errors only grow with the level
+        uint32_t lod = 0;
+        while (lod + 1 < mesh.LodCount && ProjectError(mesh.Lods[lod + 1].Error * scale, distance) <= m_Threshold) {
+            lod++;
+        }
+
+        return lod;
+    }
+} // namespace spock
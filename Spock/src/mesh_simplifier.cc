@@ -0,0 +1,344 @@
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "spock/mesh_simplifier.hh"
+
+namespace spock
+{
+    // Collapses whose triangles turn by more than this are rejected, cosine of about 80 degrees
+    static constexpr double MIN_NORMAL_COSINE = 0.17;
+
+    // A level is only kept when it drops at least this much of the previous one
+    static constexpr float MIN_LOD_REDUCTION = 0.1f;
+
+    void MeshSimplifier::Quadric::AddPlane(const glm::dvec3 &normal, double distance, double weight) {
+        A00 += weight * normal.x * normal.x;
+        A01 += weight * normal.x * normal.y;
+        A02 += weight * normal.x * normal.z;
+        A11 += weight * normal.y * normal.y;
+        A12 += weight * normal.y * normal.z;
+        A22 += weight * normal.z * normal.z;
+        B0 += weight * normal.x * distance;
+        B1 += weight * normal.y * distance;
+        B2 += weight * normal.z * distance;
+        C += weight * distance * distance;
+        Weight += weight;
+    }
+
+    void MeshSimplifier::Quadric::Add(const Quadric &other) {
+        A00 += other.A00;
+        A01 += other.A01;
+        A02 += other.A02;
+        A11 += other.A11;
+        A12 += other.A12;
+        A22 += other.A22;
+        B0 += other.B0;
+        B1 += other.B1;
+        B2 += other.B2;
+        C += other.C;
+        Weight += other.Weight;
+    }
+
+    double MeshSimplifier::Quadric::Evaluate(const glm::dvec3 &p) const {
+        if (Weight <= 0)
+            return 0;
+
+        // p^T A p + 2 b.p + c
+        auto error = A00 * p.x * p.x + A11 * p.y * p.y + A22 * p.z * p.z
+                   + 2 * (A01 * p.x * p.y + A02 * p.x * p.z + A12 * p.y * p.z)
+                   + 2 * (B0 * p.x + B1 * p.y + B2 * p.z) + C;
+
+        return std::max(error, 0.0) / Weight;
+    }
+
+    static glm::dvec3 TriangleNormal(const glm::dvec3 &p0, const glm::dvec3 &p1, const glm::dvec3 &p2) {
+        return glm::cross(p1 - p0, p2 - p0);
+    }
+
+    std::vector<uint32_t> MeshSimplifier::Simplify(std::span<const glm::vec3> positions,
+                                                   std::span<const uint32_t> indices, size_t target_index_count,
+                                                   float target_error, float &result_error) {
+        assert(indices.size() % 3 == 0 && "indices must form triangles");
+
+        result_error = 0.0f;
+        std::vector<uint32_t> triangles(indices.begin(), indices.end());
+        if (triangles.size() <= target_index_count)
+            return triangles;
+
+        auto vertex_count = static_cast<uint32_t>(positions.size());
+        auto position = [&positions](uint32_t vertex) {
+            return glm::dvec3(positions[vertex]);
+        };
+
+        // Vertices sharing a position are welded, topology and quadrics are tracked on the first one of each
+        std::vector<uint32_t> welded(vertex_count);
+        std::vector<uint32_t> weld_counts(vertex_count, 0);
+        {
+            std::vector<uint32_t> order(vertex_count);
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(), [&positions](uint32_t a, uint32_t b) {
+                const auto &pa = positions[a];
+                const auto &pb = positions[b];
+                return std::tie(pa.x, pa.y, pa.z, a) < std::tie(pb.x, pb.y, pb.z, b);
+            });
+
+            for (uint32_t i = 0; i < vertex_count; i++) {
+                auto vertex = order[i];
+                bool same = i > 0 && positions[order[i - 1]] == positions[vertex];
+                welded[vertex] = same ? welded[order[i - 1]] : vertex;
+                weld_counts[welded[vertex]]++;
+            }
+        }
+
+        // Every triangle adds its plane to its three vertices
+        std::vector<Quadric> quadrics(vertex_count);
+        for (size_t i = 0; i < triangles.size(); i += 3) {
+            auto v0 = welded[triangles[i]], v1 = welded[triangles[i + 1]], v2 = welded[triangles[i + 2]];
+            auto normal = TriangleNormal(position(v0), position(v1), position(v2));
+            auto length = glm::length(normal);
+            if (length == 0)
+                continue;
+
+            normal /= length;
+            auto distance = -glm::dot(normal, position(v0));
+            for (auto vertex : {v0, v1, v2}) {
+                quadrics[vertex].AddPlane(normal, distance, length * 0.5);
+            }
+        }
+
+        // Edges not shared by exactly two triangles are borders (or non manifold), their vertices stay in place
+        std::vector<bool> locked(vertex_count, false);
+        {
+            std::vector<std::pair<uint32_t, uint32_t>> edges;
+            edges.reserve(triangles.size());
+            for (size_t i = 0; i < triangles.size(); i += 3) {
+                for (uint32_t corner = 0; corner < 3; corner++) {
+                    auto a = welded[triangles[i + corner]];
+                    auto b = welded[triangles[i + (corner + 1) % 3]];
+                    edges.emplace_back(std::min(a, b), std::max(a, b));
+                }
+            }
+            std::sort(edges.begin(), edges.end());
+
+            for (size_t i = 0; i < edges.size();) {
+                auto end = i;
+                while (end < edges.size() && edges[end] == edges[i]) {
+                    end++;
+                }
+                if (end - i != 2) {
+                    locked[edges[i].first] = true;
+                    locked[edges[i].second] = true;
+                }
+                i = end;
+            }
+        }
+
+        // A collapse moves `u` onto `v`. Both must be their only copy so triangles can be rewritten in place, seams
+        // with several copies never move nor get collapsed onto.
+        auto movable = [&](uint32_t vertex) {
+            return !locked[vertex] && weld_counts[vertex] == 1;
+        };
+        auto target = [&](uint32_t vertex) {
+            return weld_counts[vertex] == 1;
+        };
+
+        struct Collapse
+        {
+            double Cost;
+            uint32_t From;
+            uint32_t To;
+        };
+
+        auto max_cost = static_cast<double>(target_error) * target_error;
+        auto triangle_count = triangles.size() / 3;
+        auto target_triangle_count = target_index_count / 3;
+
+        std::vector<uint32_t> adjacency_offsets(vertex_count + 1);
+        std::vector<uint32_t> adjacency;
+        std::vector<bool> dead;
+        std::vector<bool> touched(vertex_count);
+        std::vector<Collapse> collapses;
+        std::vector<uint32_t> neighbours, target_neighbours;
+        double applied_cost = 0;
+
+        // Independent collapses are applied in passes, the cheapest first, until none is left or the target is met
+        while (triangle_count > target_triangle_count) {
+            // Triangles around each vertex
+            std::fill(adjacency_offsets.begin(), adjacency_offsets.end(), 0);
+            for (auto vertex : triangles) {
+                adjacency_offsets[welded[vertex] + 1]++;
+            }
+            std::partial_sum(adjacency_offsets.begin(), adjacency_offsets.end(), adjacency_offsets.begin());
+            adjacency.resize(triangles.size());
+            {
+                auto cursors = adjacency_offsets;
+                for (size_t i = 0; i < triangles.size(); i++) {
+                    adjacency[cursors[welded[triangles[i]]]++] = static_cast<uint32_t>(i / 3);
+                }
+            }
+            auto vertex_triangles = [&](uint32_t vertex) {
+                return std::span<const uint32_t>(adjacency.data() + adjacency_offsets[vertex],
+                                                 adjacency_offsets[vertex + 1] - adjacency_offsets[vertex]);
+            };
+            auto collect_neighbours = [&](uint32_t vertex, std::vector<uint32_t> &result) {
+                result.clear();
+                for (auto triangle : vertex_triangles(vertex)) {
+                    for (uint32_t corner = 0; corner < 3; corner++) {
+                        auto other = welded[triangles[triangle * 3 + corner]];
+                        if (other != vertex)
+                            result.emplace_back(other);
+                    }
+                }
+                std::sort(result.begin(), result.end());
+                result.erase(std::unique(result.begin(), result.end()), result.end());
+            };
+
+            // The cheapest valid collapse of each movable vertex
+            collapses.clear();
+            for (uint32_t u = 0; u < vertex_count; u++) {
+                if (welded[u] != u || !movable(u) || vertex_triangles(u).empty())
+                    continue;
+
+                collect_neighbours(u, neighbours);
+
+                Collapse best{std::numeric_limits<double>::max(), u, u};
+                for (auto v : neighbours) {
+                    if (!target(v))
+                        continue;
+
+                    auto quadric = quadrics[u];
+                    quadric.Add(quadrics[v]);
+                    auto cost = quadric.Evaluate(position(v));
+                    if (cost >= best.Cost || cost > max_cost)
+                        continue;
+
+                    // Link condition: the only vertices both are connected to are those of their two triangles,
+                    // anything else would pinch the surface into non manifold edges
+                    collect_neighbours(v, target_neighbours);
+                    size_t shared = 0;
+                    for (auto neighbour : neighbours) {
+                        shared += std::binary_search(target_neighbours.begin(), target_neighbours.end(), neighbour);
+                    }
+                    if (shared != 2)
+                        continue;
+
+                    // Remaining triangles must not flip nor degenerate
+                    bool valid = true;
+                    for (auto triangle : vertex_triangles(u)) {
+                        std::array<glm::dvec3, 3> before, after;
+                        bool has_v = false;
+                        for (uint32_t corner = 0; corner < 3; corner++) {
+                            auto vertex = welded[triangles[triangle * 3 + corner]];
+                            has_v |= vertex == v;
+                            before[corner] = position(vertex);
+                            after[corner] = vertex == u ? position(v) : before[corner];
+                        }
+                        if (has_v)
+                            continue;
+
+                        auto normal_before = TriangleNormal(before[0], before[1], before[2]);
+                        auto normal_after = TriangleNormal(after[0], after[1], after[2]);
+                        auto lengths = glm::length(normal_before) * glm::length(normal_after);
+                        if (lengths == 0 || glm::dot(normal_before, normal_after) < MIN_NORMAL_COSINE * lengths) {
+                            valid = false;
+                            break;
+                        }
+                    }
+
+                    if (valid)
+                        best = Collapse{cost, u, v};
+                }
+
+                if (best.To != u)
+                    collapses.emplace_back(best);
+            }
+
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b) {
+                return a.Cost < b.Cost;
+            });
+
+            // Collapses only change the triangles around `From`, their vertices sit out the rest of the pass
+            dead.assign(triangles.size() / 3, false);
+            std::fill(touched.begin(), touched.end(), false);
+            size_t applied = 0;
+            for (const auto &collapse : collapses) {
+                if (triangle_count <= target_triangle_count)
+                    break;
+                if (touched[collapse.From] || touched[collapse.To])
+                    continue;
+
+                for (auto triangle : vertex_triangles(collapse.From)) {
+                    bool has_to = false;
+                    for (uint32_t corner = 0; corner < 3; corner++) {
+                        auto &vertex = triangles[triangle * 3 + corner];
+                        touched[welded[vertex]] = true;
+                        has_to |= vertex == collapse.To;
+                        if (vertex == collapse.From)
+                            vertex = collapse.To;
+                    }
+
+                    if (has_to) {
+                        dead[triangle] = true;
+                        triangle_count--;
+                    }
+                }
+
+                quadrics[collapse.To].Add(quadrics[collapse.From]);
+                applied_cost = std::max(applied_cost, collapse.Cost);
+                applied++;
+            }
+
+            if (applied == 0)
+                break;
+
+            // Drop the triangles collapsed away
+            size_t write = 0;
+            for (size_t triangle = 0; triangle < dead.size(); triangle++) {
+                if (dead[triangle])
+                    continue;
+                for (uint32_t corner = 0; corner < 3; corner++) {
+                    triangles[write++] = triangles[triangle * 3 + corner];
+                }
+            }
+            triangles.resize(write);
+        }
+
+        result_error = static_cast<float>(std::sqrt(applied_cost));
+        return triangles;
+    }
+
+    std::vector<LodLevel> MeshSimplifier::GenerateLods(std::span<const glm::vec3> positions,
+                                                       std::span<const uint32_t> indices, uint32_t max_lods,
+                                                       float reduction) {
+        std::vector<LodLevel> lods;
+        lods.emplace_back(LodLevel{std::vector<uint32_t>(indices.begin(), indices.end()), 0.0f});
+
+        // Each level is simplified from the previous one, errors add up
+        while (lods.size() < max_lods) {
+            const auto &previous = lods.back();
+            auto target_index_count = static_cast<size_t>(previous.Indices.size() / 3 * reduction) * 3;
+
+            float error;
+            auto simplified = Simplify(positions, previous.Indices, target_index_count,
+                                       std::numeric_limits<float>::max(), error);
+            if (simplified.empty()
+                || simplified.size() > previous.Indices.size() * (1.0f - MIN_LOD_REDUCTION))
+                break;
+
+            auto lod_error = previous.Error + error;
+            lods.emplace_back(LodLevel{std::move(simplified), lod_error});
+        }
+
+        return lods;
+    }
+} // namespace spock
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/object_buffer.hh"
+#include "spock/pipeline.hh"
+#include "spock/vulkan.hh"
+#include "spock_shaders.hh"
+
+namespace spock
+{
+    // Matches the `Scatter` push constants of the scatter shader
+    struct ScatterConstants
+    {
+        uint32_t WordCount;
+        uint32_t ObjectWords;
+    };
+
+    static constexpr uint32_t SCATTER_GROUP_SIZE = 64;
+    // Objects the delta buffers hold at first
+    static constexpr uint32_t MIN_DELTA_CAPACITY = 64;
+
+    std::unique_ptr<ObjectBuffer> ObjectBuffer::CreateObjectBuffer(uint32_t object_size, uint32_t capacity,
+                                                                   VkBufferUsageFlags usage) {
+        return std::make_unique<ObjectBuffer>(object_size, capacity, usage);
+    }
+
+    ObjectBuffer::ObjectBuffer(uint32_t object_size, uint32_t capacity, VkBufferUsageFlags usage)
+        : m_ObjectSize(object_size)
+        , m_Capacity(std::max(capacity, 1u)) {
+        if (object_size == 0 || object_size % sizeof(uint32_t) != 0) {
+            throw std::invalid_argument("object size must be a multiple of 4 bytes!");
+        }
+
+        m_Objects.resize(static_cast<size_t>(m_Capacity) * m_ObjectSize);
+        m_Dirty.resize(m_Capacity);
+
+        m_Buffer = Buffer::CreateBuffer(static_cast<VkDeviceSize>(m_Capacity) * m_ObjectSize,
+                                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | usage,
+                                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        m_ScatterSetLayout = ScatterSetLayout::CreateDescriptorSetLayout();
+
+        PipelineConfig pipeline_config{};
+        pipeline_config.Stages.emplace_back(
+            PipelineStage::PipelineStageFromData(shaders::scatter_comp, VK_SHADER_STAGE_COMPUTE_BIT));
+        pipeline_config.DescriptorSetLayouts = {m_ScatterSetLayout->GetDescriptorSetLayout()};
+        pipeline_config.PushConstants = {PushConstantRange<ScatterConstants>(VK_SHADER_STAGE_COMPUTE_BIT)};
+        m_ScatterPipeline = Pipeline::CreatePipeline(std::move(pipeline_config));
+
+        for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            ReserveDelta(i, std::min(m_Capacity, MIN_DELTA_CAPACITY));
+        }
+    }
+
+    void ObjectBuffer::ReserveDelta(uint32_t frame_index, uint32_t count) {
+        if (count <= m_DeltaCapacities[frame_index])
+            return;
+
+        // The previous submission of this frame is done, its buffers can be replaced
+        auto capacity = std::min(std::max(count, m_DeltaCapacities[frame_index] * 2), m_Capacity);
+        m_DeltaIndices[frame_index] =
+            Buffer::CreateBuffer(sizeof(uint32_t) * capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        m_DeltaData[frame_index] =
+            Buffer::CreateBuffer(static_cast<VkDeviceSize>(m_ObjectSize) * capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        m_DeltaIndices[frame_index]->Map();
+        m_DeltaData[frame_index]->Map();
+        m_DeltaCapacities[frame_index] = capacity;
+    }
+
+    void ObjectBuffer::Set(uint32_t index, const void *data) {
+        if (index >= m_Capacity) {
+            throw std::out_of_range("object buffer is full!");
+        }
+
+        memcpy(m_Objects.data() + static_cast<size_t>(index) * m_ObjectSize, data, m_ObjectSize);
+        if (!m_Dirty[index]) {
+            m_Dirty[index] = 1;
+            m_DirtyIndices.emplace_back(index);
+        }
+    }
+
+    void ObjectBuffer::Upload(VkCommandBuffer command_buffer) {
+        auto frame_index = s_VulkanContext.CurrentFrame;
+        auto count = static_cast<uint32_t>(m_DirtyIndices.size());
+
+        m_UploadedCount = count;
+        m_UploadedSize = static_cast<VkDeviceSize>(count) * (m_ObjectSize + sizeof(uint32_t));
+        if (count == 0)
+            return;
+
+        // Host coherent writes are visible once submitted
+        ReserveDelta(frame_index, count);
+        auto *indices = static_cast<uint32_t *>(m_DeltaIndices[frame_index]->Map());
+        auto *data = static_cast<std::byte *>(m_DeltaData[frame_index]->Map());
+        for (uint32_t i = 0; i < count; i++) {
+            auto index = m_DirtyIndices[i];
+            indices[i] = index;
+            memcpy(data + static_cast<size_t>(i) * m_ObjectSize,
+                   m_Objects.data() + static_cast<size_t>(index) * m_ObjectSize, m_ObjectSize);
+            m_Dirty[index] = 0;
+        }
+        m_DirtyIndices.clear();
+
+        // Previous frames may still read the objects being replaced
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = 0;
+        vkCmdPipelineBarrier(command_buffer,
+                             VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        ScatterConstants constants{};
+        constants.ObjectWords = m_ObjectSize / sizeof(uint32_t);
+        constants.WordCount = count * constants.ObjectWords;
+
+        auto descriptor_set = m_ScatterSetLayout->CreateFrameDescriptorSet(*m_Buffer, *m_DeltaIndices[frame_index],
+                                                                           *m_DeltaData[frame_index]);
+
+        m_ScatterPipeline->Bind(command_buffer);
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_ScatterPipeline->GetLayout(), 0, 1,
+                                &descriptor_set, 0, nullptr);
+        m_ScatterPipeline->Push(command_buffer, VK_SHADER_STAGE_COMPUTE_BIT, constants);
+        vkCmdDispatch(command_buffer, (constants.WordCount + SCATTER_GROUP_SIZE - 1) / SCATTER_GROUP_SIZE, 1, 1);
+
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1,
+                             &barrier, 0, nullptr, 0, nullptr);
+    }
+} // namespace spock
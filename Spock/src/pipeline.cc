@@ -1,87 +1,118 @@
 #include <cassert>
 #include <cstdint>
-#include <fstream>
 #include <memory>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 #include <vulkan/vulkan_core.h>
 
+#include "spock/frame_globals.hh"
 #include "spock/pipeline.hh"
+#include "spock/shader_compiler.hh"
 #include "spock/vulkan.hh"
 
 namespace spock
 {
-    PipelineStage::PipelineStage(VkShaderModule shader_module, VkPipelineShaderStageCreateInfo shader_stage_create_info)
-        : m_ShaderModule(shader_module)
-        , m_ShaderStage(shader_stage_create_info) {
+    PipelineStage::PipelineStage(std::shared_ptr<ShaderModule> shader_module, VkShaderStageFlagBits stage)
+        : m_ShaderModule(std::move(shader_module))
+        , m_ShaderStage{} {
+        m_ShaderStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        m_ShaderStage.stage = stage;
+        m_ShaderStage.module = m_ShaderModule->GetShaderModule();
+        m_ShaderStage.pName = "main";
     }
 
-    PipelineStage::~PipelineStage() {
-        if (m_ShaderModule != VK_NULL_HANDLE)
-            vkDestroyShaderModule(s_VulkanContext.Device, m_ShaderModule, nullptr);
+    PipelineStage::PipelineStage(PipelineStage &&other) noexcept
+        : m_ShaderModule(std::move(other.m_ShaderModule))
+        , m_ShaderStage(other.m_ShaderStage)
+        , m_SpecializationData(std::move(other.m_SpecializationData))
+        , m_SpecializationEntries(std::move(other.m_SpecializationEntries))
+        , m_SpecializationInfo(other.m_SpecializationInfo) {
     }
 
-    PipelineStage::PipelineStage(PipelineStage &&other) noexcept
-        : m_ShaderModule(other.m_ShaderModule)
-        , m_ShaderStage(other.m_ShaderStage) {
-        // Set the shader module to null to avoid freeing it in the destructor
-        other.m_ShaderModule = VK_NULL_HANDLE;
+    VkShaderCreateInfoEXT PipelineStage::GetShaderCreateInfo(VkShaderStageFlags next_stage) const {
+        VkShaderCreateInfoEXT shaderInfo{};
+        shaderInfo.sType = VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT;
+        shaderInfo.stage = m_ShaderStage.stage;
+        shaderInfo.nextStage = next_stage;
+        shaderInfo.codeType = VK_SHADER_CODE_TYPE_SPIRV_EXT;
+        shaderInfo.codeSize = m_ShaderModule->GetCode().size() * sizeof(uint32_t);
+        shaderInfo.pCode = m_ShaderModule->GetCode().data();
+        shaderInfo.pName = m_ShaderStage.pName;
+        shaderInfo.pSpecializationInfo = GetShaderStage().pSpecializationInfo;
+
+        return shaderInfo;
     }
 
     PipelineStage PipelineStage::PipelineStageFromData(const uint32_t *code, size_t size, VkShaderStageFlagBits stage) {
-        VkShaderModuleCreateInfo createInfo{};
-        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        createInfo.codeSize = size;
-        createInfo.pCode = code;
-
-        VkShaderModule shaderModule;
-        if (vkCreateShaderModule(s_VulkanContext.Device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create shader module!");
-        }
-
-        VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-        vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        vertShaderStageInfo.stage = stage;
-        vertShaderStageInfo.module = shaderModule;
-        vertShaderStageInfo.pName = "main";
+        return PipelineStage{ShaderModule::FromData(code, size), stage};
+    }
 
-        return PipelineStage{shaderModule, vertShaderStageInfo};
+    PipelineStage PipelineStage::PipelineStageFromData(std::span<const uint32_t> code, VkShaderStageFlagBits stage) {
+        return PipelineStage{ShaderModule::FromStaticData(code), stage};
     }
 
     PipelineStage PipelineStage::PipelineStageFromFile(const std::string &path, VkShaderStageFlagBits stage) {
-        std::ifstream file(path, std::ios::ate | std::ios::binary);
+        return PipelineStage{ShaderModule::FromFile(path), stage};
+    }
 
-        if (!file.is_open()) {
-            throw std::runtime_error("failed to open file!");
-        }
+    PipelineStage PipelineStage::PipelineStageFromGLSL(const std::string &path, VkShaderStageFlagBits stage,
+                                                       const ShaderDefines &defines) {
+        auto code = ShaderCompiler::CompileFile(path, stage, defines);
+        return PipelineStage{ShaderModule::FromData(code.data(), code.size() * sizeof(uint32_t)), stage};
+    }
 
-        size_t file_size = (size_t)file.tellg();
-        std::vector<char> shader_code(file_size);
+    // The set layouts of the pipeline layout, `FrameGlobals` first when used
+    static std::vector<VkDescriptorSetLayout> GetSetLayouts(const PipelineConfig &pipeline_config) {
+        std::vector<VkDescriptorSetLayout> set_layouts;
+        if (pipeline_config.UseFrameGlobals)
+            set_layouts.emplace_back(FrameGlobals::GetDescriptorSetLayout());
 
-        file.seekg(0);
-        file.read(shader_code.data(), file_size);
+        set_layouts.insert(set_layouts.end(), pipeline_config.DescriptorSetLayouts.begin(),
+                           pipeline_config.DescriptorSetLayouts.end());
+        return set_layouts;
+    }
 
-        file.close();
+    static VkPipelineLayout CreatePipelineLayout(const PipelineConfig &pipeline_config) {
+        auto set_layouts = GetSetLayouts(pipeline_config);
 
-        VkShaderModuleCreateInfo createInfo{};
-        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        createInfo.codeSize = shader_code.size();
-        createInfo.pCode = reinterpret_cast<const uint32_t *>(shader_code.data());
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = set_layouts.size();
+        pipelineLayoutInfo.pSetLayouts = set_layouts.data();
+        pipelineLayoutInfo.pushConstantRangeCount = pipeline_config.PushConstants.size();
+        pipelineLayoutInfo.pPushConstantRanges = pipeline_config.PushConstants.data();
 
-        VkShaderModule shaderModule;
-        if (vkCreateShaderModule(s_VulkanContext.Device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create shader module!");
+        VkPipelineLayout pipeline_layout;
+        if (vkCreatePipelineLayout(s_VulkanContext.Device, &pipelineLayoutInfo, nullptr, &pipeline_layout)
+            != VK_SUCCESS) {
+            throw std::runtime_error("failed to create pipeline layout!");
         }
 
-        VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-        vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        vertShaderStageInfo.stage = stage;
-        vertShaderStageInfo.module = shaderModule;
-        vertShaderStageInfo.pName = "main";
-
-        return PipelineStage{shaderModule, vertShaderStageInfo};
+        return pipeline_layout;
     }
 
     std::unique_ptr<Pipeline> Pipeline::CreatePipeline(PipelineConfig &&pipeline_config) {
+        if (pipeline_config.UseFrameGlobals && pipeline_config.UseDescriptorBuffers) {
+            throw std::invalid_argument("frame globals cannot be used with descriptor buffers!");
+        }
+
+        VkPipelineLayout pipeline_layout = CreatePipelineLayout(pipeline_config);
+
+        if (pipeline_config.Stages.size() == 1 && pipeline_config.Stages[0].GetStage() == VK_SHADER_STAGE_COMPUTE_BIT) {
+            auto pipeline = CreateComputePipeline(pipeline_config, pipeline_layout);
+            pipeline->m_PushConstantRanges = pipeline_config.PushConstants;
+            pipeline->m_UsesFrameGlobals = pipeline_config.UseFrameGlobals;
+            return pipeline;
+        }
+
+        if (pipeline_config.UseShaderObjects && s_VulkanContext.Extensions.ShaderObject) {
+            auto pipeline = CreateShaderObjects(pipeline_config, pipeline_layout);
+            pipeline->m_PushConstantRanges = pipeline_config.PushConstants;
+            pipeline->m_UsesFrameGlobals = pipeline_config.UseFrameGlobals;
+            return pipeline;
+        }
+
         VkViewport viewport{};
         viewport.x = 0.0f;
         viewport.y = 0.0f;
@@ -111,8 +142,9 @@ namespace spock
         // Binding descriptions
         VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
         vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vertexInputInfo.vertexBindingDescriptionCount = 1;
-        vertexInputInfo.pVertexBindingDescriptions = &pipeline_config.BindingDescription;
+        vertexInputInfo.vertexBindingDescriptionCount =
+            static_cast<uint32_t>(pipeline_config.BindingDescriptions.size());
+        vertexInputInfo.pVertexBindingDescriptions = pipeline_config.BindingDescriptions.data();
         vertexInputInfo.vertexAttributeDescriptionCount =
             static_cast<uint32_t>(pipeline_config.AttributeDescriptions.size());
         vertexInputInfo.pVertexAttributeDescriptions = pipeline_config.AttributeDescriptions.data();
@@ -169,21 +201,17 @@ namespace spock
         dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
         dynamicState.pDynamicStates = dynamicStates.data();
 
-        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipelineLayoutInfo.setLayoutCount = pipeline_config.DescriptorSetLayouts.size();
-        pipelineLayoutInfo.pSetLayouts = pipeline_config.DescriptorSetLayouts.data();
-        pipelineLayoutInfo.pushConstantRangeCount = pipeline_config.PushConstants.size();
-        pipelineLayoutInfo.pPushConstantRanges = pipeline_config.PushConstants.data();
-
-        VkPipelineLayout pipeline_layout;
-        if (vkCreatePipelineLayout(s_VulkanContext.Device, &pipelineLayoutInfo, nullptr, &pipeline_layout)
-            != VK_SUCCESS) {
-            throw std::runtime_error("failed to create pipeline layout!");
-        }
+        // Rendering happens with dynamic rendering, describe the attachments instead of a render pass
+        VkPipelineRenderingCreateInfo renderingInfo{};
+        renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+        renderingInfo.colorAttachmentCount = 1;
+        renderingInfo.pColorAttachmentFormats = &s_VulkanContext.SwapChainImageFormat;
+        renderingInfo.depthAttachmentFormat = s_VulkanContext.DepthFormat;
 
         VkGraphicsPipelineCreateInfo pipelineInfo{};
         pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        pipelineInfo.pNext = &renderingInfo;
+        pipelineInfo.flags = pipeline_config.UseDescriptorBuffers ? VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT : 0;
         pipelineInfo.stageCount = pipelineStages.size();
         pipelineInfo.pStages = pipelineStages.data();
         pipelineInfo.pVertexInputState = &vertexInputInfo;
@@ -195,7 +223,7 @@ namespace spock
         pipelineInfo.pColorBlendState = &colorBlending;
         pipelineInfo.pDynamicState = &dynamicState;
         pipelineInfo.layout = pipeline_layout;
-        pipelineInfo.renderPass = s_VulkanContext.RenderPass;
+        pipelineInfo.renderPass = VK_NULL_HANDLE;
         pipelineInfo.subpass = 0;
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
@@ -206,11 +234,177 @@ namespace spock
             throw std::runtime_error("failed to create graphics pipeline!");
         }
 
-        return std::make_unique<Pipeline>(graphics_pipeline, pipeline_layout);
+        auto pipeline = std::make_unique<Pipeline>(graphics_pipeline, pipeline_layout);
+        pipeline->m_PushConstantRanges = pipeline_config.PushConstants;
+        pipeline->m_UsesFrameGlobals = pipeline_config.UseFrameGlobals;
+        return pipeline;
+    }
+
+    std::unique_ptr<Pipeline> Pipeline::CreateComputePipeline(PipelineConfig &pipeline_config,
+                                                              VkPipelineLayout pipeline_layout) {
+        VkComputePipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage = pipeline_config.Stages[0].GetShaderStage();
+        pipelineInfo.layout = pipeline_layout;
+        pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+        VkPipeline compute_pipeline;
+        if (vkCreateComputePipelines(s_VulkanContext.Device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr,
+                                     &compute_pipeline)
+            != VK_SUCCESS) {
+            vkDestroyPipelineLayout(s_VulkanContext.Device, pipeline_layout, nullptr);
+            throw std::runtime_error("failed to create compute pipeline!");
+        }
+
+        auto pipeline = std::make_unique<Pipeline>(compute_pipeline, pipeline_layout);
+        pipeline->m_BindPoint = VK_PIPELINE_BIND_POINT_COMPUTE;
+        return pipeline;
+    }
+
+    std::unique_ptr<Pipeline> Pipeline::CreateShaderObjects(PipelineConfig &pipeline_config,
+                                                            VkPipelineLayout pipeline_layout) {
+        // Every stage may be followed by any later graphics stage of the config
+        VkShaderStageFlags all_stages = 0;
+        for (const auto &s : pipeline_config.Stages) {
+            all_stages |= s.GetStage();
+        }
+
+        auto set_layouts = GetSetLayouts(pipeline_config);
+
+        std::vector<VkShaderCreateInfoEXT> shaderInfos{};
+        shaderInfos.reserve(pipeline_config.Stages.size());
+        for (const auto &s : pipeline_config.Stages) {
+            VkShaderStageFlags next_stages = all_stages & ~((s.GetStage() << 1) - 1);
+            auto &shaderInfo = shaderInfos.emplace_back(s.GetShaderCreateInfo(next_stages));
+            shaderInfo.flags = pipeline_config.Stages.size() > 1 ? VK_SHADER_CREATE_LINK_STAGE_BIT_EXT : 0;
+            shaderInfo.setLayoutCount = set_layouts.size();
+            shaderInfo.pSetLayouts = set_layouts.data();
+            shaderInfo.pushConstantRangeCount = pipeline_config.PushConstants.size();
+            shaderInfo.pPushConstantRanges = pipeline_config.PushConstants.data();
+        }
+
+        std::vector<VkShaderEXT> shaders(shaderInfos.size(), VK_NULL_HANDLE);
+        if (s_VulkanContext.Extensions.CreateShadersEXT(s_VulkanContext.Device, shaderInfos.size(),
+                                                        shaderInfos.data(), nullptr, shaders.data())
+            != VK_SUCCESS) {
+            vkDestroyPipelineLayout(s_VulkanContext.Device, pipeline_layout, nullptr);
+            throw std::runtime_error("failed to create shader objects!");
+        }
+
+        auto pipeline = std::make_unique<Pipeline>(VK_NULL_HANDLE, pipeline_layout);
+        pipeline->m_Shaders = std::move(shaders);
+        pipeline->m_Topology = pipeline_config.Topology;
+
+        for (const auto &s : pipeline_config.Stages) {
+            pipeline->m_ShaderStages.emplace_back(s.GetStage());
+        }
+
+        // Unused graphics stages are bound to VK_NULL_HANDLE, otherwise whatever an earlier pipeline left there stays
+        for (auto stage : {VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT, VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT,
+                           VK_SHADER_STAGE_GEOMETRY_BIT}) {
+            if ((all_stages & stage) == 0) {
+                pipeline->m_ShaderStages.emplace_back(stage);
+                pipeline->m_Shaders.emplace_back(VK_NULL_HANDLE);
+            }
+        }
+
+        // Vertex input is dynamic too, keep the descriptions in the extended format
+        for (const auto &binding : pipeline_config.BindingDescriptions) {
+            auto &vertexBinding = pipeline->m_VertexBindings.emplace_back();
+            vertexBinding.sType = VK_STRUCTURE_TYPE_VERTEX_INPUT_BINDING_DESCRIPTION_2_EXT;
+            vertexBinding.binding = binding.binding;
+            vertexBinding.stride = binding.stride;
+            vertexBinding.inputRate = binding.inputRate;
+            vertexBinding.divisor = 1;
+        }
+
+        for (const auto &attribute : pipeline_config.AttributeDescriptions) {
+            auto &vertexAttribute = pipeline->m_VertexAttributes.emplace_back();
+            vertexAttribute.sType = VK_STRUCTURE_TYPE_VERTEX_INPUT_ATTRIBUTE_DESCRIPTION_2_EXT;
+            vertexAttribute.location = attribute.location;
+            vertexAttribute.binding = attribute.binding;
+            vertexAttribute.format = attribute.format;
+            vertexAttribute.offset = attribute.offset;
+        }
+
+        return pipeline;
+    }
+
+    void Pipeline::SetDynamicState(VkCommandBuffer command_buffer) const {
+        const auto &ext = s_VulkanContext.Extensions;
+
+        VkViewport viewport{};
+        viewport.x = 0.0f;
+        viewport.y = 0.0f;
+        viewport.width = static_cast<float>(s_VulkanContext.SwapChainExtent.width);
+        viewport.height = static_cast<float>(s_VulkanContext.SwapChainExtent.height);
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+        vkCmdSetViewportWithCount(command_buffer, 1, &viewport);
+
+        VkRect2D scissor{};
+        scissor.offset = {0, 0};
+        scissor.extent = s_VulkanContext.SwapChainExtent;
+        vkCmdSetScissorWithCount(command_buffer, 1, &scissor);
+
+        // Vertex input and input assembly
+        ext.CmdSetVertexInputEXT(command_buffer, m_VertexBindings.size(), m_VertexBindings.data(),
+                                 m_VertexAttributes.size(), m_VertexAttributes.data());
+        vkCmdSetPrimitiveTopology(command_buffer, m_Topology);
+        vkCmdSetPrimitiveRestartEnable(command_buffer, VK_FALSE);
+
+        // Rasterization, matches the pipeline defaults
+        vkCmdSetRasterizerDiscardEnable(command_buffer, VK_FALSE);
+        ext.CmdSetPolygonModeEXT(command_buffer, VK_POLYGON_MODE_FILL);
+        vkCmdSetCullMode(command_buffer, VK_CULL_MODE_BACK_BIT);
+        vkCmdSetFrontFace(command_buffer, VK_FRONT_FACE_COUNTER_CLOCKWISE);
+        vkCmdSetDepthBiasEnable(command_buffer, VK_FALSE);
+        // Required whenever shader objects draw, even for non-line topologies
+        vkCmdSetLineWidth(command_buffer, 1.0f);
+
+        // Multisampling
+        VkSampleMask sampleMask[2] = {~0u, ~0u};
+        ext.CmdSetRasterizationSamplesEXT(command_buffer, s_VulkanContext.MaxUsableSamples);
+        ext.CmdSetSampleMaskEXT(command_buffer, s_VulkanContext.MaxUsableSamples, sampleMask);
+        ext.CmdSetAlphaToCoverageEnableEXT(command_buffer, VK_FALSE);
+
+        // Depth and stencil
+        vkCmdSetDepthTestEnable(command_buffer, VK_TRUE);
+        vkCmdSetDepthWriteEnable(command_buffer, VK_TRUE);
+        vkCmdSetDepthCompareOp(command_buffer, VK_COMPARE_OP_LESS);
+        vkCmdSetDepthBoundsTestEnable(command_buffer, VK_FALSE);
+        vkCmdSetStencilTestEnable(command_buffer, VK_FALSE);
+
+        // Color blending
+        VkBool32 blendEnable = VK_TRUE;
+        ext.CmdSetColorBlendEnableEXT(command_buffer, 0, 1, &blendEnable);
+
+        VkColorBlendEquationEXT blendEquation{};
+        blendEquation.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        blendEquation.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        blendEquation.colorBlendOp = VK_BLEND_OP_ADD;
+        blendEquation.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        blendEquation.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        blendEquation.alphaBlendOp = VK_BLEND_OP_ADD;
+        ext.CmdSetColorBlendEquationEXT(command_buffer, 0, 1, &blendEquation);
+
+        VkColorComponentFlags writeMask =
+            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+        ext.CmdSetColorWriteMaskEXT(command_buffer, 0, 1, &writeMask);
     }
 
     void Pipeline::Bind(VkCommandBuffer command_buffer) const {
-        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Pipeline);
+        if (UsesShaderObjects()) {
+            s_VulkanContext.Extensions.CmdBindShadersEXT(command_buffer, m_Shaders.size(), m_ShaderStages.data(),
+                                                         m_Shaders.data());
+            SetDynamicState(command_buffer);
+        } else {
+            vkCmdBindPipeline(command_buffer, m_BindPoint, m_Pipeline);
+        }
+
+        // Once per pipeline rather than per draw, every draw of the pipeline shares it
+        if (m_UsesFrameGlobals)
+            FrameGlobals::Bind(command_buffer, m_PipelineLayout, m_BindPoint);
     }
 
     Pipeline::Pipeline(VkPipeline pipeline, VkPipelineLayout pipeline_layout)
@@ -219,7 +413,13 @@ namespace spock
     }
 
     Pipeline::~Pipeline() {
-        vkDestroyPipeline(s_VulkanContext.Device, m_Pipeline, nullptr);
+        for (auto shader : m_Shaders) {
+            if (shader != VK_NULL_HANDLE)
+                s_VulkanContext.Extensions.DestroyShaderEXT(s_VulkanContext.Device, shader, nullptr);
+        }
+
+        if (m_Pipeline != VK_NULL_HANDLE)
+            vkDestroyPipeline(s_VulkanContext.Device, m_Pipeline, nullptr);
         vkDestroyPipelineLayout(s_VulkanContext.Device, m_PipelineLayout, nullptr);
     }
 } // namespace spock
@@ -0,0 +1,66 @@
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+
+#include "spock/range_allocator.hh"
+
+namespace spock
+{
+    RangeAllocator::RangeAllocator(uint32_t capacity)
+        : m_Capacity(capacity)
+        , m_FreeSize(capacity) {
+        if (capacity > 0)
+            m_FreeRanges.emplace(0, capacity);
+    }
+
+    uint32_t RangeAllocator::Allocate(uint32_t size) {
+        if (size == 0)
+            return INVALID_OFFSET;
+
+        for (auto it = m_FreeRanges.begin(); it != m_FreeRanges.end(); it++) {
+            auto [offset, range_size] = *it;
+            if (range_size < size)
+                continue;
+
+            // Keep the tail of the range free
+            m_FreeRanges.erase(it);
+            if (range_size > size)
+                m_FreeRanges.emplace(offset + size, range_size - size);
+
+            m_FreeSize -= size;
+            return offset;
+        }
+
+        return INVALID_OFFSET;
+    }
+
+    void RangeAllocator::Free(uint32_t offset, uint32_t size) {
+        if (size == 0)
+            return;
+
+        assert(offset + size <= m_Capacity && "range outside of the allocator");
+        m_FreeSize += size;
+
+        auto next = m_FreeRanges.lower_bound(offset);
+        assert((next == m_FreeRanges.end() || offset + size <= next->first) && "range freed twice");
+
+        // Merge with the free range right after
+        if (next != m_FreeRanges.end() && offset + size == next->first) {
+            size += next->second;
+            next = m_FreeRanges.erase(next);
+        }
+
+        // And with the one right before
+        if (next != m_FreeRanges.begin()) {
+            auto previous = std::prev(next);
+            assert(previous->first + previous->second <= offset && "range freed twice");
+
+            if (previous->first + previous->second == offset) {
+                previous->second += size;
+                return;
+            }
+        }
+
+        m_FreeRanges.emplace_hint(next, offset, size);
+    }
+} // namespace spock
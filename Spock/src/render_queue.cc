@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/command_recorder.hh"
+#include "spock/pipeline.hh"
+#include "spock/render_queue.hh"
+
+namespace spock
+{
+    uint16_t RenderQueue::GetId(std::unordered_map<uint64_t, uint16_t> &ids, uint64_t handle) {
+        // Ids only order packets, start over rather than overflow
+        if (ids.size() > UINT16_MAX)
+            ids.clear();
+
+        return ids.try_emplace(handle, static_cast<uint16_t>(ids.size())).first->second;
+    }
+
+    uint64_t RenderQueue::MakeSortKey(uint8_t pass, const Pipeline &pipeline, VkDescriptorSet material, float depth) {
+        // Non-dispatchable handles are 64-bit integers rather than pointers on 32-bit platforms
+        return PackSortKey(pass, GetId(m_PipelineIds, reinterpret_cast<uintptr_t>(&pipeline)),
+                           GetId(m_MaterialIds, reinterpret_cast<uint64_t>(material)), QuantizeDepth(depth));
+    }
+
+    void RenderQueue::Submit(const DrawPacket &packet) {
+        m_Entries.emplace_back(SortEntry{packet.SortKey, static_cast<uint32_t>(m_Packets.size())});
+        m_Packets.emplace_back(packet);
+    }
+
+    void RenderQueue::RadixSort(std::vector<SortEntry> &entries, std::vector<SortEntry> &scratch) {
+        if (entries.size() < 2)
+            return;
+
+        // Least significant byte first, each pass is stable
+        scratch.resize(entries.size());
+        for (uint32_t shift = 0; shift < 64; shift += 8) {
+            std::array<uint32_t, 256> offsets{};
+            for (const auto &entry : entries) {
+                offsets[(entry.Key >> shift) & 0xFF]++;
+            }
+
+            // Every key shares this byte, nothing would move
+            if (offsets[(entries[0].Key >> shift) & 0xFF] == entries.size())
+                continue;
+
+            uint32_t offset = 0;
+            for (auto &count : offsets) {
+                auto bucket_size = count;
+                count = offset;
+                offset += bucket_size;
+            }
+
+            for (const auto &entry : entries) {
+                scratch[offsets[(entry.Key >> shift) & 0xFF]++] = entry;
+            }
+            entries.swap(scratch);
+        }
+    }
+
+    void RenderQueue::Flush(CommandRecorder &recorder) {
+        m_PacketCount = static_cast<uint32_t>(m_Packets.size());
+
+        RadixSort(m_Entries, m_Scratch);
+
+        // Neighbours share most of their state, the recorder drops what is already bound
+        for (const auto &entry : m_Entries) {
+            const auto &packet = m_Packets[entry.Index];
+
+            recorder.BindPipeline(*packet.DrawPipeline);
+
+            if (packet.MaterialSet != VK_NULL_HANDLE)
+                recorder.BindDescriptorSet(packet.MaterialSetIndex, packet.MaterialSet);
+
+            auto vertex_buffer_count = static_cast<size_t>(
+                std::find(packet.VertexBuffers.begin(), packet.VertexBuffers.end(), VK_NULL_HANDLE)
+                - packet.VertexBuffers.begin());
+            if (vertex_buffer_count > 0)
+                recorder.BindVertexBuffers(0, std::span(packet.VertexBuffers.data(), vertex_buffer_count));
+
+            if (packet.PushSize > 0)
+                recorder.PushConstants(packet.PushStages, 0, packet.PushSize, packet.PushData.data());
+
+            if (packet.IndexBuffer != VK_NULL_HANDLE) {
+                recorder.BindIndexBuffer(packet.IndexBuffer);
+                recorder.DrawIndexed(packet.Count, packet.InstanceCount, packet.First, packet.VertexOffset,
+                                     packet.FirstInstance);
+            } else {
+                recorder.Draw(packet.Count, packet.InstanceCount, packet.First, packet.FirstInstance);
+            }
+        }
+
+        // Ids only have to be stable within a frame, a destroyed pipeline's address may be reused by the next one
+        m_Packets.clear();
+        m_Entries.clear();
+        m_PipelineIds.clear();
+        m_MaterialIds.clear();
+    }
+} // namespace spock
@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/hash.hh"
+#include "spock/sampler.hh"
+#include "spock/vulkan.hh"
+
+namespace spock
+{
+    size_t SamplerDescription::GetHash() const {
+        size_t hash = 0;
+
+        HashCombine(hash, MagFilter);
+        HashCombine(hash, MinFilter);
+        HashCombine(hash, MipmapMode);
+        HashCombine(hash, AddressModeU);
+        HashCombine(hash, AddressModeV);
+        HashCombine(hash, AddressModeW);
+        HashCombine(hash, BorderColor);
+        HashCombine(hash, MaxAnisotropy);
+        HashCombine(hash, MipLodBias);
+        HashCombine(hash, MinLod);
+        HashCombine(hash, MaxLod);
+        HashCombine(hash, CompareEnable);
+        HashCombine(hash, CompareOp);
+
+        return hash;
+    }
+
+    VkSampler Sampler::Get(const SamplerDescription &description) {
+        auto &cache = s_VulkanContext.Samplers;
+
+        auto it = cache.find(description);
+        if (it != cache.end())
+            return it->second;
+
+        float max_anisotropy =
+            std::min(description.MaxAnisotropy, s_VulkanContext.PhysicalDeviceProperties.limits.maxSamplerAnisotropy);
+
+        VkSamplerCreateInfo samplerInfo{};
+        samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter = description.MagFilter;
+        samplerInfo.minFilter = description.MinFilter;
+        samplerInfo.addressModeU = description.AddressModeU;
+        samplerInfo.addressModeV = description.AddressModeV;
+        samplerInfo.addressModeW = description.AddressModeW;
+        samplerInfo.anisotropyEnable = max_anisotropy > 1.0f ? VK_TRUE : VK_FALSE;
+        samplerInfo.maxAnisotropy = std::max(max_anisotropy, 1.0f);
+        samplerInfo.borderColor = description.BorderColor;
+        samplerInfo.unnormalizedCoordinates = VK_FALSE;
+        samplerInfo.compareEnable = description.CompareEnable ? VK_TRUE : VK_FALSE;
+        samplerInfo.compareOp = description.CompareOp;
+        samplerInfo.mipmapMode = description.MipmapMode;
+        samplerInfo.mipLodBias = description.MipLodBias;
+        samplerInfo.minLod = description.MinLod;
+        samplerInfo.maxLod = description.MaxLod;
+
+        VkSampler sampler;
+        if (vkCreateSampler(s_VulkanContext.Device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create texture sampler!");
+        }
+
+        cache.emplace(description, sampler);
+        return sampler;
+    }
+
+    uint32_t Sampler::GetCount() {
+        return static_cast<uint32_t>(s_VulkanContext.Samplers.size());
+    }
+
+    void Sampler::Clear() {
+        for (const auto &[description, sampler] : s_VulkanContext.Samplers) {
+            vkDestroySampler(s_VulkanContext.Device, sampler, nullptr);
+        }
+
+        s_VulkanContext.Samplers.clear();
+    }
+} // namespace spock
@@ -0,0 +1,283 @@
+#ifdef SPOCK_SHADERC
+#include <shaderc/shaderc.hpp>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/hash.hh"
+#include "spock/job_system.hh"
+#include "spock/shader_compiler.hh"
+#include "spock/shader_module.hh"
+#include "spock/vulkan.hh"
+
+namespace spock
+{
+    // Bump when the way shaders are compiled changes, invalidates every cached binary
+    static constexpr uint32_t SHADER_CACHE_VERSION = 2;
+
+    // The compiler build, set by CMake from the Vulkan SDK version and the shaderc library
+#if defined(SPOCK_SHADERC) && defined(SPOCK_SHADERC_VERSION)
+    static constexpr const char *SHADERC_VERSION = SPOCK_SHADERC_VERSION;
+#else
+    static constexpr const char *SHADERC_VERSION = "unknown";
+#endif
+
+#ifdef SPOCK_SHADERC
+    static shaderc_shader_kind GetShaderKind(VkShaderStageFlagBits stage) {
+        switch (stage) {
+        case VK_SHADER_STAGE_VERTEX_BIT:
+            return shaderc_glsl_vertex_shader;
+        case VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT:
+            return shaderc_glsl_tess_control_shader;
+        case VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT:
+            return shaderc_glsl_tess_evaluation_shader;
+        case VK_SHADER_STAGE_GEOMETRY_BIT:
+            return shaderc_glsl_geometry_shader;
+        case VK_SHADER_STAGE_FRAGMENT_BIT:
+            return shaderc_glsl_fragment_shader;
+        case VK_SHADER_STAGE_COMPUTE_BIT:
+            return shaderc_glsl_compute_shader;
+        default:
+            throw std::invalid_argument("unsupported shader stage!");
+        }
+    }
+#endif
+
+    static bool ReadFile(const std::string &path, std::string &content) {
+        std::ifstream file(path);
+        if (!file.is_open())
+            return false;
+
+        std::stringstream stream;
+        stream << file.rdbuf();
+        content = stream.str();
+        return true;
+    }
+
+    // Includes are relative to the including file, the shader directory for the top level source
+    static std::string ResolveInclude(const std::string &requested, const std::string &requesting) {
+        return (std::filesystem::path(requesting).parent_path() / requested).lexically_normal().string();
+    }
+
+    // Hashes the path and content of every file `source` includes, recursively. Includes in disabled branches are
+    // hashed too, which at worst costs a needless recompilation.
+    static uint64_t HashIncludes(const std::string &source, const std::string &name, uint64_t seed,
+                                 std::vector<std::string> &visited) {
+        std::istringstream lines(source);
+        std::string line;
+        while (std::getline(lines, line)) {
+            auto directive = line.find_first_not_of(" \t");
+            if (directive == std::string::npos || line[directive] != '#')
+                continue;
+
+            auto keyword = line.find_first_not_of(" \t", directive + 1);
+            if (keyword == std::string::npos || line.compare(keyword, 7, "include") != 0)
+                continue;
+
+            auto open = line.find_first_of("\"<", keyword + 7);
+            if (open == std::string::npos)
+                continue;
+
+            auto close = line.find(line[open] == '"' ? '"' : '>', open + 1);
+            if (close == std::string::npos)
+                continue;
+
+            auto path = ResolveInclude(line.substr(open + 1, close - open - 1), name);
+            if (std::find(visited.begin(), visited.end(), path) != visited.end())
+                continue;
+            visited.emplace_back(path);
+
+            // Missing files are reported by the compiler
+            std::string content;
+            if (!ReadFile(path, content))
+                continue;
+
+            seed = HashBytes(path.data(), path.size(), seed);
+            seed = HashBytes(content.data(), content.size(), seed);
+            seed = HashIncludes(content, path, seed, visited);
+        }
+
+        return seed;
+    }
+
+#ifdef SPOCK_SHADERC
+    // Resolves `#include` with `ResolveInclude`, the same files `HashIncludes` keyed the cache on
+    class ShaderIncluder : public shaderc::CompileOptions::IncluderInterface {
+      public:
+        shaderc_include_result *GetInclude(const char *requested_source, shaderc_include_type,
+                                           const char *requesting_source, size_t) override {
+            auto include = new Include();
+            include->Path = ResolveInclude(requested_source, requesting_source);
+            if (!ReadFile(include->Path, include->Content)) {
+                // An empty source name tells shaderc the content is the error message
+                include->Content = fmt::format("failed to open {}!", include->Path);
+                include->Path.clear();
+            }
+
+            include->Result.source_name = include->Path.data();
+            include->Result.source_name_length = include->Path.size();
+            include->Result.content = include->Content.data();
+            include->Result.content_length = include->Content.size();
+            include->Result.user_data = include;
+            return &include->Result;
+        }
+
+        void ReleaseInclude(shaderc_include_result *data) override {
+            delete static_cast<Include *>(data->user_data);
+        }
+
+      private:
+        struct Include
+        {
+            std::string Path;
+            std::string Content;
+            shaderc_include_result Result;
+        };
+    };
+#endif
+
+    static uint64_t GetCacheKey(const std::string &source, const std::string &name, VkShaderStageFlagBits stage,
+                                const ShaderDefines &defines) {
+        // Defines order does not matter to the compiler
+        ShaderDefines sorted_defines = defines;
+        std::sort(sorted_defines.begin(), sorted_defines.end());
+
+        // The SPIR-V version is the default target, not the compiler version
+        uint32_t spirv_version = 0, spirv_revision = 0;
+#ifdef SPOCK_SHADERC
+        shaderc_get_spv_version(&spirv_version, &spirv_revision);
+#endif
+
+        std::string key = fmt::format("{}:{}:{}:{}:{}:{}\n", SHADER_CACHE_VERSION, SHADERC_VERSION, spirv_version,
+                                      spirv_revision, static_cast<uint32_t>(stage),
+                                      s_VulkanContext.Settings.ApiVersion);
+        for (const auto &[name, value] : sorted_defines) {
+            key += fmt::format("{}={}\n", name, value);
+        }
+
+        std::vector<std::string> visited;
+        return HashIncludes(source, name, HashBytes(source.data(), source.size(), HashBytes(key.data(), key.size())),
+                            visited);
+    }
+
+    static std::filesystem::path GetCachePath(uint64_t key) {
+        const char *directory = s_VulkanContext.Settings.ShaderCacheDirectory;
+        if (directory == nullptr || directory[0] == '\0')
+            return {};
+
+        return std::filesystem::path(directory) / fmt::format("{:016x}.spv", key);
+    }
+
+    static bool ReadCachedShader(const std::filesystem::path &path, std::vector<uint32_t> &code) {
+        std::ifstream file(path, std::ios::ate | std::ios::binary);
+        if (!file.is_open())
+            return false;
+
+        size_t file_size = (size_t)file.tellg();
+        if (file_size == 0 || file_size % sizeof(uint32_t) != 0)
+            return false;
+
+        code.resize(file_size / sizeof(uint32_t));
+        file.seekg(0);
+        file.read(reinterpret_cast<char *>(code.data()), file_size);
+
+        // Truncated or foreign files are compiled again and overwritten
+        return file.good() && code[0] == SPIRV_MAGIC;
+    }
+
+    static void WriteCachedShader(const std::filesystem::path &path, const std::vector<uint32_t> &code) {
+        std::error_code error;
+        std::filesystem::create_directories(path.parent_path(), error);
+
+        // Write next to the final file and rename, concurrent compilations of the same shader are harmless
+        auto temporary_path = path;
+        temporary_path += fmt::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+        {
+            std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+                return;
+
+            file.write(reinterpret_cast<const char *>(code.data()), code.size() * sizeof(uint32_t));
+        }
+
+        std::filesystem::rename(temporary_path, path, error);
+        if (error)
+            std::filesystem::remove(temporary_path, error);
+    }
+
+    bool ShaderCompiler::IsAvailable() {
+#ifdef SPOCK_SHADERC
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    std::vector<uint32_t> ShaderCompiler::Compile(const std::string &source, const std::string &name,
+                                                  VkShaderStageFlagBits stage, const ShaderDefines &defines) {
+        auto cache_path = GetCachePath(GetCacheKey(source, name, stage, defines));
+
+        std::vector<uint32_t> code;
+        if (!cache_path.empty() && ReadCachedShader(cache_path, code)) {
+            return code;
+        }
+
+#ifdef SPOCK_SHADERC
+        shaderc::CompileOptions options;
+        options.SetOptimizationLevel(shaderc_optimization_level_performance);
+        options.SetTargetEnvironment(shaderc_target_env_vulkan, s_VulkanContext.Settings.ApiVersion);
+        for (const auto &[define, value] : defines) {
+            options.AddMacroDefinition(define, value);
+        }
+        options.SetIncluder(std::make_unique<ShaderIncluder>());
+
+        // A compiler per compilation, these run concurrently on the job system
+        shaderc::Compiler compiler;
+        auto result = compiler.CompileGlslToSpv(source, GetShaderKind(stage), name.c_str(), options);
+
+        if (result.GetCompilationStatus() != shaderc_compilation_status_success) {
+            throw std::runtime_error(fmt::format("failed to compile shader {}!\n{}", name, result.GetErrorMessage()));
+        }
+
+        code.assign(result.cbegin(), result.cend());
+#else
+        throw std::runtime_error(fmt::format("failed to compile shader {}, spock was built without shaderc!", name));
+#endif
+
+        if (!cache_path.empty()) {
+            WriteCachedShader(cache_path, code);
+        }
+
+        return code;
+    }
+
+    std::vector<uint32_t> ShaderCompiler::CompileFile(const std::string &path, VkShaderStageFlagBits stage,
+                                                      const ShaderDefines &defines) {
+        std::string source;
+        if (!ReadFile(path, source)) {
+            throw std::runtime_error("failed to open file!");
+        }
+
+        return Compile(source, path, stage, defines);
+    }
+
+    std::future<std::vector<uint32_t>> ShaderCompiler::CompileFileAsync(const std::string &path,
+                                                                        VkShaderStageFlagBits stage,
+                                                                        const ShaderDefines &defines) {
+        return JobSystem::Submit([path, stage, defines]() { return CompileFile(path, stage, defines); });
+    }
+} // namespace spock
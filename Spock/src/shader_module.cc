@@ -0,0 +1,222 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/hash.hh"
+#include "spock/shader_module.hh"
+#include "spock/vulkan.hh"
+
+namespace spock
+{
+    ShaderModule::ShaderModule(VkShaderModule shader_module, std::span<const uint32_t> code,
+                               std::vector<uint32_t> &&owned_code, uint64_t hash)
+        : m_ShaderModule(shader_module)
+        , m_OwnedCode(std::move(owned_code))
+        , m_Code(m_OwnedCode.empty() ? code : std::span<const uint32_t>(m_OwnedCode))
+        , m_Hash(hash) {
+    }
+
+    ShaderModule::~ShaderModule() {
+        {
+            std::lock_guard lock(s_VulkanContext.ShaderModules.Mutex);
+            s_VulkanContext.ShaderModules.Alive.erase(this);
+        }
+
+        Release();
+    }
+
+    void ShaderModule::Release() {
+        if (m_ShaderModule == VK_NULL_HANDLE)
+            return;
+
+        vkDestroyShaderModule(s_VulkanContext.Device, m_ShaderModule, nullptr);
+        m_ShaderModule = VK_NULL_HANDLE;
+    }
+
+    std::shared_ptr<ShaderModule> ShaderModule::Find(std::span<const uint32_t> code, uint64_t hash) {
+        auto &cache = s_VulkanContext.ShaderModules;
+
+        auto it = cache.Modules.find(hash);
+        if (it == cache.Modules.end()) {
+            return nullptr;
+        }
+
+        auto cached_code = it->second->GetCode();
+        if (cached_code.size() != code.size() || memcmp(cached_code.data(), code.data(), code.size_bytes()) != 0) {
+            return nullptr;
+        }
+
+        cache.Reused++;
+        return it->second;
+    }
+
+    std::shared_ptr<ShaderModule> ShaderModule::Create(std::span<const uint32_t> code,
+                                                       std::vector<uint32_t> &&owned_code, uint64_t hash) {
+        auto &cache = s_VulkanContext.ShaderModules;
+
+        VkShaderModuleCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        createInfo.codeSize = code.size_bytes();
+        createInfo.pCode = code.data();
+
+        VkShaderModule shaderModule;
+        if (vkCreateShaderModule(s_VulkanContext.Device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create shader module!");
+        }
+
+        auto shader_module = std::make_shared<ShaderModule>(shaderModule, code, std::move(owned_code), hash);
+        cache.Alive.insert(shader_module.get());
+        cache.Created++;
+
+        // On the (unlikely) hash collision the registered module stays, this one is only shared by its stages.
+        // Replacing it could destroy it here, with the registry locked.
+        cache.Modules.try_emplace(hash, shader_module);
+
+        return shader_module;
+    }
+
+    std::shared_ptr<ShaderModule> ShaderModule::FromData(const uint32_t *code, size_t size) {
+        std::span<const uint32_t> shader_code(code, size / sizeof(uint32_t));
+        uint64_t hash = HashBytes(code, size);
+
+        std::lock_guard lock(s_VulkanContext.ShaderModules.Mutex);
+        if (auto shader_module = Find(shader_code, hash)) {
+            return shader_module;
+        }
+
+        // Keep the SPIR-V around, shader objects are created from code and not from modules
+        return Create(shader_code, std::vector<uint32_t>(shader_code.begin(), shader_code.end()), hash);
+    }
+
+    std::shared_ptr<ShaderModule> ShaderModule::FromStaticData(std::span<const uint32_t> code) {
+        uint64_t hash = HashBytes(code.data(), code.size_bytes());
+
+        std::lock_guard lock(s_VulkanContext.ShaderModules.Mutex);
+        if (auto shader_module = Find(code, hash)) {
+            return shader_module;
+        }
+
+        return Create(code, {}, hash);
+    }
+
+    std::shared_ptr<ShaderModule> ShaderModule::FromFile(const std::string &path) {
+        auto &cache = s_VulkanContext.ShaderModules;
+
+        std::error_code error;
+        ShaderModuleFile loaded_file{};
+        loaded_file.WriteTime = std::filesystem::last_write_time(path, error);
+        if (!error)
+            loaded_file.Size = std::filesystem::file_size(path, error);
+        if (error) {
+            throw std::runtime_error("failed to open file!");
+        }
+
+        {
+            std::lock_guard lock(cache.Mutex);
+
+            auto it = cache.Files.find(path);
+            if (it != cache.Files.end() && it->second.WriteTime == loaded_file.WriteTime
+                && it->second.Size == loaded_file.Size) {
+                auto module_it = cache.Modules.find(it->second.Hash);
+                if (module_it != cache.Modules.end()) {
+                    cache.Reused++;
+                    return module_it->second;
+                }
+            }
+        }
+
+        // Read without holding the registry
+        std::ifstream file(path, std::ios::ate | std::ios::binary);
+
+        if (!file.is_open()) {
+            throw std::runtime_error("failed to open file!");
+        }
+
+        // Whole words only, the buffer is sized from them
+        size_t file_size = (size_t)file.tellg();
+        if (file_size == 0 || file_size % sizeof(uint32_t) != 0) {
+            throw std::runtime_error("invalid SPIR-V file!");
+        }
+
+        std::vector<uint32_t> shader_code(file_size / sizeof(uint32_t));
+
+        file.seekg(0);
+        file.read(reinterpret_cast<char *>(shader_code.data()), file_size);
+
+        if (!file.good() || shader_code[0] != SPIRV_MAGIC) {
+            throw std::runtime_error("invalid SPIR-V file!");
+        }
+
+        file.close();
+
+        loaded_file.Hash = HashBytes(shader_code.data(), file_size);
+
+        std::lock_guard lock(cache.Mutex);
+        auto shader_module = Find(shader_code, loaded_file.Hash);
+        if (!shader_module) {
+            shader_module = Create(shader_code, std::move(shader_code), loaded_file.Hash);
+        }
+        cache.Files[path] = loaded_file;
+
+        return shader_module;
+    }
+
+    void ShaderModule::Trim() {
+        auto &cache = s_VulkanContext.ShaderModules;
+
+        // Destroyed once the registry is unlocked, see `~ShaderModule`
+        std::vector<std::shared_ptr<ShaderModule>> unused;
+        {
+            std::lock_guard lock(cache.Mutex);
+
+            for (auto it = cache.Modules.begin(); it != cache.Modules.end();) {
+                if (it->second.use_count() == 1) {
+                    unused.emplace_back(std::move(it->second));
+                    it = cache.Modules.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            std::erase_if(cache.Files,
+                          [&cache](const auto &entry) { return !cache.Modules.contains(entry.second.Hash); });
+        }
+    }
+
+    void ShaderModule::Clear() {
+        auto &cache = s_VulkanContext.ShaderModules;
+
+        std::unordered_map<uint64_t, std::shared_ptr<ShaderModule>> modules;
+        {
+            std::lock_guard lock(cache.Mutex);
+
+            // Stages destroyed after the device only drop their reference
+            for (auto *shader_module : cache.Alive) {
+                shader_module->Release();
+            }
+
+            modules.swap(cache.Modules);
+            cache.Files.clear();
+            cache.Alive.clear();
+        }
+    }
+
+    ShaderModule::Statistics ShaderModule::GetStatistics() {
+        auto &cache = s_VulkanContext.ShaderModules;
+        std::lock_guard lock(cache.Mutex);
+
+        Statistics statistics{};
+        statistics.Created = cache.Created;
+        statistics.Reused = cache.Reused;
+        statistics.Cached = cache.Modules.size();
+
+        return statistics;
+    }
+} // namespace spock
@@ -5,6 +5,7 @@
 #include <vector>
 #include <vulkan/vulkan_core.h>
 
+#include "spock/descriptor_allocator.hh"
 #include "spock/spock.hh"
 #include "spock/vulkan.hh"
 #include "spock/window.hh"
@@ -137,85 +138,6 @@ namespace spock
         }
     }
 
-    void Spock::CreateRenderPass() {
-        VkAttachmentDescription colorAttachment{};
-        colorAttachment.format = s_VulkanContext.SwapChainImageFormat;
-        colorAttachment.samples = s_VulkanContext.MaxUsableSamples;
-        colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-        colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-        colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-        colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-        VkAttachmentReference colorAttachmentRef{};
-        colorAttachmentRef.attachment = 0;
-        colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-        VkAttachmentDescription depthAttachment{};
-        depthAttachment.format =
-            FindSupportedFormat(s_VulkanContext.PhysicalDevice,
-                                {VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
-                                VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
-        depthAttachment.samples = s_VulkanContext.MaxUsableSamples;
-        depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-        depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-        VkAttachmentReference depthAttachmentRef{};
-        depthAttachmentRef.attachment = 1;
-        depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-        VkAttachmentDescription colorAttachmentResolve{};
-        colorAttachmentResolve.format = s_VulkanContext.SwapChainImageFormat;
-        colorAttachmentResolve.samples = VK_SAMPLE_COUNT_1_BIT;
-        colorAttachmentResolve.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-        colorAttachmentResolve.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-        colorAttachmentResolve.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-        colorAttachmentResolve.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        colorAttachmentResolve.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        colorAttachmentResolve.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-        VkAttachmentReference colorAttachmentResolveRef{};
-        colorAttachmentResolveRef.attachment = 2;
-        colorAttachmentResolveRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-        VkSubpassDescription subpass{};
-        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-        subpass.colorAttachmentCount = 1;
-        subpass.pResolveAttachments = &colorAttachmentResolveRef;
-        subpass.pColorAttachments = &colorAttachmentRef;
-        subpass.pDepthStencilAttachment = &depthAttachmentRef;
-
-        VkSubpassDependency dependency{};
-        dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-        dependency.dstSubpass = 0;
-        dependency.srcStageMask =
-            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-        dependency.srcAccessMask = 0;
-        dependency.dstStageMask =
-            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-        dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
-        std::array<VkAttachmentDescription, 3> attachments = {colorAttachment, depthAttachment, colorAttachmentResolve};
-        VkRenderPassCreateInfo renderPassInfo{};
-        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-        renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-        renderPassInfo.pAttachments = attachments.data();
-        renderPassInfo.subpassCount = 1;
-        renderPassInfo.pSubpasses = &subpass;
-        renderPassInfo.dependencyCount = 1;
-        renderPassInfo.pDependencies = &dependency;
-
-        if (vkCreateRenderPass(s_VulkanContext.Device, &renderPassInfo, nullptr, &s_VulkanContext.RenderPass)
-            != VK_SUCCESS) {
-            throw std::runtime_error("failed to create render pass!");
-        }
-    }
-
     void Spock::CreateColorResources() {
         VkFormat colorFormat = s_VulkanContext.SwapChainImageFormat;
 
@@ -232,37 +154,47 @@ namespace spock
             FindSupportedFormat(s_VulkanContext.PhysicalDevice,
                                 {VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
                                 VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+        s_VulkanContext.DepthFormat = depthFormat;
+
+        // Sampled by compute when it is the one kept after rendering
+        bool multisampled = s_VulkanContext.MaxUsableSamples != VK_SAMPLE_COUNT_1_BIT;
+        VkImageUsageFlags depthUsage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        if (!multisampled)
+            depthUsage |= VK_IMAGE_USAGE_SAMPLED_BIT;
 
         CreateImage(s_VulkanContext.SwapChainExtent.width, s_VulkanContext.SwapChainExtent.height, 1, depthFormat,
-                    s_VulkanContext.MaxUsableSamples, VK_IMAGE_TILING_OPTIMAL,
-                    VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                    s_VulkanContext.DepthImage, s_VulkanContext.DepthImageMemory);
+                    s_VulkanContext.MaxUsableSamples, VK_IMAGE_TILING_OPTIMAL, depthUsage,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, s_VulkanContext.DepthImage, s_VulkanContext.DepthImageMemory);
         s_VulkanContext.DepthImageView =
             CreateImageView(s_VulkanContext.DepthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1);
-    }
 
-    void Spock::CreateFramebuffers() {
-        s_VulkanContext.SwapChainFramebuffers.resize(s_VulkanContext.SwapChainImageViews.size());
-
-        for (size_t i = 0; i < s_VulkanContext.SwapChainImageViews.size(); i++) {
-            std::array<VkImageView, 3> attachments = {s_VulkanContext.ColorImageView, s_VulkanContext.DepthImageView,
-                                                      s_VulkanContext.SwapChainImageViews[i]};
-
-            VkFramebufferCreateInfo framebufferInfo{};
-            framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-            framebufferInfo.renderPass = s_VulkanContext.RenderPass;
-            framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-            framebufferInfo.pAttachments = attachments.data();
-            framebufferInfo.width = s_VulkanContext.SwapChainExtent.width;
-            framebufferInfo.height = s_VulkanContext.SwapChainExtent.height;
-            framebufferInfo.layers = 1;
-
-            if (vkCreateFramebuffer(s_VulkanContext.Device, &framebufferInfo, nullptr,
-                                    &s_VulkanContext.SwapChainFramebuffers[i])
-                != VK_SUCCESS) {
-                throw std::runtime_error("failed to create framebuffer!");
-            }
+        if (!multisampled) {
+            s_VulkanContext.ResolvedDepthImage = s_VulkanContext.DepthImage;
+            s_VulkanContext.ResolvedDepthImageMemory = VK_NULL_HANDLE;
+            s_VulkanContext.ResolvedDepthImageView = s_VulkanContext.DepthImageView;
+            s_VulkanContext.DepthResolveMode = VK_RESOLVE_MODE_NONE;
+            return;
         }
+
+        // The farthest sample keeps occlusion tests conservative, the first one is always supported
+        VkPhysicalDeviceDepthStencilResolveProperties resolveProperties{};
+        resolveProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEPTH_STENCIL_RESOLVE_PROPERTIES;
+
+        VkPhysicalDeviceProperties2 properties{};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties.pNext = &resolveProperties;
+        vkGetPhysicalDeviceProperties2(s_VulkanContext.PhysicalDevice, &properties);
+        s_VulkanContext.DepthResolveMode = (resolveProperties.supportedDepthResolveModes & VK_RESOLVE_MODE_MAX_BIT)
+                                             ? VK_RESOLVE_MODE_MAX_BIT
+                                             : VK_RESOLVE_MODE_SAMPLE_ZERO_BIT;
+
+        CreateImage(s_VulkanContext.SwapChainExtent.width, s_VulkanContext.SwapChainExtent.height, 1, depthFormat,
+                    VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_TILING_OPTIMAL,
+                    VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, s_VulkanContext.ResolvedDepthImage,
+                    s_VulkanContext.ResolvedDepthImageMemory);
+        s_VulkanContext.ResolvedDepthImageView =
+            CreateImageView(s_VulkanContext.ResolvedDepthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1);
     }
 
     void Spock::CreateSyncObjects() {
@@ -292,6 +224,15 @@ namespace spock
     }
 
     void Spock::CleanupSwapchain() {
+        // Attachments may be sampled, e.g. by `HiZPyramid`
+        if (s_VulkanContext.ResolvedDepthImage != s_VulkanContext.DepthImage) {
+            DescriptorAllocator::Invalidate(s_VulkanContext.ResolvedDepthImageView);
+            vkDestroyImageView(s_VulkanContext.Device, s_VulkanContext.ResolvedDepthImageView, nullptr);
+            vkDestroyImage(s_VulkanContext.Device, s_VulkanContext.ResolvedDepthImage, nullptr);
+            vkFreeMemory(s_VulkanContext.Device, s_VulkanContext.ResolvedDepthImageMemory, nullptr);
+        }
+
+        DescriptorAllocator::Invalidate(s_VulkanContext.DepthImageView);
         vkDestroyImageView(s_VulkanContext.Device, s_VulkanContext.DepthImageView, nullptr);
         vkDestroyImage(s_VulkanContext.Device, s_VulkanContext.DepthImage, nullptr);
         vkFreeMemory(s_VulkanContext.Device, s_VulkanContext.DepthImageMemory, nullptr);
@@ -300,10 +241,6 @@ namespace spock
         vkDestroyImage(s_VulkanContext.Device, s_VulkanContext.ColorImage, nullptr);
         vkFreeMemory(s_VulkanContext.Device, s_VulkanContext.ColorImageMemory, nullptr);
 
-        for (auto framebuffer : s_VulkanContext.SwapChainFramebuffers) {
-            vkDestroyFramebuffer(s_VulkanContext.Device, framebuffer, nullptr);
-        }
-
         for (auto image_view : s_VulkanContext.SwapChainImageViews) {
             vkDestroyImageView(s_VulkanContext.Device, image_view, nullptr);
         }
@@ -327,7 +264,8 @@ namespace spock
         CreateImageViews();
         CreateColorResources();
         CreateDepthResources();
-        CreateFramebuffers();
+
+        s_VulkanContext.SwapChainGeneration++;
     }
 
     VkResult Spock::AcquireNextImage(uint32_t &image_index) {
@@ -393,6 +331,7 @@ namespace spock
         }
 
         s_VulkanContext.CurrentFrame = (s_VulkanContext.CurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+        s_VulkanContext.FrameNumber++;
 
         return result;
     }
@@ -6,13 +6,16 @@
 #include <cstring>
 #include <memory>
 
+#include "spock/bindless.hh"
+#include "spock/descriptor_allocator.hh"
+#include "spock/sampler.hh"
 #include "spock/spock.hh"
 #include "spock/texture.hh"
 #include "spock/vulkan.hh"
 
 namespace spock
 {
-    std::shared_ptr<Texture2D> Texture2D::FromFile(const std::string &path) {
+    std::shared_ptr<Texture2D> Texture2D::FromFile(const std::string &path, const SamplerDescription &sampler) {
         int width, height, channels;
         stbi_uc *pixels = stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
 
@@ -23,7 +26,7 @@ namespace spock
         auto mip_levels = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
 
         // Create the texture
-        auto texture = std::make_shared<Texture2D>(pixels, width, height, STBI_rgb_alpha, mip_levels);
+        auto texture = std::make_shared<Texture2D>(pixels, width, height, STBI_rgb_alpha, mip_levels, sampler);
 
         // Free the pixels
         stbi_image_free(pixels);
@@ -31,7 +34,8 @@ namespace spock
         return texture;
     }
 
-    Texture2D::Texture2D(uint8_t *data, int width, int height, int channels, int mip_levels)
+    Texture2D::Texture2D(uint8_t *data, int width, int height, int channels, int mip_levels,
+                         const SamplerDescription &sampler)
         : m_Width(width)
         , m_Height(height)
         , m_Channels(channels)
@@ -39,7 +43,8 @@ namespace spock
         , m_TextureImage(nullptr)
         , m_TextureImageMemory(nullptr)
         , m_TextureImageView(nullptr)
-        , m_TextureSampler(nullptr) {
+        , m_TextureSampler(Sampler::Get(sampler))
+        , m_BindlessIndex(BindlessTextures::INVALID_INDEX) {
         VkBuffer stagingBuffer;
         VkDeviceMemory stagingBufferMemory;
 
@@ -70,7 +75,10 @@ namespace spock
 
         GenerateMipmaps(m_TextureImage, VK_FORMAT_R8G8B8A8_SRGB, width, height, m_MipLevels);
         CreateTextureImageView();
-        CreateTextureSampler();
+
+        if (BindlessTextures::IsAvailable()) {
+            m_BindlessIndex = BindlessTextures::Register(m_TextureImageView, m_TextureSampler);
+        }
     }
 
     static VkFormatProperties GetPhysicalDeviceFormatProperties(VkFormat format) {
@@ -160,32 +168,10 @@ namespace spock
             Spock::CreateImageView(m_TextureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, m_MipLevels);
     }
 
-    void Texture2D::CreateTextureSampler() {
-        VkPhysicalDeviceProperties properties = s_VulkanContext.PhysicalDeviceProperties;
-
-        VkSamplerCreateInfo samplerInfo{};
-        samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-        samplerInfo.magFilter = VK_FILTER_LINEAR;
-        samplerInfo.minFilter = VK_FILTER_LINEAR;
-        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-        samplerInfo.anisotropyEnable = VK_TRUE;
-        samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
-        samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
-        samplerInfo.unnormalizedCoordinates = VK_FALSE;
-        samplerInfo.compareEnable = VK_FALSE;
-        samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-        samplerInfo.maxLod = static_cast<float>(m_MipLevels);
-
-        if (vkCreateSampler(s_VulkanContext.Device, &samplerInfo, nullptr, &m_TextureSampler) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create texture sampler!");
-        }
-    }
-
     Texture2D::~Texture2D() {
-        vkDestroySampler(s_VulkanContext.Device, m_TextureSampler, nullptr);
+        BindlessTextures::Unregister(m_BindlessIndex);
+
+        DescriptorAllocator::Invalidate(m_TextureImageView);
         vkDestroyImageView(s_VulkanContext.Device, m_TextureImageView, nullptr);
         vkDestroyImage(s_VulkanContext.Device, m_TextureImage, nullptr);
         vkFreeMemory(s_VulkanContext.Device, m_TextureImageMemory, nullptr);
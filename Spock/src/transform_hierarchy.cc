@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "spock/job_system.hh"
+#include "spock/transform_hierarchy.hh"
+
+namespace spock
+{
+    // Nodes per job, levels smaller than this are updated on the calling thread
+    static constexpr size_t TRANSFORM_BATCH_SIZE = 4096;
+
+    uint32_t TransformHierarchy::AddNode(uint32_t parent, const glm::mat4 &local, uint32_t object) {
+        if (parent != INVALID_NODE && parent >= GetNodeCount()) {
+            throw std::out_of_range("invalid transform parent!");
+        }
+
+        auto parent_index = parent == INVALID_NODE ? INVALID_NODE : m_Indices[parent];
+        auto depth = parent == INVALID_NODE ? 0 : m_Depths[parent_index] + 1;
+        auto handle = GetNodeCount();
+
+        // Appending keeps the arrays sorted as long as nodes come level by level
+        if (!m_Depths.empty() && depth < m_Depths.back())
+            m_Unsorted = true;
+
+        m_Local.emplace_back(local);
+        m_World.emplace_back(local);
+        m_Parents.emplace_back(parent_index);
+        m_Depths.emplace_back(depth);
+        m_Objects.emplace_back(object);
+        m_Handles.emplace_back(handle);
+        m_Dirty.emplace_back(1);
+        m_Indices.emplace_back(static_cast<uint32_t>(m_Local.size() - 1));
+        m_AnyDirty = true;
+        m_DirtyLevel = std::min(m_DirtyLevel, depth);
+
+        // Either the last level grows or a new one starts
+        if (!m_Unsorted) {
+            auto end = static_cast<uint32_t>(m_Local.size());
+            if (m_LevelStarts.empty())
+                m_LevelStarts.emplace_back(0);
+            if (depth + 1 == m_LevelStarts.size())
+                m_LevelStarts.emplace_back(end);
+            else
+                m_LevelStarts.back() = end;
+        }
+
+        return handle;
+    }
+
+    void TransformHierarchy::Reserve(size_t count) {
+        m_Local.reserve(count);
+        m_World.reserve(count);
+        m_Parents.reserve(count);
+        m_Depths.reserve(count);
+        m_Objects.reserve(count);
+        m_Handles.reserve(count);
+        m_Dirty.reserve(count);
+        m_Indices.reserve(count);
+    }
+
+    void TransformHierarchy::Clear() {
+        m_Local.clear();
+        m_World.clear();
+        m_Parents.clear();
+        m_Depths.clear();
+        m_Objects.clear();
+        m_Handles.clear();
+        m_Dirty.clear();
+        m_Indices.clear();
+        m_LevelStarts.clear();
+        m_ChangedIndices.clear();
+        m_ChangedNodes.clear();
+        m_Unsorted = false;
+        m_AnyDirty = false;
+        m_DirtyLevel = UINT32_MAX;
+    }
+
+    void TransformHierarchy::SetLocal(uint32_t node, const glm::mat4 &local) {
+        auto index = m_Indices.at(node);
+        m_Local[index] = local;
+        m_Dirty[index] = 1;
+        m_AnyDirty = true;
+        m_DirtyLevel = std::min(m_DirtyLevel, m_Depths[index]);
+    }
+
+    void TransformHierarchy::Sort() {
+        auto node_count = GetNodeCount();
+        auto level_count = *std::max_element(m_Depths.begin(), m_Depths.end()) + 1;
+
+        // Counting sort by depth, stable so siblings stay in the order they were added
+        m_LevelStarts.assign(level_count + 1, 0);
+        for (auto depth : m_Depths) {
+            m_LevelStarts[depth + 1]++;
+        }
+        for (uint32_t level = 0; level < level_count; level++) {
+            m_LevelStarts[level + 1] += m_LevelStarts[level];
+        }
+
+        std::vector<uint32_t> new_indices(node_count);
+        auto next = m_LevelStarts;
+        for (uint32_t i = 0; i < node_count; i++) {
+            new_indices[i] = next[m_Depths[i]]++;
+        }
+
+        auto permute = [&new_indices](auto &array) {
+            std::remove_reference_t<decltype(array)> sorted(array.size());
+            for (size_t i = 0; i < array.size(); i++) {
+                sorted[new_indices[i]] = array[i];
+            }
+            array.swap(sorted);
+        };
+
+        for (auto &parent : m_Parents) {
+            if (parent != INVALID_NODE)
+                parent = new_indices[parent];
+        }
+
+        permute(m_Local);
+        permute(m_World);
+        permute(m_Parents);
+        permute(m_Depths);
+        permute(m_Objects);
+        permute(m_Handles);
+        permute(m_Dirty);
+
+        for (uint32_t i = 0; i < node_count; i++) {
+            m_Indices[m_Handles[i]] = i;
+        }
+
+        m_Unsorted = false;
+    }
+
+    uint32_t TransformHierarchy::Update() {
+        m_ChangedNodes.clear();
+        if (!m_AnyDirty)
+            return 0;
+
+        if (m_Unsorted)
+            Sort();
+
+        // Parents are final once their level is done, a child is dirty when it or its parent is
+        m_ChangedIndices.clear();
+        for (size_t level = m_DirtyLevel; level + 1 < m_LevelStarts.size(); level++) {
+            auto first = m_LevelStarts[level];
+            auto count = m_LevelStarts[level + 1] - first;
+            auto batch_count = (count + TRANSFORM_BATCH_SIZE - 1) / TRANSFORM_BATCH_SIZE;
+            if (m_BatchChanges.size() < batch_count)
+                m_BatchChanges.resize(batch_count);
+
+            JobSystem::ParallelFor(count, TRANSFORM_BATCH_SIZE, [this, first](size_t begin, size_t end) {
+                auto &changed = m_BatchChanges[begin / TRANSFORM_BATCH_SIZE];
+                changed.clear();
+
+                for (size_t i = first + begin; i < first + end; i++) {
+                    auto parent = m_Parents[i];
+                    if (parent == INVALID_NODE) {
+                        if (m_Dirty[i]) {
+                            m_World[i] = m_Local[i];
+                            changed.emplace_back(static_cast<uint32_t>(i));
+                        }
+                        continue;
+                    }
+
+                    if (m_Dirty[i] || m_Dirty[parent]) {
+                        m_World[i] = m_World[parent] * m_Local[i];
+                        m_Dirty[i] = 1;
+                        changed.emplace_back(static_cast<uint32_t>(i));
+                    }
+                }
+            });
+
+            for (size_t batch = 0; batch < batch_count; batch++) {
+                m_ChangedIndices.insert(m_ChangedIndices.end(), m_BatchChanges[batch].begin(),
+                                        m_BatchChanges[batch].end());
+            }
+        }
+
+        // Every dirty node changed, only those are cleared
+        for (auto index : m_ChangedIndices) {
+            m_Dirty[index] = 0;
+            m_ChangedNodes.emplace_back(m_Handles[index]);
+        }
+        m_AnyDirty = false;
+        m_DirtyLevel = UINT32_MAX;
+
+        return static_cast<uint32_t>(m_ChangedNodes.size());
+    }
+
+    void TransformHierarchy::WriteWorldTransforms(void *destination, size_t stride, bool changed_only) const {
+        auto *bytes = static_cast<std::byte *>(destination);
+
+        if (changed_only) {
+            for (auto node : m_ChangedNodes) {
+                auto index = m_Indices[node];
+                if (m_Objects[index] != NO_OBJECT)
+                    memcpy(bytes + m_Objects[index] * stride, &m_World[index], sizeof(glm::mat4));
+            }
+            return;
+        }
+
+        // Scattered by object index, from every core
+        JobSystem::ParallelFor(GetNodeCount(), TRANSFORM_BATCH_SIZE, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                if (m_Objects[i] != NO_OBJECT)
+                    memcpy(bytes + m_Objects[i] * stride, &m_World[i], sizeof(glm::mat4));
+            }
+        });
+    }
+} // namespace spock
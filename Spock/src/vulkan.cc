@@ -3,6 +3,10 @@
 #include <stdexcept>
 #include <vulkan/vulkan_core.h>
 
+#include "spock/descriptor_allocator.hh"
+#include "spock/descriptor_set_layout.hxx"
+#include "spock/sampler.hh"
+#include "spock/shader_module.hh"
 #include "spock/spock.hh"
 #include "spock/vulkan.hh"
 #include "spock/window.hh"
@@ -24,6 +28,35 @@ namespace spock
         }
     }
 
+    static void ImageBarrier(VkCommandBuffer command_buffer, VkImage image, VkImageAspectFlags aspect_mask,
+                             VkImageLayout old_layout, VkImageLayout new_layout, VkPipelineStageFlags src_stage,
+                             VkAccessFlags src_access, VkPipelineStageFlags dst_stage, VkAccessFlags dst_access) {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = old_layout;
+        barrier.newLayout = new_layout;
+        barrier.srcAccessMask = src_access;
+        barrier.dstAccessMask = dst_access;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange.aspectMask = aspect_mask;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+
+        vkCmdPipelineBarrier(command_buffer, src_stage, dst_stage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+
+    static VkImageAspectFlags GetDepthAspectMask(VkFormat format) {
+        if (format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT) {
+            return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+        }
+
+        return VK_IMAGE_ASPECT_DEPTH_BIT;
+    }
+
     void Spock::Initialize(const SpockSettings &settings) {
         s_VulkanContext.Win = std::make_unique<Window>(1920, 1080, "Test app", false);
         s_VulkanContext.Settings = settings;
@@ -39,30 +72,27 @@ namespace spock
         // Swapchain creation
         CreateSwapchain();
         CreateImageViews();
-        CreateRenderPass();
         CreateColorResources();
         CreateDepthResources();
-        CreateFramebuffers();
         CreateSyncObjects();
 
         // Command buffers and descriptor pool
         CreateCommandBuffers();
         CreateDescriptorPool();
+        CreateBindlessTextures();
+        CreateFrameGlobals();
 
         // UI
         InitImGUI();
     }
 
     void Spock::CreateDescriptorPool() {
-        static constexpr const uint32_t MAX_COUNT = 1000 * MAX_FRAMES_IN_FLIGHT;
+        // Only used by ImGui, sets for the application come from `DescriptorAllocator`
+        static constexpr const uint32_t MAX_COUNT = 100;
 
-        std::array<VkDescriptorPoolSize, 3> poolSizes{};
-        poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        std::array<VkDescriptorPoolSize, 1> poolSizes{};
+        poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         poolSizes[0].descriptorCount = MAX_COUNT;
-        poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        poolSizes[1].descriptorCount = MAX_COUNT;
-        poolSizes[2].type = VK_DESCRIPTOR_TYPE_SAMPLER;
-        poolSizes[2].descriptorCount = MAX_COUNT;
 
         VkDescriptorPoolCreateInfo pool_info{};
         pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -96,6 +126,20 @@ namespace spock
             throw std::runtime_error("failed to acquire swap chain image!");
         }
 
+        // The previous submission of this frame is done, its released bindless indices can be reused
+        auto &bindless_textures = s_VulkanContext.BindlessTextures;
+        auto &pending_indices = bindless_textures.PendingIndices[s_VulkanContext.CurrentFrame];
+        bindless_textures.FreeIndices.insert(bindless_textures.FreeIndices.end(), pending_indices.begin(),
+                                             pending_indices.end());
+        pending_indices.clear();
+
+        // Same for the transient descriptor sets, and the cached ones invalidated since
+        s_VulkanContext.FrameDescriptors[s_VulkanContext.CurrentFrame].Reset();
+        DescriptorAllocator::FreeInvalidated();
+
+        // Time and viewport, the camera is set by the layers
+        UpdateFrameGlobals();
+
         auto command_buffer = s_VulkanContext.CommandBuffers[s_VulkanContext.CurrentFrame];
 
         vkResetCommandBuffer(command_buffer, 0);
@@ -109,22 +153,72 @@ namespace spock
             throw std::runtime_error("failed to begin recording command buffer!");
         }
 
-        VkRenderPassBeginInfo renderPassInfo{};
-        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        renderPassInfo.renderPass = s_VulkanContext.RenderPass;
-        renderPassInfo.framebuffer = s_VulkanContext.SwapChainFramebuffers[s_VulkanContext.CurrentImageIndex];
-        renderPassInfo.renderArea.offset = {0, 0};
-        renderPassInfo.renderArea.extent = s_VulkanContext.SwapChainExtent;
+        return command_buffer;
+    }
 
-        std::array<VkClearValue, 2> clearValues{};
-        clearValues[0].color = {{0, 0, 0, 1.f}};
-        clearValues[1].depthStencil = {1.f, 0};
+    void Spock::BeginRendering(VkCommandBuffer command_buffer) {
+        // Dynamic rendering does not transition attachments, do it ourselves
+        ImageBarrier(command_buffer, s_VulkanContext.SwapChainImages[s_VulkanContext.CurrentImageIndex],
+                     VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                     VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                     VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+        ImageBarrier(command_buffer, s_VulkanContext.ColorImage, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED,
+                     VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0,
+                     VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+        // The kept depth may have been read by compute since the previous frame, see `HiZPyramid::Build`
+        VkPipelineStageFlags depthStages =
+            VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        ImageBarrier(command_buffer, s_VulkanContext.DepthImage, GetDepthAspectMask(s_VulkanContext.DepthFormat),
+                     VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                     depthStages | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, depthStages,
+                     VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+
+        // Depth resolves happen at the color attachment output stage
+        bool resolveDepth = s_VulkanContext.DepthResolveMode != VK_RESOLVE_MODE_NONE;
+        if (resolveDepth) {
+            ImageBarrier(command_buffer, s_VulkanContext.ResolvedDepthImage,
+                         GetDepthAspectMask(s_VulkanContext.DepthFormat), VK_IMAGE_LAYOUT_UNDEFINED,
+                         VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+        }
+
+        // Multisampled color, resolved into the swapchain image
+        VkRenderingAttachmentInfo colorAttachment{};
+        colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+        colorAttachment.imageView = s_VulkanContext.ColorImageView;
+        colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        colorAttachment.resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT;
+        colorAttachment.resolveImageView = s_VulkanContext.SwapChainImageViews[s_VulkanContext.CurrentImageIndex];
+        colorAttachment.resolveImageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        colorAttachment.clearValue.color = {{0, 0, 0, 1.f}};
+
+        VkRenderingAttachmentInfo depthAttachment{};
+        depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+        depthAttachment.imageView = s_VulkanContext.DepthImageView;
+        depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        // Kept for the next frame occlusion culling, resolved when multisampled
+        depthAttachment.storeOp = resolveDepth ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
+        if (resolveDepth) {
+            depthAttachment.resolveMode = s_VulkanContext.DepthResolveMode;
+            depthAttachment.resolveImageView = s_VulkanContext.ResolvedDepthImageView;
+            depthAttachment.resolveImageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        }
+        depthAttachment.clearValue.depthStencil = {1.f, 0};
 
-        renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-        renderPassInfo.pClearValues = clearValues.data();
+        VkRenderingInfo renderingInfo{};
+        renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+        renderingInfo.renderArea.offset = {0, 0};
+        renderingInfo.renderArea.extent = s_VulkanContext.SwapChainExtent;
+        renderingInfo.layerCount = 1;
+        renderingInfo.colorAttachmentCount = 1;
+        renderingInfo.pColorAttachments = &colorAttachment;
+        renderingInfo.pDepthAttachment = &depthAttachment;
 
         // Begin
-        vkCmdBeginRenderPass(command_buffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBeginRendering(command_buffer, &renderingInfo);
 
         VkViewport viewport{};
         viewport.x = 0.0f;
@@ -139,17 +233,22 @@ namespace spock
         scissor.offset = {0, 0};
         scissor.extent = s_VulkanContext.SwapChainExtent;
         vkCmdSetScissor(command_buffer, 0, 1, &scissor);
-
-        return command_buffer;
     }
 
     void Spock::EndFrame(VkCommandBuffer command_buffer) {
-        vkCmdEndRenderPass(command_buffer);
+        vkCmdEndRendering(command_buffer);
+
+        ImageBarrier(command_buffer, s_VulkanContext.SwapChainImages[s_VulkanContext.CurrentImageIndex],
+                     VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                     VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                     VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0);
 
         if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
             throw std::runtime_error("failed to record command buffer!");
         }
 
+        UploadFrameGlobals();
+
         SubmitCommandBuffer(command_buffer, s_VulkanContext.CurrentImageIndex);
     }
 
@@ -160,14 +259,24 @@ namespace spock
     void Spock::Cleanup() {
         CleanupImGUI();
 
+        ShaderModule::Clear();
+
         vkFreeCommandBuffers(s_VulkanContext.Device, s_VulkanContext.CommandPool, s_VulkanContext.CommandBuffers.size(),
                              s_VulkanContext.CommandBuffers.data());
         vkDestroyDescriptorPool(s_VulkanContext.Device, s_VulkanContext.DescriptorPool, nullptr);
+        CleanupFrameGlobals();
+        s_VulkanContext.CachedDescriptorSets.clear();
+        s_VulkanContext.PendingDescriptorSets.clear();
+        DescriptorSetLayout::Clear();
+        Sampler::Clear();
+        s_VulkanContext.Descriptors.Cleanup();
+        for (auto &frame_descriptors : s_VulkanContext.FrameDescriptors) {
+            frame_descriptors.Cleanup();
+        }
+        CleanupBindlessTextures();
 
         CleanupSwapchain();
 
-        vkDestroyRenderPass(s_VulkanContext.Device, s_VulkanContext.RenderPass, nullptr);
-
         for (auto i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
             vkDestroySemaphore(s_VulkanContext.Device, s_VulkanContext.RenderFinishedSemaphores[i], nullptr);
             vkDestroySemaphore(s_VulkanContext.Device, s_VulkanContext.ImageAvailableSemaphores[i], nullptr);
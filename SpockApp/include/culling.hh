@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "spock/bvh.hh"
+#include "spock/frustum_culler.hh"
+
+// CPU frustum culling throughput of every kernel the CPU supports and of the BVH, against the camera of the frame
+class ExampleCulling {
+  private:
+    // Random boxes and spheres around the camera target, many of them outside of the view
+    static constexpr uint32_t OBJECT_COUNT = 1 << 20;
+    // Best of, the first runs warm the caches and the job system
+    static constexpr uint32_t RUN_COUNT = 10;
+
+  public:
+    struct Result
+    {
+        std::string Name;
+        uint32_t VisibleCount;
+        double Milliseconds;
+
+        double GetMillionObjectsPerMillisecond() const {
+            return OBJECT_COUNT / Milliseconds / 1e6;
+        }
+    };
+
+    ExampleCulling();
+    ExampleCulling(const ExampleCulling &) = delete;
+    ExampleCulling operator=(const ExampleCulling &) = delete;
+
+    void Run();
+
+    const std::vector<Result> &GetResults() const {
+        return m_Results;
+    }
+
+  private:
+    spock::FrustumCuller m_Culler;
+    std::vector<spock::BoundingBox> m_Bounds;
+    spock::Bvh m_Bvh;
+    std::vector<uint32_t> m_Visible;
+    std::vector<Result> m_Results;
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/buffers.hxx"
+#include "spock/command_recorder.hh"
+#include "spock/descriptor_buffer.hh"
+#include "spock/pipeline.hh"
+#include "spock/typed_descriptor_set_layout.hxx"
+#include "spock/uniform_buffer.hxx"
+
+class ExampleDescriptorBuffer {
+  private:
+    // Descriptor buffer pipelines can not bind the frame globals, the camera comes with the transform
+    struct Uniforms
+    {
+        glm::mat4 ViewProjection;
+        glm::mat4 Model;
+    };
+
+    using SetLayout =
+        spock::TypedDescriptorSetLayout<spock::UniformBufferBinding<0, Uniforms, VK_SHADER_STAGE_VERTEX_BIT>>;
+
+  public:
+    // Requires `spock::DescriptorBuffer::IsAvailable`
+    ExampleDescriptorBuffer();
+    ExampleDescriptorBuffer(const ExampleDescriptorBuffer &) = delete;
+    ExampleDescriptorBuffer operator=(const ExampleDescriptorBuffer &) = delete;
+
+    void Update(float rotation);
+    void Render(spock::CommandRecorder &recorder) const;
+
+  private:
+    std::unique_ptr<SetLayout> m_SetLayout;
+    std::unique_ptr<spock::Pipeline> m_Pipeline;
+    std::unique_ptr<spock::Buffer> m_VertexBuffer;
+    std::unique_ptr<spock::UniformBuffer<Uniforms>> m_Uniforms;
+
+    // One set per frame in flight, written once
+    std::unique_ptr<spock::DescriptorBuffer> m_DescriptorBuffer;
+    std::array<uint32_t, spock::MAX_FRAMES_IN_FLIGHT> m_Sets{};
+};
@@ -4,9 +4,13 @@
 #include <memory>
 #include <vulkan/vulkan_core.h>
 
+#include "culling.hh"
+#include "descriptor_buffers.hh"
 #include "images.hh"
+#include "indirect.hh"
 #include "shapes.hh"
 #include "spock/layer.hh"
+#include "transforms.hh"
 
 namespace spock
 {
@@ -22,7 +26,8 @@ class ExampleLayer : public spock::Layer {
     virtual void OnAttach() override;
     virtual void OnDetach() override;
     virtual void OnUpdate(float delta_time) override;
-    virtual void OnRender(VkCommandBuffer command_buffer) override;
+    virtual void OnCompute(VkCommandBuffer command_buffer) override;
+    virtual void OnRender(spock::CommandRecorder &recorder) override;
     virtual void OnUIRender(VkCommandBuffer command_buffer) override;
 
   private:
@@ -31,5 +36,9 @@ class ExampleLayer : public spock::Layer {
   private:
     std::unique_ptr<ExampleShapes> m_Shapes;
     std::unique_ptr<ExampleImage> m_Image;
+    std::unique_ptr<ExampleIndirect> m_Indirect;
+    std::unique_ptr<ExampleDescriptorBuffer> m_DescriptorBuffer;
+    std::unique_ptr<ExampleCulling> m_Culling;
+    std::unique_ptr<ExampleTransforms> m_Transforms;
     float m_RotationSpeed = 1.f;
 };
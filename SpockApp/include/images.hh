@@ -5,19 +5,17 @@
 #include <vulkan/vulkan_core.h>
 
 #include "spock/buffers.hxx"
-#include "spock/descriptor_set.hxx"
-#include "spock/descriptor_set_layout.hxx"
 #include "spock/pipeline.hh"
+#include "spock/render_queue.hh"
 #include "spock/texture.hh"
-#include "spock/uniform_buffer.hxx"
 
 class ExampleImage {
   private:
-    struct UniformBufferObject
+    // Per-object data, pushed with every draw
+    struct PushConstants
     {
         glm::mat4 Model;
-        glm::mat4 View;
-        glm::mat4 Projection;
+        uint32_t TextureIndex;
     };
 
   public:
@@ -26,13 +24,11 @@ class ExampleImage {
     ExampleImage operator=(const ExampleImage &) = delete;
 
     void Update(float rotation);
-    void Render(VkCommandBuffer command_buffer) const;
+    void Render(spock::RenderQueue &render_queue) const;
 
   private:
     std::unique_ptr<spock::Pipeline> m_Pipeline;
-    std::unique_ptr<spock::DescriptorSetLayout> m_DescriptorSetLayout;
-    std::array<spock::DescriptorSet, spock::MAX_FRAMES_IN_FLIGHT> m_DescriptorSets;
-    std::unique_ptr<spock::UniformBuffer<UniformBufferObject>> m_UniformBuffer;
     std::shared_ptr<spock::Texture2D> m_Texture;
     std::unique_ptr<spock::Buffer> m_VertexBuffer;
+    glm::mat4 m_Model{1.0f};
 };
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vulkan/vulkan_core.h>
+
+#include "spock/bvh.hh"
+#include "spock/command_recorder.hh"
+#include "spock/geometry_buffer.hh"
+#include "spock/hiz_pyramid.hh"
+#include "spock/indirect_scene.hh"
+#include "spock/pipeline.hh"
+
+class ExampleIndirect {
+  private:
+    // Tiles on each side of the floor, most of them end up outside of the view
+    static constexpr uint32_t GRID_SIZE = 64;
+    // Spheres lined up away from the camera, the far ones drawn at a coarser level of detail
+    static constexpr uint32_t SPHERE_COUNT = 12;
+    static constexpr float SPHERE_SCALE = 0.15f;
+    // The spheres bounce together, their boxes are refit every frame
+    static constexpr float BOUNCE_HEIGHT = 0.3f;
+    // Pyramids pointing at the spheres, one mesh each
+    static constexpr float MARKER_SIZE = 0.08f;
+
+  public:
+    ExampleIndirect();
+    ExampleIndirect(const ExampleIndirect &) = delete;
+    ExampleIndirect operator=(const ExampleIndirect &) = delete;
+
+    // Moves the spheres and picks their level of detail for the camera of the frame
+    void Update();
+    // Before rendering begins, see `spock::Layer::OnCompute`. Tiles hidden by the spheres are occlusion culled.
+    void Cull(VkCommandBuffer command_buffer);
+    void Render(spock::CommandRecorder &recorder) const;
+
+    // Object under `position` on screen, see `spock::Ray::FromScreen`
+    uint32_t Pick(const glm::vec2 &position) const;
+
+    // Only the moving spheres and the markers are uploaded, the floor never is
+    const spock::ObjectBuffer &GetObjectBuffer() const {
+        return m_Scene->GetObjectBuffer();
+    }
+
+  private:
+    std::unique_ptr<spock::Pipeline> m_Pipeline;
+    std::unique_ptr<spock::GeometryBuffer> m_Geometry;
+    std::unique_ptr<spock::IndirectScene> m_Scene;
+    std::unique_ptr<spock::HiZPyramid> m_HiZ;
+    // World space bounds of the scene objects, for picking
+    spock::Bvh m_Bvh;
+
+    spock::GeometryBuffer::Mesh m_Sphere;
+    std::array<uint32_t, SPHERE_COUNT> m_SphereObjects{};
+    std::array<glm::vec3, SPHERE_COUNT> m_SpherePositions{}; // Resting on the floor
+
+    // Already placed in the world, all drawn with the transform of a single object which follows the spheres
+    std::array<spock::GeometryBuffer::Mesh, SPHERE_COUNT> m_Markers{};
+    uint32_t m_MarkerObject = 0;
+};
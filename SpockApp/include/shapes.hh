@@ -1,36 +1,42 @@
 #pragma once
 
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <memory>
+#include <vector>
 #include <vulkan/vulkan_core.h>
 
 #include "spock/buffers.hxx"
-#include "spock/descriptor_set.hxx"
-#include "spock/descriptor_set_layout.hxx"
+#include "spock/instance_buffer.hxx"
 #include "spock/pipeline.hh"
-#include "spock/uniform_buffer.hxx"
+#include "spock/render_queue.hh"
+#include "spock/transform_hierarchy.hh"
 
 class ExampleShapes {
   private:
-    struct UniformBufferObject
+    // Per-instance data, read from the instance buffer (binding 1)
+    struct InstanceData
     {
         glm::mat4 Model;
-        glm::mat4 View;
-        glm::mat4 Projection;
     };
 
+    // Copies drawn on each side of the grid
+    static constexpr uint32_t GRID_SIZE = 4;
+
   public:
     ExampleShapes();
     ExampleShapes(const ExampleShapes &) = delete;
     ExampleShapes operator=(const ExampleShapes &) = delete;
 
     void Update(float rotation);
-    void Render(VkCommandBuffer command_buffer) const;
+    void Render(spock::RenderQueue &render_queue) const;
 
   private:
     std::unique_ptr<spock::Pipeline> m_Pipeline;
-    std::unique_ptr<spock::DescriptorSetLayout> m_DescriptorSetLayout;
-    std::array<spock::DescriptorSet, spock::MAX_FRAMES_IN_FLIGHT> m_DescriptorSets;
-    std::unique_ptr<spock::UniformBuffer<UniformBufferObject>> m_UniformBuffer;
     std::unique_ptr<spock::Buffer> m_VertexBuffer;
+    std::unique_ptr<spock::InstanceBuffer<InstanceData>> m_InstanceBuffer;
+
+    // Grid, then the place of each copy, then its spin which is the instance
+    spock::TransformHierarchy m_Transforms;
+    std::vector<uint32_t> m_SpinNodes;
 };
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+#include "spock/transform_hierarchy.hh"
+
+// `TransformHierarchy::Update` time of about 100k nodes, with all of them or only a few animated
+class ExampleTransforms {
+  private:
+    // Roots, children under each root, then leaves under each child
+    static constexpr uint32_t ROOT_COUNT = 100;
+    static constexpr uint32_t CHILD_COUNT = 10;
+    static constexpr uint32_t LEAF_COUNT = 100;
+    static constexpr uint32_t FIRST_LEAF = ROOT_COUNT + ROOT_COUNT * CHILD_COUNT;
+    // Best of, the first runs warm the caches and the job system
+    static constexpr uint32_t RUN_COUNT = 10;
+
+  public:
+    // Every node animated is expected to update within this
+    static constexpr double TARGET_MILLISECONDS = 2.0;
+
+    struct Result
+    {
+        std::string Name;
+        uint32_t ChangedCount;
+        double Milliseconds;
+    };
+
+    ExampleTransforms();
+    ExampleTransforms(const ExampleTransforms &) = delete;
+    ExampleTransforms operator=(const ExampleTransforms &) = delete;
+
+    void Run();
+
+    const std::vector<Result> &GetResults() const {
+        return m_Results;
+    }
+
+    uint32_t GetNodeCount() const {
+        return m_Hierarchy.GetNodeCount();
+    }
+
+  private:
+    // Turns every `stride`th node from `first` on
+    void Animate(uint32_t first, uint32_t stride, float angle);
+
+  private:
+    spock::TransformHierarchy m_Hierarchy;
+    // Local transforms before turning
+    std::vector<glm::mat4> m_Rest;
+    std::vector<Result> m_Results;
+};
@@ -0,0 +1,17 @@
+#version 450 core
+
+// Read from a descriptor buffer, see `spock::DescriptorBuffer`
+layout(set = 0, binding = 0) uniform Uniforms {
+    mat4 viewProj;
+    mat4 model;
+} uniforms;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+
+layout(location = 0) out vec3 fragColor;
+
+void main() {
+    gl_Position = uniforms.viewProj * uniforms.model * vec4(inPosition, 1.0);
+    fragColor = inColor;
+}
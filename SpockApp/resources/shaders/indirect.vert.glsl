@@ -0,0 +1,38 @@
+#version 460 core
+
+// Shared by every draw of the frame, see `spock::FrameGlobals`
+layout(set = 0, binding = 0) uniform FrameGlobals {
+    mat4 view;
+    mat4 proj;
+    mat4 viewProj;
+    vec4 cameraPosition;
+    vec2 viewport;
+    float time;
+    float deltaTime;
+} frame;
+
+// See `spock::IndirectObject`
+struct Object {
+    mat4 model;
+    vec4 boundingSphere;
+    uint indexCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint padding;
+};
+
+layout(std430, set = 1, binding = 0) readonly buffer Objects {
+    Object objects[];
+};
+
+layout(location = 0) in vec3 inPosition;
+
+layout(location = 0) out vec3 fragColor;
+
+void main() {
+    // The culling shader sets the first instance of each draw to its object index
+    Object object = objects[gl_InstanceIndex];
+
+    gl_Position = frame.viewProj * object.model * vec4(inPosition, 1.0);
+    fragColor = vec3(0.2) + 0.3 * vec3(gl_InstanceIndex % 3, (gl_InstanceIndex / 3) % 3, (gl_InstanceIndex / 9) % 3);
+}
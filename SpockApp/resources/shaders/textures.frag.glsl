@@ -1,11 +1,18 @@
 #version 450 core
+#extension GL_EXT_nonuniform_qualifier : require
 
-layout(set = 0, binding = 1) uniform sampler2D texSampler;
+// Bindless texture table bound as the material set, see `spock::BindlessTextures`
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+
+layout(push_constant) uniform PushConstants {
+    mat4 model;
+    uint textureIndex;
+} pc;
 
 layout(location = 0) in vec2 fragTexCoord;
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    outColor = texture(texSampler, fragTexCoord);
+    outColor = texture(textures[nonuniformEXT(pc.textureIndex)], fragTexCoord);
 }
@@ -1,10 +1,20 @@
 #version 450 core
 
-layout(set = 0, binding = 0) uniform UniformBufferObject {
-    mat4 model;
+// Shared by every draw of the frame, see `spock::FrameGlobals`
+layout(set = 0, binding = 0) uniform FrameGlobals {
     mat4 view;
     mat4 proj;
-} ubo;
+    mat4 viewProj;
+    vec4 cameraPosition;
+    vec2 viewport;
+    float time;
+    float deltaTime;
+} frame;
+
+layout(push_constant) uniform PushConstants {
+    mat4 model;
+    uint textureIndex;
+} pc;
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec2 inTexCoord;
@@ -12,6 +22,6 @@ layout(location = 1) in vec2 inTexCoord;
 layout(location = 0) out vec2 fragTexCoord;
 
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+    gl_Position = frame.viewProj * pc.model * vec4(inPosition, 1.0);
     fragTexCoord = inTexCoord;
 }
@@ -1,17 +1,24 @@
 #version 450 core
 
-layout(set = 0, binding = 0) uniform UniformBufferObject {
-    mat4 model;
+// Shared by every draw of the frame, see `spock::FrameGlobals`
+layout(set = 0, binding = 0) uniform FrameGlobals {
     mat4 view;
     mat4 proj;
-} ubo;
+    mat4 viewProj;
+    vec4 cameraPosition;
+    vec2 viewport;
+    float time;
+    float deltaTime;
+} frame;
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
+// Per instance, locations 2 to 5
+layout(location = 2) in mat4 inModel;
 
 layout(location = 0) out vec3 fragColor;
 
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+    gl_Position = frame.viewProj * inModel * vec4(inPosition, 1.0);
     fragColor = inColor;
 }
@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <chrono>
+#include <glm/glm.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "culling.hh"
+#include "spock/frame_globals.hh"
+#include "spock/frustum.hh"
+
+ExampleCulling::ExampleCulling() {
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> position(-20.0f, 20.0f);
+    std::uniform_real_distribution<float> size(0.05f, 1.0f);
+
+    // Half boxes, half spheres
+    m_Bounds.reserve(OBJECT_COUNT);
+    m_Culler.Reserve(OBJECT_COUNT);
+    for (uint32_t i = 0; i < OBJECT_COUNT; i++) {
+        glm::vec3 center(position(random), position(random), position(random));
+        if (i % 2 == 0) {
+            glm::vec3 extents(size(random), size(random), size(random));
+            m_Culler.AddBox(center - extents, center + extents);
+            m_Bounds.push_back({center - extents, center + extents});
+        } else {
+            auto radius = size(random);
+            m_Culler.AddSphere(center, radius);
+            m_Bounds.push_back(spock::BoundingBox::FromSphere(center, radius));
+        }
+    }
+}
+
+void ExampleCulling::Run() {
+    auto frustum = spock::Frustum::FromMatrix(spock::FrameGlobals::GetData().ViewProjection);
+
+    m_Results.clear();
+    for (auto kernel : {spock::FrustumCuller::Kernel::Scalar, spock::FrustumCuller::Kernel::SSE,
+                        spock::FrustumCuller::Kernel::AVX2}) {
+        if (!spock::FrustumCuller::IsSupported(kernel))
+            continue;
+
+        for (bool parallel : {false, true}) {
+            Result result{spock::FrustumCuller::GetKernelName(kernel), 0, 0.0};
+            if (parallel)
+                result.Name += " + jobs";
+            for (uint32_t run = 0; run < RUN_COUNT; run++) {
+                auto start = std::chrono::steady_clock::now();
+                result.VisibleCount = m_Culler.Cull(frustum, kernel, parallel);
+                std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+
+                result.Milliseconds = run == 0 ? duration.count() : std::min(result.Milliseconds, duration.count());
+            }
+
+            m_Results.emplace_back(result);
+        }
+    }
+
+    // Boxes only, whole subtrees inside of the view are not tested. Built on first use, it takes a while.
+    if (m_Bvh.GetObjectCount() == 0)
+        m_Bvh.Build(m_Bounds);
+
+    Result result{"BVH", 0, 0.0};
+    for (uint32_t run = 0; run < RUN_COUNT; run++) {
+        auto start = std::chrono::steady_clock::now();
+        m_Visible.clear();
+        m_Bvh.Cull(frustum, m_Visible);
+        std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+
+        result.VisibleCount = static_cast<uint32_t>(m_Visible.size());
+        result.Milliseconds = run == 0 ? duration.count() : std::min(result.Milliseconds, duration.count());
+    }
+    m_Results.emplace_back(result);
+}
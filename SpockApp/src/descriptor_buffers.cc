@@ -0,0 +1,78 @@
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "descriptor_buffers.hh"
+#include "embedded_shaders.hh"
+#include "spock/frame_globals.hh"
+#include "spock/spock.hh"
+
+struct ColorVertex
+{
+    glm::vec3 Position;
+    glm::vec3 Color;
+};
+
+ExampleDescriptorBuffer::ExampleDescriptorBuffer() {
+    m_SetLayout = SetLayout::CreateDescriptorBufferLayout();
+
+    // Shader stages
+    std::vector<spock::PipelineStage> stages;
+    stages.emplace_back(
+        spock::PipelineStage::PipelineStageFromData(shaders::descriptor_buffer_vert, VK_SHADER_STAGE_VERTEX_BIT));
+    stages.emplace_back(
+        spock::PipelineStage::PipelineStageFromData(shaders::triangle_frag, VK_SHADER_STAGE_FRAGMENT_BIT));
+
+    // Generate the pipeline config, the uniforms at set 0 come from the descriptor buffer
+    spock::PipelineConfig pipeline_config{};
+    pipeline_config.Stages = std::move(stages);
+    pipeline_config.BindingDescriptions = {{0, sizeof(ColorVertex), VK_VERTEX_INPUT_RATE_VERTEX}};
+    pipeline_config.AttributeDescriptions = {
+        {0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(ColorVertex, Position)},
+        {1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(ColorVertex, Color)},
+    };
+    pipeline_config.DescriptorSetLayouts = {m_SetLayout->GetDescriptorSetLayout()};
+    pipeline_config.UseDescriptorBuffers = true;
+
+    m_Pipeline = spock::Pipeline::CreatePipeline(std::move(pipeline_config));
+
+    // A small quad above the other examples
+    // clang-format off
+    std::vector<ColorVertex> vertices = {
+        {{-0.3f, -0.3f, 0.8f}, {1, 1, 0}}, {{ 0.3f, -0.3f, 0.8f}, {0, 1, 1}}, {{ 0.3f,  0.3f, 0.8f}, {1, 0, 1}},
+        {{ 0.3f,  0.3f, 0.8f}, {1, 0, 1}}, {{-0.3f,  0.3f, 0.8f}, {0, 1, 1}}, {{-0.3f, -0.3f, 0.8f}, {1, 1, 0}},
+    };
+    // clang-format on
+    m_VertexBuffer = spock::Buffer::CreateVertexBuffer<ColorVertex>(vertices);
+
+    // The descriptors are copied into the buffer, no pool or VkDescriptorSet involved
+    m_Uniforms = spock::UniformBuffer<Uniforms>::CreateUniformBuffer();
+    m_DescriptorBuffer = spock::DescriptorBuffer::CreateDescriptorBuffer(m_SetLayout->GetLayout(),
+                                                                         spock::MAX_FRAMES_IN_FLIGHT);
+    for (int i = 0; i < spock::MAX_FRAMES_IN_FLIGHT; i++) {
+        m_Sets[i] = m_DescriptorBuffer->Allocate();
+        m_DescriptorBuffer->Write(m_Sets[i], SetLayout::Pack(i, *m_Uniforms));
+    }
+}
+
+void ExampleDescriptorBuffer::Update(float rotation) {
+    Uniforms uniforms{};
+    uniforms.ViewProjection = spock::FrameGlobals::GetData().ViewProjection;
+    uniforms.Model =
+        glm::rotate(glm::mat4(1.0f), -(6.f / 60000) * rotation * glm::radians(360.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    m_Uniforms->SetData(uniforms);
+}
+
+void ExampleDescriptorBuffer::Render(spock::CommandRecorder &recorder) const {
+    recorder.BindPipeline(*m_Pipeline);
+    m_DescriptorBuffer->Bind(recorder.GetCommandBuffer(), m_Pipeline->GetLayout(), 0,
+                             m_Sets[spock::Spock::GetCurrentFrame()]);
+    // Binding descriptor buffers disturbs the bound sets behind the recorder's back
+    recorder.Invalidate();
+
+    VkBuffer vertex_buffer = m_VertexBuffer->GetBuffer();
+    recorder.BindVertexBuffers(0, {&vertex_buffer, 1});
+    recorder.Draw(6);
+}
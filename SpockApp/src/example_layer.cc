@@ -1,33 +1,80 @@
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 #include <imgui/imgui.h>
 #include <memory>
 
 #include "example_layer.hh"
 #include "images.hh"
+#include "spock/application.hh"
+#include "spock/descriptor_buffer.hh"
+#include "spock/frame_globals.hh"
+#include "spock/indirect_scene.hh"
 
 void ExampleLayer::OnAttach() {
     m_Shapes = std::make_unique<ExampleShapes>();
     m_Image = std::make_unique<ExampleImage>();
+    // Devices without multiDrawIndirect only skip the GPU-driven scene
+    if (spock::IndirectScene::IsAvailable())
+        m_Indirect = std::make_unique<ExampleIndirect>();
+    // Same for VK_EXT_descriptor_buffer, see `SpockSettings::UseDescriptorBuffers`
+    if (spock::DescriptorBuffer::IsAvailable())
+        m_DescriptorBuffer = std::make_unique<ExampleDescriptorBuffer>();
+    m_Culling = std::make_unique<ExampleCulling>();
+    m_Transforms = std::make_unique<ExampleTransforms>();
 }
 
 void ExampleLayer::OnDetach() {
     // Free up memory
     m_Shapes = nullptr;
     m_Image = nullptr;
+    m_Indirect = nullptr;
+    m_DescriptorBuffer = nullptr;
+    m_Culling = nullptr;
+    m_Transforms = nullptr;
 }
 
 void ExampleLayer::OnUpdate(float delta_time) {
     static float rotation = 0;
     rotation += m_RotationSpeed * delta_time;
 
+    // Camera, shared by every draw through the frame globals. A minimized window has no aspect ratio, the previous
+    // camera is kept.
+    auto viewport = spock::FrameGlobals::GetData().Viewport;
+    if (viewport.x > 0 && viewport.y > 0) {
+        auto view = glm::lookAt(glm::vec3(2.f, 2.f, 2.f), glm::vec3(0, 0, 0), glm::vec3(0.0f, 0.0f, 1.0f));
+        auto projection = glm::perspective(glm::radians(45.0f), viewport.x / viewport.y, 0.1f, 1000.0f); // 45deg fov
+        projection[1][1] *= -1;
+        spock::FrameGlobals::SetCamera(view, projection);
+    }
+
     // Update the shapes
     m_Shapes->Update(rotation);
     m_Image->Update(rotation);
+    if (m_Indirect)
+        m_Indirect->Update();
+    if (m_DescriptorBuffer)
+        m_DescriptorBuffer->Update(rotation);
+}
+
+void ExampleLayer::OnCompute(VkCommandBuffer command_buffer) {
+    // GPU culling of the floor tiles, against the camera set in `OnUpdate`
+    if (m_Indirect)
+        m_Indirect->Cull(command_buffer);
 }
 
-void ExampleLayer::OnRender(VkCommandBuffer command_buffer) {
-    // Render the shapes
-    m_Shapes->Render(command_buffer);
-    m_Image->Render(command_buffer);
+void ExampleLayer::OnRender(spock::CommandRecorder &recorder) {
+    // Sorted and recorded by the application once every layer rendered
+    auto &render_queue = m_Application.GetRenderQueue();
+    m_Shapes->Render(render_queue);
+    m_Image->Render(render_queue);
+
+    // Binds its own descriptor buffer, recorded directly
+    if (m_DescriptorBuffer)
+        m_DescriptorBuffer->Render(recorder);
+
+    // Already a single draw, recorded directly
+    if (m_Indirect)
+        m_Indirect->Render(recorder);
 }
 
 void ExampleLayer::OnUIRender(VkCommandBuffer) {
@@ -38,5 +85,49 @@ void ExampleLayer::OnUIRender(VkCommandBuffer) {
     ImGui::Text("FPS: %.1f", ImGui::GetIO().Framerate);
     ImGui::SliderFloat("Rotation speed", &m_RotationSpeed, 0, 5);
 
+    const auto &statistics = m_Application.GetCommandRecorder().GetStatistics();
+    ImGui::Text("Draw packets: %u", m_Application.GetRenderQueue().GetPacketCount());
+    ImGui::Text("Pipeline binds: %u, skipped binds: %u", statistics.PipelineBinds, statistics.GetSkipped());
+
+    if (m_Indirect) {
+        // Against bounding boxes only, a bit larger than what they hold
+        auto mouse = ImGui::GetIO().MousePos;
+        auto display = ImGui::GetIO().DisplaySize;
+        auto hovered = spock::Bvh::INVALID_OBJECT;
+        if (ImGui::IsMousePosValid() && display.x > 0 && display.y > 0)
+            hovered = m_Indirect->Pick(glm::vec2(mouse.x / display.x, mouse.y / display.y));
+        if (hovered != spock::Bvh::INVALID_OBJECT)
+            ImGui::Text("Hovered object: %u", hovered);
+        else
+            ImGui::Text("Hovered object: none");
+
+        const auto &objects = m_Indirect->GetObjectBuffer();
+        ImGui::Text("Object uploads: %u (%.1f KB)", objects.GetUploadedCount(), objects.GetUploadedSize() / 1024.0);
+    } else {
+        ImGui::Text("Indirect scene: multiDrawIndirect is not supported");
+    }
+    if (!m_DescriptorBuffer)
+        ImGui::Text("Descriptor buffer: VK_EXT_descriptor_buffer is not supported");
+
+    // Stalls the frame while it runs
+    if (ImGui::Button("Benchmark CPU culling"))
+        m_Culling->Run();
+    for (const auto &result : m_Culling->GetResults()) {
+        ImGui::Text("%s: %.3f M objects/ms (%u visible)", result.Name.c_str(), result.GetMillionObjectsPerMillisecond(),
+                    result.VisibleCount);
+    }
+
+    // Same, the first result is the one with a target
+    if (ImGui::Button("Benchmark transforms"))
+        m_Transforms->Run();
+    for (const auto &result : m_Transforms->GetResults()) {
+        ImGui::Text("%s: %.3f ms (%u of %u nodes changed)", result.Name.c_str(), result.Milliseconds,
+                    result.ChangedCount, m_Transforms->GetNodeCount());
+    }
+    if (!m_Transforms->GetResults().empty()) {
+        bool met = m_Transforms->GetResults().front().Milliseconds <= ExampleTransforms::TARGET_MILLISECONDS;
+        ImGui::Text("Every node within %.0f ms: %s", ExampleTransforms::TARGET_MILLISECONDS, met ? "met" : "missed");
+    }
+
     ImGui::End();
 }
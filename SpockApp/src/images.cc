@@ -1,9 +1,11 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <stdexcept>
 #include <vulkan/vulkan_core.h>
 
+#include "embedded_shaders.hh"
 #include "images.hh"
-#include "spock/descriptor.hxx"
+#include "spock/bindless.hh"
 #include "spock/texture.hh"
 
 struct ImageVertex
@@ -44,42 +46,25 @@ struct ImageVertex
 ExampleImage::ExampleImage() {
     // Shader stages
     std::vector<spock::PipelineStage> stages;
-    stages.emplace_back(spock::PipelineStage::PipelineStageFromFile("SpockApp/resources/shaders/textures.vert.spv",
-                                                                    VK_SHADER_STAGE_VERTEX_BIT));
-    stages.emplace_back(spock::PipelineStage::PipelineStageFromFile("SpockApp/resources/shaders/textures.frag.spv",
-                                                                    VK_SHADER_STAGE_FRAGMENT_BIT));
-
-    // Setup the uniform buffers
-    VkDescriptorSetLayoutBinding uboLayoutBinding{};
-    uboLayoutBinding.binding = 0;
-    uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    uboLayoutBinding.descriptorCount = 1;
-    uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-
-    VkDescriptorSetLayoutBinding samplerLayoutBinding{};
-    samplerLayoutBinding.binding = 1;
-    samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    samplerLayoutBinding.descriptorCount = 1;
-    samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-    std::array<VkDescriptorSetLayoutBinding, 2> bindings = {uboLayoutBinding, samplerLayoutBinding};
-    m_DescriptorSetLayout = spock::DescriptorSetLayout::CreateDescriptorSetLayout(bindings);
-
-    m_UniformBuffer = spock::UniformBuffer<UniformBufferObject>::CreateUniformBuffer();
-    m_Texture = spock::Texture2D::FromFile("SpockApp/resources/images/texture.jpg");
+    stages.emplace_back(spock::PipelineStage::PipelineStageFromData(shaders::textures_vert, VK_SHADER_STAGE_VERTEX_BIT));
+    stages.emplace_back(
+        spock::PipelineStage::PipelineStageFromData(shaders::textures_frag, VK_SHADER_STAGE_FRAGMENT_BIT));
 
-    // Add our descriptors to the set
-    auto uniform_buffer_descriptor = spock::UniformBufferDescriptor(0, m_UniformBuffer);
-    auto texture_descriptor = spock::ImageSamplerDescriptor(1, m_Texture);
-    std::array<spock::Descriptor *, 2> descriptors{&uniform_buffer_descriptor, &texture_descriptor};
-    m_DescriptorSets = spock::CreateDescriptorSets(m_DescriptorSetLayout, std::move(descriptors));
+    // Textures are sampled from the bindless table, selected with a push constant
+    if (!spock::BindlessTextures::IsAvailable()) {
+        throw std::runtime_error("bindless textures are not supported by this device!");
+    }
+    m_Texture = spock::Texture2D::FromFile("SpockApp/resources/images/texture.jpg");
 
     // Generate the pipeline config
     spock::PipelineConfig pipeline_config{};
     pipeline_config.Stages = std::move(stages);
-    pipeline_config.BindingDescription = ImageVertex::GetBindingDescription();
+    pipeline_config.BindingDescriptions = {ImageVertex::GetBindingDescription()};
     pipeline_config.AttributeDescriptions = ImageVertex::GetAttributeDescriptions();
-    pipeline_config.DescriptorSetLayouts = {m_DescriptorSetLayout->GetDescriptorSetLayout()};
+    pipeline_config.DescriptorSetLayouts = {spock::BindlessTextures::GetDescriptorSetLayout()}; // Material
+    pipeline_config.PushConstants = {
+        spock::PushConstantRange<PushConstants>(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)};
+    pipeline_config.UseFrameGlobals = true; // Camera at set 0
 
     m_Pipeline = spock::Pipeline::CreatePipeline(std::move(pipeline_config));
 
@@ -99,27 +84,25 @@ ExampleImage::ExampleImage() {
 }
 
 void ExampleImage::Update(float rotation) {
-    UniformBufferObject ubo{};
-    ubo.Model =
+    m_Model =
         glm::rotate(glm::mat4(1.0f), (6.f / 60000) * rotation * glm::radians(360.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-    ubo.View = glm::lookAt(glm::vec3(2.f, 2.f, 2.f), glm::vec3(0, 0, 0), glm::vec3(0.0f, 0.0f, 1.0f));
-    ubo.Projection = glm::perspective(glm::radians(45.0f), 16 / (float)9, 0.1f, 1000.0f); // 45deg fov, 16:9 ratio
-    ubo.Projection[1][1] *= -1;
-
-    m_UniformBuffer->SetData(ubo);
 }
 
-void ExampleImage::Render(VkCommandBuffer command_buffer) const {
-    m_Pipeline->Bind(command_buffer);
+void ExampleImage::Render(spock::RenderQueue &render_queue) const {
+    // Material, the frame globals are bound with the pipeline
+    auto material = spock::BindlessTextures::GetDescriptorSet();
+
+    spock::DrawPacket packet{};
+    packet.SortKey = render_queue.MakeSortKey(0, *m_Pipeline, material, 0.0f);
+    packet.DrawPipeline = m_Pipeline.get();
+    packet.MaterialSet = material;
+    packet.VertexBuffers = {m_VertexBuffer->GetBuffer()};
 
-    // Bind the vertex buffer
-    VkDeviceSize offset[] = {0};
-    VkBuffer vertex_buffers[] = {m_VertexBuffer->GetBuffer()};
-    vkCmdBindVertexBuffers(command_buffer, 0, 1, vertex_buffers, offset);
+    // Per-object transform and texture
+    PushConstants push_constants{m_Model, m_Texture->GetBindlessIndex()};
+    packet.SetPushConstants(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, push_constants);
 
-    // Bind the uniform buffer
-    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Pipeline->GetLayout(), 0, 1,
-                            &m_DescriptorSets[spock::Spock::GetCurrentFrame()], 0, nullptr);
+    packet.Count = 6;
 
-    vkCmdDraw(command_buffer, 6, 1, 0, 0);
+    render_queue.Submit(packet);
 }
@@ -0,0 +1,191 @@
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "embedded_shaders.hh"
+#include "indirect.hh"
+#include "spock/frame_globals.hh"
+#include "spock/lod_selector.hh"
+#include "spock/mesh_simplifier.hh"
+
+// Unit UV sphere, the seam column is duplicated
+static void CreateSphere(std::vector<glm::vec3> &vertices, std::vector<uint32_t> &indices) {
+    constexpr uint32_t SEGMENTS = 64, RINGS = 32;
+
+    for (uint32_t ring = 0; ring <= RINGS; ring++) {
+        for (uint32_t segment = 0; segment <= SEGMENTS; segment++) {
+            auto theta = glm::pi<float>() * ring / RINGS;
+            auto phi = 2 * glm::pi<float>() * segment / SEGMENTS;
+            vertices.emplace_back(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+        }
+    }
+
+    for (uint32_t ring = 0; ring < RINGS; ring++) {
+        for (uint32_t segment = 0; segment < SEGMENTS; segment++) {
+            uint32_t a = ring * (SEGMENTS + 1) + segment, b = a + 1, c = a + SEGMENTS + 1, d = c + 1;
+            if (ring > 0)
+                indices.insert(indices.end(), {a, c, b});
+            if (ring < RINGS - 1)
+                indices.insert(indices.end(), {b, c, d});
+        }
+    }
+}
+
+ExampleIndirect::ExampleIndirect() {
+    m_Scene = spock::IndirectScene::CreateIndirectScene(GRID_SIZE * GRID_SIZE + SPHERE_COUNT + 1);
+    m_HiZ = spock::HiZPyramid::CreateHiZPyramid();
+
+    // Shader stages
+    std::vector<spock::PipelineStage> stages;
+    stages.emplace_back(
+        spock::PipelineStage::PipelineStageFromData(shaders::indirect_vert, VK_SHADER_STAGE_VERTEX_BIT));
+    stages.emplace_back(
+        spock::PipelineStage::PipelineStageFromData(shaders::triangle_frag, VK_SHADER_STAGE_FRAGMENT_BIT));
+
+    // Generate the pipeline config, positions only: transforms come from the scene objects
+    spock::PipelineConfig pipeline_config{};
+    pipeline_config.Stages = std::move(stages);
+    pipeline_config.BindingDescriptions = {{0, sizeof(glm::vec3), VK_VERTEX_INPUT_RATE_VERTEX}};
+    pipeline_config.AttributeDescriptions = {{0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0}};
+    pipeline_config.DescriptorSetLayouts = {m_Scene->GetDescriptorSetLayout()}; // Objects at set 1
+    pipeline_config.UseFrameGlobals = true;                                      // Camera at set 0
+
+    m_Pipeline = spock::Pipeline::CreatePipeline(std::move(pipeline_config));
+
+    // A unit quad and a triangle sharing the same buffers, tiles pick one by its offsets
+    m_Geometry = spock::GeometryBuffer::CreateGeometryBuffer(sizeof(glm::vec3), 4096, 32768);
+
+    // clang-format off
+    std::vector<glm::vec3> quad_vertices = {
+        {-0.5f, -0.5f, 0}, {0.5f, -0.5f, 0}, {0.5f, 0.5f, 0}, {-0.5f, 0.5f, 0},
+    };
+    std::vector<glm::vec3> triangle_vertices = {
+        {-0.5f, -0.5f, 0}, {0.5f, -0.5f, 0}, {0, 0.5f, 0},
+    };
+    // clang-format on
+    std::array<spock::GeometryBuffer::Mesh, 2> meshes = {
+        m_Geometry->Allocate(quad_vertices, {0, 1, 2, 2, 3, 0}),
+        m_Geometry->Allocate(triangle_vertices, {0, 1, 2}),
+    };
+
+    // A floor of tiles under the other examples, uploaded once
+    for (uint32_t x = 0; x < GRID_SIZE; x++) {
+        for (uint32_t y = 0; y < GRID_SIZE; y++) {
+            auto position = (glm::vec3(x, y, 0) - glm::vec3((GRID_SIZE - 1) / 2.f, (GRID_SIZE - 1) / 2.f, 0)) * 0.25f;
+
+            spock::IndirectObject object{};
+            object.Model = glm::translate(glm::mat4(1.0f), position + glm::vec3(0, 0, -1.f))
+                         * glm::scale(glm::mat4(1.0f), glm::vec3(0.2f));
+            object.BoundingSphere = glm::vec4(0, 0, 0, 0.71f); // Encloses both meshes
+
+            const auto &mesh = meshes[(x + y) % meshes.size()];
+            object.IndexCount = mesh.Lods[0].IndexCount;
+            object.FirstIndex = mesh.Lods[0].FirstIndex;
+            object.VertexOffset = static_cast<int32_t>(mesh.FirstVertex);
+            m_Scene->AddObject(object);
+        }
+    }
+
+    // A high resolution sphere with its levels of detail generated at load time
+    std::vector<glm::vec3> sphere_vertices;
+    std::vector<uint32_t> sphere_indices;
+    CreateSphere(sphere_vertices, sphere_indices);
+    auto lods = spock::MeshSimplifier::GenerateLods(sphere_vertices, sphere_indices, spock::MAX_MESH_LODS);
+    m_Sphere = m_Geometry->AllocateLods(sphere_vertices, lods);
+
+    for (uint32_t i = 0; i < SPHERE_COUNT; i++) {
+        // Resting on the floor, from the center of the view to its far edge
+        auto distance = 6.8f * i / (SPHERE_COUNT - 1);
+        auto position = glm::vec3(-distance, -distance, -1.f + SPHERE_SCALE);
+        m_SpherePositions[i] = position;
+
+        spock::IndirectObject object{};
+        object.Model = glm::translate(glm::mat4(1.0f), position) * glm::scale(glm::mat4(1.0f), glm::vec3(SPHERE_SCALE));
+        object.BoundingSphere = glm::vec4(0, 0, 0, 1.0f); // The unit sphere
+        object.IndexCount = m_Sphere.Lods[0].IndexCount;
+        object.FirstIndex = m_Sphere.Lods[0].FirstIndex;
+        object.VertexOffset = static_cast<int32_t>(m_Sphere.FirstVertex);
+        m_SphereObjects[i] = m_Scene->AddObject(object);
+
+        // clang-format off
+        auto top = position + glm::vec3(0, 0, SPHERE_SCALE + 2 * MARKER_SIZE);
+        std::vector<glm::vec3> marker_vertices = {
+            position + glm::vec3(0, 0, SPHERE_SCALE + 0.02f),
+            top + glm::vec3(MARKER_SIZE, 0, 0),
+            top + glm::vec3(-MARKER_SIZE / 2, MARKER_SIZE * 0.87f, 0),
+            top + glm::vec3(-MARKER_SIZE / 2, -MARKER_SIZE * 0.87f, 0),
+        };
+        // clang-format on
+        m_Markers[i] = m_Geometry->Allocate(marker_vertices, {0, 2, 1, 0, 3, 2, 0, 1, 3, 1, 2, 3});
+    }
+
+    // Built once, the spheres only refit their boxes
+    std::vector<spock::BoundingBox> bounds;
+    for (uint32_t i = 0; i < m_Scene->GetObjectCount(); i++) {
+        const auto &object = m_Scene->GetObject(i);
+        auto scale = glm::length(glm::vec3(object.Model[0]));
+        auto center = glm::vec3(object.Model * glm::vec4(glm::vec3(object.BoundingSphere), 1.0f));
+        bounds.emplace_back(spock::BoundingBox::FromSphere(center, object.BoundingSphere.w * scale));
+    }
+    m_Bvh.Build(bounds);
+
+    // Not pickable and never drawn by the scene itself, only holds the transform of the markers
+    spock::IndirectObject marker_object{};
+    marker_object.IndexCount = 0;
+    m_MarkerObject = m_Scene->AddObject(marker_object);
+}
+
+void ExampleIndirect::Update() {
+    const auto &frame = spock::FrameGlobals::GetData();
+    spock::LodSelector selector(frame);
+
+    // Starts resting on the floor
+    auto bounce = glm::vec3(0, 0, BOUNCE_HEIGHT * 0.5f * (1.0f - std::cos(2.0f * frame.Time)));
+
+    for (uint32_t i = 0; i < SPHERE_COUNT; i++) {
+        auto position = m_SpherePositions[i] + bounce;
+        auto lod = selector.Select(m_Sphere, position, SPHERE_SCALE, SPHERE_SCALE);
+
+        auto object = m_Scene->GetObject(m_SphereObjects[i]);
+        object.Model = glm::translate(glm::mat4(1.0f), position) * glm::scale(glm::mat4(1.0f), glm::vec3(SPHERE_SCALE));
+        object.IndexCount = m_Sphere.Lods[lod].IndexCount;
+        object.FirstIndex = m_Sphere.Lods[lod].FirstIndex;
+        m_Scene->SetObject(m_SphereObjects[i], object);
+
+        m_Bvh.SetBounds(m_SphereObjects[i], spock::BoundingBox::FromSphere(position, SPHERE_SCALE));
+    }
+
+    // The tree built at load time stays valid, only its boxes move
+    m_Bvh.Refit();
+
+    auto marker_object = m_Scene->GetObject(m_MarkerObject);
+    marker_object.Model = glm::translate(glm::mat4(1.0f), bounce);
+    m_Scene->SetObject(m_MarkerObject, marker_object);
+}
+
+uint32_t ExampleIndirect::Pick(const glm::vec2 &position) const {
+    auto ray = spock::Ray::FromScreen(spock::FrameGlobals::GetData().ViewProjection, position);
+    return m_Bvh.Raycast(ray).Object;
+}
+
+void ExampleIndirect::Cull(VkCommandBuffer command_buffer) {
+    m_HiZ->Build(command_buffer);
+    m_Scene->Cull(command_buffer, m_HiZ.get());
+}
+
+void ExampleIndirect::Render(spock::CommandRecorder &recorder) const {
+    recorder.BindPipeline(*m_Pipeline);
+    recorder.BindDescriptorSet(1, m_Scene->GetDescriptorSet());
+    m_Geometry->Bind(recorder);
+
+    // Every visible tile in a single draw, whatever the tile count and mesh
+    m_Scene->Draw(recorder.GetCommandBuffer());
+
+    // A mesh per marker, in one call when VK_EXT_multi_draw is supported
+    m_Geometry->DrawMeshes(recorder, m_Markers, 1, m_MarkerObject);
+}
@@ -8,6 +8,7 @@
 int main() {
     auto settings = spock::SpockSettings{};             // Get the default settings
     settings.PresentModes = {VK_PRESENT_MODE_FIFO_KHR}; // Set present mode to V-Sync
+    settings.UseDescriptorBuffers = true;               // For the descriptor buffer example, when supported
 
     spock::Application app(settings);
 
@@ -1,7 +1,9 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <vector>
 #include <vulkan/vulkan_core.h>
 
+#include "embedded_shaders.hh"
 #include "shapes.hh"
 
 struct Vertex
@@ -42,34 +44,25 @@ struct Vertex
 ExampleShapes::ExampleShapes() {
     // Shader stages
     std::vector<spock::PipelineStage> stages;
-    stages.emplace_back(spock::PipelineStage::PipelineStageFromFile("SpockApp/resources/shaders/triangle.vert.spv",
-                                                                    VK_SHADER_STAGE_VERTEX_BIT));
-    stages.emplace_back(spock::PipelineStage::PipelineStageFromFile("SpockApp/resources/shaders/triangle.frag.spv",
-                                                                    VK_SHADER_STAGE_FRAGMENT_BIT));
-
-    // Setup the uniform buffers
-    VkDescriptorSetLayoutBinding uboLayoutBinding{};
-    uboLayoutBinding.binding = 0;
-    uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    uboLayoutBinding.descriptorCount = 1;
-    uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-
-    std::array<VkDescriptorSetLayoutBinding, 1> bindings = {uboLayoutBinding};
-    m_DescriptorSetLayout = spock::DescriptorSetLayout::CreateDescriptorSetLayout(bindings);
-
-    m_UniformBuffer = spock::UniformBuffer<UniformBufferObject>::CreateUniformBuffer();
-
-    // Add our descriptors to the set
-    auto uniform_buffer_descriptor = spock::UniformBufferDescriptor(0, m_UniformBuffer);
-    std::array<spock::Descriptor *, 1> descriptors{&uniform_buffer_descriptor};
-    m_DescriptorSets = spock::CreateDescriptorSets(m_DescriptorSetLayout, std::move(descriptors));
+    stages.emplace_back(spock::PipelineStage::PipelineStageFromData(shaders::triangle_vert, VK_SHADER_STAGE_VERTEX_BIT));
+    stages.emplace_back(
+        spock::PipelineStage::PipelineStageFromData(shaders::triangle_frag, VK_SHADER_STAGE_FRAGMENT_BIT));
 
     // Generate the pipeline config
     spock::PipelineConfig pipeline_config{};
     pipeline_config.Stages = std::move(stages);
-    pipeline_config.BindingDescription = Vertex::GetBindingDescription();
+    pipeline_config.BindingDescriptions = {Vertex::GetBindingDescription(),
+                                           spock::InstanceBuffer<InstanceData>::GetBindingDescription(1)};
     pipeline_config.AttributeDescriptions = Vertex::GetAttributeDescriptions();
-    pipeline_config.DescriptorSetLayouts = {m_DescriptorSetLayout->GetDescriptorSetLayout()};
+
+    // The model matrix takes one location per column
+    for (uint32_t column = 0; column < 4; column++) {
+        pipeline_config.AttributeDescriptions.emplace_back(VkVertexInputAttributeDescription{
+            2 + column, 1, VK_FORMAT_R32G32B32A32_SFLOAT,
+            static_cast<uint32_t>(offsetof(InstanceData, Model) + column * sizeof(glm::vec4))});
+    }
+    pipeline_config.UseShaderObjects = true; // Bypasses pipeline creation when supported
+    pipeline_config.UseFrameGlobals = true;  // Camera at set 0
 
     m_Pipeline = spock::Pipeline::CreatePipeline(std::move(pipeline_config));
 
@@ -96,30 +89,48 @@ ExampleShapes::ExampleShapes() {
     // clang-format on
 
     m_VertexBuffer = spock::Buffer::CreateVertexBuffer<Vertex>(vertices);
+    m_InstanceBuffer = spock::InstanceBuffer<InstanceData>::CreateInstanceBuffer(GRID_SIZE * GRID_SIZE);
+
+    // A grid of small copies, each spinning in place
+    auto grid = m_Transforms.AddNode(spock::TransformHierarchy::INVALID_NODE, glm::mat4(1.0f));
+    for (uint32_t x = 0; x < GRID_SIZE; x++) {
+        for (uint32_t y = 0; y < GRID_SIZE; y++) {
+            auto position = (glm::vec3(x, y, 0) - glm::vec3((GRID_SIZE - 1) / 2.f, (GRID_SIZE - 1) / 2.f, 0)) * 0.6f;
+            auto transform = glm::translate(glm::mat4(1.0f), position) * glm::scale(glm::mat4(1.0f), glm::vec3(0.3f));
+
+            auto place = m_Transforms.AddNode(grid, transform);
+            auto instance = static_cast<uint32_t>(m_SpinNodes.size());
+            m_SpinNodes.emplace_back(m_Transforms.AddNode(place, glm::mat4(1.0f), instance));
+        }
+    }
 }
 
 void ExampleShapes::Update(float rotation) {
-    UniformBufferObject ubo{};
-    ubo.Model =
+    auto model =
         glm::rotate(glm::mat4(1.0f), (6.f / 60000) * rotation * glm::radians(360.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-    ubo.View = glm::lookAt(glm::vec3(2.f, 2.f, 2.f), glm::vec3(0, 0, 0), glm::vec3(0.0f, 0.0f, 1.0f));
-    ubo.Projection = glm::perspective(glm::radians(45.0f), 16 / (float)9, 0.1f, 1000.0f); // 45deg fov, 16:9 ratio
-    ubo.Projection[1][1] *= -1;
 
-    m_UniformBuffer->SetData(ubo);
+    // Only the spins change, the places are not recomputed
+    for (auto node : m_SpinNodes) {
+        m_Transforms.SetLocal(node, model);
+    }
+    m_Transforms.Update();
+
+    // Every instance, the buffer of this frame did not see the previous updates
+    auto instances = m_InstanceBuffer->Map(static_cast<uint32_t>(m_SpinNodes.size()));
+    m_Transforms.WriteWorldTransforms(instances.data(), sizeof(InstanceData));
 }
 
-void ExampleShapes::Render(VkCommandBuffer command_buffer) const {
-    m_Pipeline->Bind(command_buffer);
+void ExampleShapes::Render(spock::RenderQueue &render_queue) const {
+    spock::DrawPacket packet{};
+    packet.SortKey = render_queue.MakeSortKey(0, *m_Pipeline, VK_NULL_HANDLE, 0.0f);
+    packet.DrawPipeline = m_Pipeline.get();
 
-    // Bind the vertex buffer
-    VkDeviceSize offset[] = {0};
-    VkBuffer vertex_buffers[] = {m_VertexBuffer->GetBuffer()};
-    vkCmdBindVertexBuffers(command_buffer, 0, 1, vertex_buffers, offset);
+    // The vertex buffer, and the per-instance transforms next to it
+    packet.VertexBuffers = {m_VertexBuffer->GetBuffer(), m_InstanceBuffer->GetBuffer()};
 
-    // Bind the uniform buffer
-    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Pipeline->GetLayout(), 0, 1,
-                            &m_DescriptorSets[spock::Spock::GetCurrentFrame()], 0, nullptr);
+    // Every copy in a single draw
+    packet.Count = 12;
+    packet.InstanceCount = m_InstanceBuffer->GetCount();
 
-    vkCmdDraw(command_buffer, 12, 1, 0, 0);
+    render_queue.Submit(packet);
 }
@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <chrono>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+#include <vector>
+
+#include "spock/transform_hierarchy.hh"
+#include "transforms.hh"
+
+ExampleTransforms::ExampleTransforms() {
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+    auto random_local = [&]() {
+        return glm::translate(glm::mat4(1.0f), glm::vec3(offset(random), offset(random), offset(random)));
+    };
+
+    // Level by level, so the nodes are already sorted
+    auto node_count = FIRST_LEAF + ROOT_COUNT * CHILD_COUNT * LEAF_COUNT;
+    m_Hierarchy.Reserve(node_count);
+    m_Rest.reserve(node_count);
+    for (uint32_t i = 0; i < ROOT_COUNT; i++) {
+        m_Rest.emplace_back(random_local());
+        m_Hierarchy.AddNode(spock::TransformHierarchy::INVALID_NODE, m_Rest.back());
+    }
+    for (uint32_t i = 0; i < ROOT_COUNT * CHILD_COUNT; i++) {
+        m_Rest.emplace_back(random_local());
+        m_Hierarchy.AddNode(i / CHILD_COUNT, m_Rest.back());
+    }
+    for (uint32_t i = 0; i < ROOT_COUNT * CHILD_COUNT * LEAF_COUNT; i++) {
+        m_Rest.emplace_back(random_local());
+        m_Hierarchy.AddNode(ROOT_COUNT + i / LEAF_COUNT, m_Rest.back(), i);
+    }
+
+    m_Hierarchy.Update();
+}
+
+void ExampleTransforms::Animate(uint32_t first, uint32_t stride, float angle) {
+    auto turn = glm::rotate(glm::mat4(1.0f), angle, glm::vec3(0.0f, 0.0f, 1.0f));
+    for (uint32_t node = first; node < m_Hierarchy.GetNodeCount(); node += stride) {
+        m_Hierarchy.SetLocal(node, m_Rest[node] * turn);
+    }
+}
+
+void ExampleTransforms::Run() {
+    struct Case
+    {
+        const char *Name;
+        uint32_t First;
+        uint32_t Stride; // Nothing is animated when 0
+    };
+
+    const Case cases[] = {
+        {"Every node animated", 0, 1},
+        {"1% of the leaves animated", FIRST_LEAF, 100},
+        {"Static", 0, 0},
+    };
+
+    // Only the update is timed, setting the local transforms is up to the application
+    m_Results.clear();
+    for (auto [name, first, stride] : cases) {
+        Result result{name, 0, 0.0};
+        for (uint32_t run = 0; run < RUN_COUNT; run++) {
+            if (stride != 0)
+                Animate(first, stride, 0.01f * static_cast<float>(run + 1));
+
+            auto start = std::chrono::steady_clock::now();
+            result.ChangedCount = m_Hierarchy.Update();
+            std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+
+            result.Milliseconds = run == 0 ? duration.count() : std::min(result.Milliseconds, duration.count());
+        }
+
+        m_Results.emplace_back(result);
+    }
+}